@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#include <cstdlib>
+
+#include <iostream>
+#include <string_view>
+
+#include <gf2/core/AssetPack.h>
+#include <gf2/core/ThreadPool.h>
+
+namespace {
+
+  int usage()
+  {
+    std::cerr << "Usage: gf2_pack create <pack.gfpack> <directory> [--no-compression] [--no-hash]\n";
+    std::cerr << "       gf2_pack list <pack.gfpack>\n";
+    std::cerr << "       gf2_pack verify <pack.gfpack>\n";
+    return EXIT_FAILURE;
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    return usage();
+  }
+
+  const std::string_view command = argv[1];
+
+  if (command == "create") {
+    if (argc < 4) {
+      return usage();
+    }
+
+    gf::Flags<gf::AssetPackFlag> flags = gf::AssetPackWriter::DefaultFlags;
+
+    for (int i = 4; i < argc; ++i) {
+      const std::string_view option = argv[i];
+
+      if (option == "--no-compression") {
+        flags.reset(gf::AssetPackFlag::Compressed);
+      } else if (option == "--no-hash") {
+        flags.reset(gf::AssetPackFlag::Hashed);
+      } else {
+        std::cerr << "Unknown option: " << option << '\n';
+        return EXIT_FAILURE;
+      }
+    }
+
+    gf::ThreadPool pool;
+
+    gf::AssetPackWriter writer;
+    writer.add_directory(argv[3], flags);
+    writer.save(argv[2], &pool);
+
+    const gf::AssetPack pack(argv[2]);
+    std::cout << argv[2] << ": " << pack.raw_entries().size() << " entries\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (argc != 3) {
+    return usage();
+  }
+
+  const gf::AssetPack pack(argv[2]);
+
+  if (command == "list") {
+    for (const gf::AssetPackEntry& entry : pack.raw_entries()) {
+      std::cout << pack.entry_path(entry) << '\t' << entry.original_size;
+
+      if (entry.flags.test(gf::AssetPackFlag::Compressed)) {
+        std::cout << " (" << entry.size << " compressed)";
+      }
+
+      std::cout << '\n';
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  if (command == "verify") {
+    int status = EXIT_SUCCESS;
+
+    for (const gf::AssetPackEntry& entry : pack.raw_entries()) {
+      if (!pack.verify(pack.entry_path(entry))) {
+        std::cerr << "Corrupted entry: " << pack.entry_path(entry) << '\n';
+        status = EXIT_FAILURE;
+      }
+    }
+
+    return status;
+  }
+
+  return usage();
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#include <cstdlib>
+
+#include <iostream>
+#include <string_view>
+
+#include <gf2/core/Image.h>
+#include <gf2/core/TextureData.h>
+#include <gf2/core/ThreadPool.h>
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3 && argc != 4) {
+    std::cerr << "Usage: gf2_texture_encode <image> <texture.gftex> [none|bc1|bc3|bc7]\n";
+    return EXIT_FAILURE;
+  }
+
+  gf::BlockCompression compression = gf::BlockCompression::Bc7;
+
+  if (argc == 4) {
+    const std::string_view name = argv[3];
+
+    if (name == "none") {
+      compression = gf::BlockCompression::None;
+    } else if (name == "bc1") {
+      compression = gf::BlockCompression::Bc1;
+    } else if (name == "bc3") {
+      compression = gf::BlockCompression::Bc3;
+    } else if (name == "bc7") {
+      compression = gf::BlockCompression::Bc7;
+    } else {
+      std::cerr << "Unknown compression: " << name << '\n';
+      return EXIT_FAILURE;
+    }
+  }
+
+  gf::ThreadPool pool;
+
+  const gf::Image image(argv[1]);
+  const gf::TextureData data(image, compression, &pool);
+  data.save_to_file(argv[2]);
+
+  std::cout << argv[2] << ": " << data.size().w << 'x' << data.size().h << ", " << data.level_count() << " levels, " << data.raw_size() << " bytes\n";
+
+  return EXIT_SUCCESS;
+}
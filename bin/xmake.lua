@@ -15,6 +15,12 @@ if has_config("binaries") then
         add_deps("gf2core0")
         set_rundir("$(projectdir)")
 
+    target("gf2_pack")
+        set_kind("binary")
+        add_files("gf2_pack.cc")
+        add_deps("gf2core0")
+        set_rundir("$(projectdir)")
+
     if has_config("audio") then
         target("gf2_play_sound")
             set_kind("binary")
@@ -29,6 +35,12 @@ if has_config("binaries") then
         add_deps("gf2core0")
         set_rundir("$(projectdir)")
 
+    target("gf2_texture_encode")
+        set_kind("binary")
+        add_files("gf2_texture_encode.cc")
+        add_deps("gf2core0")
+        set_rundir("$(projectdir)")
+
     if has_config("graphics") then
         target("gf2_tmx_display")
             set_kind("binary")
@@ -3,6 +3,7 @@
 #ifndef GF_AUDIO_SOURCE_H
 #define GF_AUDIO_SOURCE_H
 
+#include <cstddef>
 #include <cstdint>
 
 #include <filesystem>
@@ -106,6 +107,8 @@ namespace gf {
     Time cursor();
     Time length();
 
+    std::size_t memory_size() const;
+
   protected:
     AudioSource(const std::filesystem::path& filename, uint32_t flags, AudioManager* manager);
 
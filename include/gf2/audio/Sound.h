@@ -3,6 +3,10 @@
 #ifndef GF_SOUND_H
 #define GF_SOUND_H
 
+#include <cstddef>
+
+#include <gf2/core/ResourceContext.h>
+
 #include "AudioApi.h"
 #include "AudioSource.h"
 
@@ -16,6 +20,14 @@ namespace gf {
     Sound(const std::filesystem::path& filename, const AudioSourceContext& context);
   };
 
+  template<>
+  struct ResourceSize<Sound> {
+    static std::size_t estimate(const Sound& resource)
+    {
+      return sizeof(Sound) + resource.memory_size();
+    }
+  };
+
 }
 
 #endif // GF_SOUND_H
@@ -0,0 +1,171 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_ASSET_CACHE_H
+#define GF_ASSET_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <exception>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "CoreApi.h"
+#include "Log.h"
+#include "SecureHash.h"
+#include "Serialization.h"
+#include "SerializationContainer.h"
+#include "SerializationOps.h"
+#include "Span.h"
+#include "Streams.h"
+
+namespace gf {
+
+  // resources whose decoding can be stored in an AssetCache, they must be default constructible and serializable
+  template<typename T>
+  struct AssetCacheTraits {
+    static constexpr bool Enabled = false;
+    static constexpr std::string_view Processor = {};
+    static constexpr uint16_t Version = 0;
+    static constexpr uint16_t ArchiveVersion = 0; // version of the serialization of the resource
+  };
+
+  class GF_CORE_API AssetCacheKey {
+  public:
+    AssetCacheKey(std::string_view processor, uint16_t version);
+
+    void add_bytes(Span<const uint8_t> bytes);
+    bool add_file(const std::filesystem::path& filename);
+
+    template<typename T>
+    void add_parameter(const T& parameter, uint16_t version = 0)
+    {
+      std::vector<uint8_t> bytes;
+
+      {
+        BufferOutputStream stream(&bytes);
+        Serializer ar(&stream, version);
+        ar | parameter;
+      }
+
+      add_bytes(bytes);
+    }
+
+    SecureHash::Hash result();
+
+  private:
+    SecureHash m_hash;
+  };
+
+  class GF_CORE_API AssetCache {
+  public:
+    static constexpr std::size_t DefaultSizeLimit = std::size_t(256) * 1024 * 1024;
+
+    AssetCache(std::filesystem::path directory, std::size_t size_limit = DefaultSizeLimit);
+
+    const std::filesystem::path& directory() const
+    {
+      return m_directory;
+    }
+
+    void set_size_limit(std::size_t size_limit);
+    std::size_t size_limit() const;
+    std::size_t size() const;
+    std::size_t entry_count() const;
+
+    bool contains(const SecureHash::Hash& key) const;
+
+    std::optional<std::vector<uint8_t>> load_raw(const SecureHash::Hash& key);
+    void store_raw(const SecureHash::Hash& key, Span<const uint8_t> value);
+
+    template<typename T>
+    bool load(const SecureHash::Hash& key, T& value, uint16_t version = 0)
+    {
+      const std::optional<std::vector<uint8_t>> bytes = load_raw(key);
+
+      if (!bytes) {
+        return false;
+      }
+
+      try {
+        BufferInputStream stream(&bytes.value());
+        Deserializer ar(&stream);
+
+        if (ar.version() != version) {
+          // stored with another serialization, replaced by the next store
+          return false;
+        }
+
+        T loaded = {};
+        ar | loaded;
+        value = std::move(loaded);
+      } catch (const std::exception& ex) {
+        Log::warning("Invalid entry in the asset cache: {}", ex.what());
+        remove(key);
+        return false;
+      }
+
+      return true;
+    }
+
+    template<typename T>
+    void store(const SecureHash::Hash& key, const T& value, uint16_t version = 0)
+    {
+      std::vector<uint8_t> bytes;
+
+      {
+        BufferOutputStream stream(&bytes);
+        Serializer ar(&stream, version);
+        ar | value;
+      }
+
+      store_raw(key, bytes);
+    }
+
+    template<typename T, typename F>
+    T load_or_compute(const SecureHash::Hash& key, F&& compute, uint16_t version = 0)
+    {
+      T value = {};
+
+      if (load(key, value, version)) {
+        return value;
+      }
+
+      value = std::forward<F>(compute)();
+      store(key, value, version);
+      return value;
+    }
+
+    void remove(const SecureHash::Hash& key);
+    void clear();
+
+  private:
+    struct Entry {
+      std::size_t size = 0;
+      uint64_t access = 0;
+    };
+
+    std::filesystem::path entry_file(const SecureHash::Hash& key) const;
+    void touch(const SecureHash::Hash& key, Entry& entry);
+    void erase(std::map<SecureHash::Hash, Entry>::iterator iterator);
+    void evict();
+
+    std::filesystem::path m_directory;
+
+    mutable std::mutex m_mutex;
+    std::size_t m_size_limit = DefaultSizeLimit;
+    std::size_t m_size = 0;
+    uint64_t m_access = 0;
+    uint64_t m_temporary = 0;
+    std::map<SecureHash::Hash, Entry> m_entries;
+    std::map<uint64_t, SecureHash::Hash> m_lru; // access -> key, the least recently used entry first
+  };
+
+} // namespace gf
+
+#endif // GF_ASSET_CACHE_H
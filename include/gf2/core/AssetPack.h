@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_ASSET_PACK_H
+#define GF_ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "CoreApi.h"
+#include "Flags.h"
+#include "Id.h"
+#include "SecureHash.h"
+#include "Span.h"
+#include "Streams.h"
+
+namespace gf {
+  class ThreadPool;
+
+  enum class AssetPackFlag : uint32_t {
+    Compressed = 0x01,
+    Hashed = 0x02,
+  };
+
+  template<>
+  struct EnableBitmaskOperators<AssetPackFlag> : std::true_type {
+  };
+
+  // an entry of the table of contents, stored as is in the pack
+  struct AssetPackEntry {
+    Id key = InvalidId;         // hash of the path
+    uint64_t offset = 0;        // of the payload, from the beginning of the pack
+    uint64_t size = 0;          // of the payload
+    uint64_t original_size = 0; // of the content, once decompressed
+    uint64_t name_offset = 0;   // in the string table
+    uint32_t name_size = 0;
+    Flags<AssetPackFlag> flags = None;
+    SecureHash::Hash hash = {}; // of the content, only if the entry is hashed
+  };
+
+  static_assert(std::is_trivially_copyable_v<AssetPackEntry>);
+
+  class GF_CORE_API AssetPack {
+  public:
+    AssetPack(const std::filesystem::path& filename);
+
+    std::vector<uint8_t> extract(const std::filesystem::path& path) const;
+    Span<const uint8_t> extract_view(const std::filesystem::path& path) const;
+    bool verify(const std::filesystem::path& path) const;
+
+    std::vector<std::filesystem::path> entries() const;
+    Span<const AssetPackEntry> raw_entries() const;
+    std::string_view entry_path(const AssetPackEntry& entry) const;
+
+  private:
+    const AssetPackEntry* find(const std::filesystem::path& path) const;
+    Span<const uint8_t> entry_payload(const AssetPackEntry& entry) const;
+
+    MappedFileInputStream m_file;
+    std::vector<AssetPackEntry> m_entries; // sorted by key, then by path
+    std::string_view m_names;
+  };
+
+  class GF_CORE_API AssetPackWriter {
+  public:
+    static constexpr Flags<AssetPackFlag> DefaultFlags = Flags<AssetPackFlag>(AssetPackFlag::Compressed) | AssetPackFlag::Hashed;
+
+    void add_entry(const std::filesystem::path& path, std::vector<uint8_t> content, Flags<AssetPackFlag> flags = DefaultFlags);
+    void add_file(const std::filesystem::path& path, const std::filesystem::path& filename, Flags<AssetPackFlag> flags = DefaultFlags);
+    void add_directory(const std::filesystem::path& directory, Flags<AssetPackFlag> flags = DefaultFlags);
+
+    void save(const std::filesystem::path& filename, ThreadPool* pool = nullptr);
+
+  private:
+    struct Entry {
+      std::string path;
+      std::vector<uint8_t> content;
+      Flags<AssetPackFlag> flags;
+    };
+
+    std::vector<Entry> m_entries;
+  };
+
+} // namespace gf
+
+#endif // GF_ASSET_PACK_H
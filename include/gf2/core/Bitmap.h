@@ -12,9 +12,11 @@
 #include "CoreApi.h"
 #include "Range.h"
 #include "Rect.h"
+#include "Resampling.h"
 #include "Vec2.h"
 
 namespace gf {
+  class ThreadPool;
 
   class GF_CORE_API Bitmap {
   public:
@@ -35,6 +37,7 @@ namespace gf {
     void blit_to(Bitmap& target_bitmap, Vec2I target_offset) const;
 
     Bitmap sub_bitmap(RectI area) const;
+    Bitmap resized(Vec2I size, ResamplingFilter filter = ResamplingFilter::Bilinear, ThreadPool* pool = nullptr) const;
 
     std::size_t raw_size() const;
     const uint8_t* raw_data() const;
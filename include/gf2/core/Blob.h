@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_BLOB_H
+#define GF_BLOB_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "CoreApi.h"
+#include "Span.h"
+
+namespace gf {
+  class OutputStream;
+
+  // a relocatable reference to an array in a blob
+  template<typename T>
+  struct BlobArray {
+    uint32_t offset = 0; // from the beginning of the blob
+    uint32_t size = 0;   // number of elements
+  };
+
+  using BlobString = BlobArray<char>;
+
+  // the values are copied as a whole, so their types should not have padding (e.g. use reserved fields)
+  class GF_CORE_API BlobWriter {
+  public:
+    BlobWriter(uint32_t tag, uint16_t version = 0);
+
+    template<typename T>
+    BlobArray<T> allocate_array(std::size_t size)
+    {
+      static_assert(std::is_trivially_copyable_v<T>, "T should be trivially copyable.");
+      const uint32_t offset = allocate(size * sizeof(T), alignof(T));
+      return { offset, static_cast<uint32_t>(size) };
+    }
+
+    template<typename T>
+    BlobArray<T> add_array(Span<const T> data)
+    {
+      const BlobArray<T> array = allocate_array<T>(data.size());
+
+      if (!data.empty()) {
+        std::memcpy(m_bytes.data() + array.offset, data.data(), data.size() * sizeof(T));
+      }
+
+      return array;
+    }
+
+    template<typename T>
+    BlobArray<T> add_array(const std::vector<T>& data)
+    {
+      return add_array(Span<const T>(data.data(), data.size()));
+    }
+
+    BlobString add_string(std::string_view string);
+
+    template<typename T>
+    void set(BlobArray<T> array, std::size_t index, const T& value)
+    {
+      assert(index < array.size);
+      std::memcpy(m_bytes.data() + array.offset + (index * sizeof(T)), &value, sizeof(T));
+    }
+
+    template<typename T>
+    void finish(const T& root)
+    {
+      const BlobArray<T> array = add_array(Span<const T>(&root, 1));
+      finish_with_root(array.offset);
+    }
+
+    const std::vector<uint8_t>& bytes() const
+    {
+      return m_bytes;
+    }
+
+    void save_to_stream(OutputStream& stream) const;
+
+  private:
+    uint32_t allocate(std::size_t size, std::size_t alignment);
+    void finish_with_root(uint32_t offset);
+
+    std::vector<uint8_t> m_bytes;
+  };
+
+  class GF_CORE_API BlobView {
+  public:
+    BlobView() = default;
+    BlobView(Span<const uint8_t> memory, uint32_t tag);
+
+    uint16_t version() const
+    {
+      return m_version;
+    }
+
+    Span<const uint8_t> memory() const
+    {
+      return m_memory;
+    }
+
+    template<typename T>
+    const T& root() const
+    {
+      return *static_cast<const T*>(address(m_root, sizeof(T), alignof(T))); // NOLINT
+    }
+
+    template<typename T>
+    Span<const T> array(BlobArray<T> array) const
+    {
+      if (array.size == 0) {
+        return {};
+      }
+
+      const void* data = address(array.offset, std::size_t(array.size) * sizeof(T), alignof(T));
+      return { static_cast<const T*>(data), array.size };
+    }
+
+    std::string_view string(BlobString string) const;
+
+  private:
+    const void* address(uint32_t offset, std::size_t size, std::size_t alignment) const;
+
+    Span<const uint8_t> m_memory;
+    uint16_t m_version = 0;
+    uint32_t m_root = 0;
+  };
+
+} // namespace gf
+
+#endif // GF_BLOB_H
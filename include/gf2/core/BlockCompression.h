@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_BLOCK_COMPRESSION_H
+#define GF_BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CoreApi.h"
+#include "Span.h"
+#include "Vec2.h"
+
+namespace gf {
+  class ThreadPool;
+
+  enum class BlockCompression : uint8_t {
+    None,
+    Bc1,
+    Bc3,
+    Bc7,
+  };
+
+  GF_CORE_API std::size_t compute_compressed_size(Vec2I size, BlockCompression compression);
+
+  GF_CORE_API void compress_blocks(Span<const uint8_t> source, Vec2I size, BlockCompression compression, Span<uint8_t> target, ThreadPool* pool = nullptr);
+  GF_CORE_API void decompress_blocks(Span<const uint8_t> source, Vec2I size, BlockCompression compression, Span<uint8_t> target, ThreadPool* pool = nullptr);
+
+} // namespace gf
+
+#endif // GF_BLOCK_COMPRESSION_H
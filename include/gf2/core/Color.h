@@ -9,6 +9,7 @@
 
 #include "CoreApi.h"
 #include "Math.h"
+#include "Span.h"
 #include "TypeTraits.h"
 
 namespace gf {
@@ -215,6 +216,14 @@ namespace gf {
   GF_CORE_API Color srgb_to_linear(Color color);
   GF_CORE_API Color linear_to_srgb(Color color);
 
+  GF_CORE_API float srgb_to_linear_u8(uint8_t channel);
+  GF_CORE_API uint8_t linear_to_srgb_u8(float channel);
+
+  GF_CORE_API void srgb_to_linear(Span<const Color> source, Span<Color> target);
+  GF_CORE_API void srgb_to_linear_rgba32(Span<const uint8_t> source, Span<uint8_t> target);
+  GF_CORE_API void srgb_to_linear_rgba32(Span<const uint8_t> source, Span<Color> target);
+  GF_CORE_API void linear_to_srgb_rgba32(Span<const uint8_t> source, Span<uint8_t> target);
+
   constexpr Color max(Color lhs, Color rhs)
   {
     return { details::max(lhs.r, rhs.r), details::max(lhs.g, rhs.g), details::max(lhs.b, rhs.b), details::max(lhs.a, rhs.a) };
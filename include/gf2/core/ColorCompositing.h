@@ -7,6 +7,7 @@
 
 #include "Color.h"
 #include "CoreApi.h"
+#include "Span.h"
 
 namespace gf {
 
@@ -53,6 +54,13 @@ namespace gf {
   GF_CORE_API Color combine_colors(Color source, Color backdrop, BlendMode mode = BlendMode::Normal, CompositingOperation operation = CompositingOperation::Source);
   GF_CORE_API Color blend_colors(Color source, Color backdrop,  BlendMode mode = BlendMode::Normal);
 
+  GF_CORE_API void mix_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode = BlendMode::Normal);
+  GF_CORE_API void compose_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, CompositingOperation operation = CompositingOperation::Source);
+
+  GF_CORE_API void combine_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode = BlendMode::Normal, CompositingOperation operation = CompositingOperation::Source);
+  GF_CORE_API void combine_colors(Color source, Span<const Color> backdrops, Span<Color> results, BlendMode mode = BlendMode::Normal, CompositingOperation operation = CompositingOperation::Source);
+  GF_CORE_API void blend_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode = BlendMode::Normal);
+
 }
 
 #endif // GF_COLOR_COMPOSITING_H
@@ -6,6 +6,7 @@
 #include "Color.h"
 #include "ColorCompositing.h"
 #include "CoreApi.h"
+#include "Span.h"
 
 namespace gf {
 
@@ -93,6 +94,7 @@ namespace gf {
     }
 
     Color compute_color(Color existing, Color proposed) const;
+    void compute_colors(Span<Color> existing, Color proposed) const;
 
   private:
     BlendMode m_mode;
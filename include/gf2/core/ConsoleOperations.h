@@ -44,6 +44,7 @@ namespace gf {
   GF_CORE_API void console_clear(Console& console, RectI area, const ConsoleStyle& style);
 
   GF_CORE_API void console_write_background(Console& console, Vec2I position, Color color, ConsoleEffect effect = ConsoleEffect::set());
+  GF_CORE_API void console_write_background(Console& console, RectI area, Color color, ConsoleEffect effect = ConsoleEffect::set());
 
   GF_CORE_API void console_write_picture(Console& console, Vec2I position, char16_t character);
   GF_CORE_API void console_write_picture(Console& console, Vec2I position, char16_t character, const ConsoleStyle& style);
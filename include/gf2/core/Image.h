@@ -6,15 +6,21 @@
 #include <cstdint>
 
 #include <filesystem>
+#include <future>
 #include <vector>
 
 #include "Color.h"
 #include "Range.h"
 #include "Rect.h"
+#include "Resampling.h"
+#include "ResourceContext.h"
+#include "Span.h"
 #include "Vec2.h"
 
 namespace gf {
   class InputStream;
+  class OutputStream;
+  class ThreadPool;
 
   enum class PixelFormat : uint8_t {
     Rgba32,
@@ -29,6 +35,7 @@ namespace gf {
     Image(Vec2I size, const uint8_t* pixels, PixelFormat format = PixelFormat::Rgba32);
     Image(const std::filesystem::path& filename);
     Image(InputStream& stream);
+    Image(Span<const uint8_t> memory);
 
     Vec2I size() const;
     PositionRange position_range() const;
@@ -36,12 +43,14 @@ namespace gf {
     Color operator()(Vec2I position) const;
     void put_pixel(Vec2I position, Color color);
 
-    void save_to_file(const std::filesystem::path& filename) const;
+    void save_to_file(const std::filesystem::path& filename, ThreadPool* pool = nullptr) const;
+    void save_to_stream(OutputStream& stream, ThreadPool* pool = nullptr) const;
 
     void blit_to(RectI origin_region, Image& target_image, Vec2I target_offset) const;
     void blit_to(Image& target_image, Vec2I target_offset) const;
 
     Image sub_image(RectI area) const;
+    Image resized(Vec2I size, ResamplingFilter filter = ResamplingFilter::Bilinear, ThreadPool* pool = nullptr) const;
 
     std::size_t raw_size() const;
     const uint8_t* raw_data() const;
@@ -53,8 +62,24 @@ namespace gf {
     std::vector<uint8_t> m_pixels;
   };
 
+  template<>
+  struct EnableParallelLoad<Image> : std::true_type {
+  };
+
+  template<>
+  struct ResourceSize<Image> {
+    static std::size_t estimate(const Image& resource)
+    {
+      return sizeof(Image) + resource.raw_size();
+    }
+  };
+
   GF_CORE_API Vec2I image_size(const std::filesystem::path& filename);
 
+  GF_CORE_API std::future<Image> load_image_async(ThreadPool& pool, std::filesystem::path filename);
+  GF_CORE_API std::future<Image> decode_image_async(ThreadPool& pool, std::vector<uint8_t> bytes);
+  GF_CORE_API std::future<void> save_image_async(ThreadPool& pool, Image image, std::filesystem::path filename);
+
 } // namespace gf
 
 #endif // GF_IMAGE_H
@@ -0,0 +1,56 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_PNG_WRITER_H
+#define GF_PNG_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <vector>
+
+#include "CoreApi.h"
+#include "Image.h"
+#include "Span.h"
+#include "Vec2.h"
+
+namespace gf {
+  class OutputStream;
+  class ThreadPool;
+
+  namespace details {
+    class DeflateBlocks;
+  }
+
+  class GF_CORE_API PngWriter {
+  public:
+    PngWriter(OutputStream* stream, Vec2I size, PixelFormat format = PixelFormat::Rgba32, ThreadPool* pool = nullptr);
+    PngWriter(const PngWriter&) = delete;
+    PngWriter(PngWriter&&) noexcept = delete;
+    ~PngWriter();
+
+    PngWriter& operator=(const PngWriter&) = delete;
+    PngWriter& operator=(PngWriter&&) noexcept = delete;
+
+    void write_row(Span<const uint8_t> row);
+    void finish();
+
+  private:
+    void write_chunk(const char* type, Span<const uint8_t> data);
+    void flush_block(bool last);
+
+    OutputStream* m_stream = nullptr;
+    Vec2I m_size = { 0, 0 };
+    std::size_t m_pixel_size = 4;
+    int m_rows = 0;
+    bool m_finished = false;
+
+    std::vector<uint8_t> m_previous_row;
+    std::vector<uint8_t> m_filtered_row;
+    std::vector<uint8_t> m_block;
+    std::unique_ptr<details::DeflateBlocks> m_blocks;
+  };
+
+} // namespace gf
+
+#endif // GF_PNG_WRITER_H
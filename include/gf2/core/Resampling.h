@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_RESAMPLING_H
+#define GF_RESAMPLING_H
+
+#include <cstdint>
+
+#include "CoreApi.h"
+#include "Span.h"
+#include "Vec2.h"
+
+namespace gf {
+  class ThreadPool;
+
+  enum class ResamplingFilter : uint8_t {
+    Bilinear,
+    Lanczos,
+  };
+
+  GF_CORE_API void resample_rgba32(Span<const uint8_t> source, Vec2I source_size, Span<uint8_t> target, Vec2I target_size, ResamplingFilter filter, ThreadPool* pool = nullptr);
+  GF_CORE_API void resample_gray8(Span<const uint8_t> source, Vec2I source_size, Span<uint8_t> target, Vec2I target_size, ResamplingFilter filter, ThreadPool* pool = nullptr);
+
+} // namespace gf
+
+#endif // GF_RESAMPLING_H
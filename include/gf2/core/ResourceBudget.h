@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_RESOURCE_BUDGET_H
+#define GF_RESOURCE_BUDGET_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "CoreApi.h"
+
+namespace gf {
+  class ResourceBudget;
+
+  namespace details {
+
+    // a cache of resources that can be evicted by a budget, implemented by ResourceRegistry<T>
+    class GF_CORE_API ResourceCache {
+    public:
+      ResourceCache() = default;
+      ResourceCache(const ResourceCache&) = delete;
+      ResourceCache(ResourceCache&&) noexcept = delete;
+      virtual ~ResourceCache();
+
+      ResourceCache& operator=(const ResourceCache&) = delete;
+      ResourceCache& operator=(ResourceCache&&) noexcept = delete;
+
+      // the age of the least recently used resource that is not referenced anymore
+      virtual std::optional<uint64_t> oldest_unused() const = 0;
+      // evict the least recently used resource that is not referenced anymore and return its size
+      virtual std::size_t evict_oldest_unused() = 0;
+
+      virtual void detach_budget(ResourceBudget* budget) = 0;
+    };
+
+    GF_CORE_API uint64_t next_resource_tick();
+
+  } // namespace details
+
+  class GF_CORE_API ResourceBudget {
+  public:
+    ResourceBudget(std::size_t limit = 0);
+    ResourceBudget(const ResourceBudget&) = delete;
+    ResourceBudget(ResourceBudget&&) noexcept = delete;
+    ~ResourceBudget();
+
+    ResourceBudget& operator=(const ResourceBudget&) = delete;
+    ResourceBudget& operator=(ResourceBudget&&) noexcept = delete;
+
+    void set_limit(std::size_t limit);
+    std::size_t limit() const;
+    std::size_t usage() const;
+
+    void attach(details::ResourceCache* cache);
+    void detach(details::ResourceCache* cache);
+
+    void add_usage(std::size_t size);
+    void remove_usage(std::size_t size);
+
+    void enforce();
+
+  private:
+    mutable std::mutex m_mutex; // always locked before the lock of a cache
+    std::vector<details::ResourceCache*> m_caches;
+    std::atomic<std::size_t> m_limit = 0;
+    std::atomic<std::size_t> m_usage = 0;
+  };
+
+} // namespace gf
+
+#endif // GF_RESOURCE_BUDGET_H
@@ -9,31 +9,44 @@
 #include <functional>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "CoreApi.h"
+#include "Graph.h"
 #include "ResourceContext.h"
 #include "ResourceManager.h"
 #include "TypeTraits.h"
 
 namespace gf {
-  namespace details {
-    template<typename T, typename = std::void_t<>>
-    inline constexpr bool HasPrimitive = false;
+  class ThreadPool;
 
-    template<typename T>
-    inline constexpr bool HasPrimitive<T, std::void_t<typename T::Primitive>> = true;
+  namespace details {
+    // the loads of a bundle and their dependencies, see ResourceBundle::load_from()
+    class GF_CORE_API ResourcePlan {
+    public:
+      // the undo function is called in reverse order if the run fails after the task
+      VertexId add_task(std::function<void()> task, bool parallel, const std::vector<VertexId>& dependencies, std::function<void()> undo = {});
+      std::size_t task_count() const;
+      void run(ThreadPool* pool, const std::function<void(std::size_t, std::size_t)>& progress);
 
-    template<typename T, typename = std::void_t<>>
-    inline constexpr bool HasBundle = false;
+      // the pool of the current run
+      ThreadPool* pool() const
+      {
+        return m_pool;
+      }
 
-    template<typename T>
-    inline constexpr bool HasBundle<T, std::void_t<decltype(T::bundle(std::declval<std::filesystem::path>()))>> = true;
+    private:
+      struct Task {
+        std::function<void()> function;
+        bool parallel = false;
+        std::function<void()> undo;
+      };
 
-    template<typename T, typename = std::void_t<>>
-    inline constexpr bool HasBundleWithContext = false;
+      Graph m_graph;
+      std::vector<Task> m_tasks;
+      ThreadPool* m_pool = nullptr;
+    };
 
-    template<typename T>
-    inline constexpr bool HasBundleWithContext<T, std::void_t<decltype(T::bundle(std::declval<std::filesystem::path>(), std::declval<ResourceContext<T>>()))>> = true;
   } // namespace details
 
   enum class ResourceAction : uint8_t {
@@ -41,6 +54,8 @@ namespace gf {
     Unload,
   };
 
+  using ResourceProgress = std::function<void(std::size_t loaded, std::size_t total)>;
+
   class GF_CORE_API ResourceBundle {
   public:
     ResourceBundle() = default;
@@ -58,6 +73,7 @@ namespace gf {
     }
 
     void load_from(ResourceManager* manager);
+    void load_from(ResourceManager* manager, ThreadPool* pool, const ResourceProgress& progress = {});
     void unload_from(ResourceManager* manager);
 
     template<typename T>
@@ -68,6 +84,11 @@ namespace gf {
       switch (action) {
         case ResourceAction::Load:
           {
+            if (m_plan != nullptr) {
+              plan_load<T>(path, manager);
+              break;
+            }
+
             if constexpr (details::HasPrimitive<T>) {
               handle<typename T::Primitive>(path, manager, action);
             }
@@ -104,6 +125,11 @@ namespace gf {
       switch (action) {
         case ResourceAction::Load:
           {
+            if (m_plan != nullptr) {
+              plan_load<T>(path, context, manager);
+              break;
+            }
+
             if constexpr (details::HasPrimitive<T>) {
               if constexpr (details::HasContext<typename T::Primitive>) {
                 handle<typename T::Primitive>(path, context, manager, action);
@@ -141,7 +167,90 @@ namespace gf {
     }
 
   private:
+    std::vector<VertexId> plan_into(details::ResourcePlan* plan, ResourceManager* manager);
+
+    template<typename T>
+    VertexId plan_load(const std::filesystem::path& path, ResourceManager* manager)
+    {
+      std::vector<VertexId> dependencies;
+
+      if constexpr (details::HasPrimitive<T>) {
+        dependencies.push_back(plan_load<typename T::Primitive>(path, manager));
+      }
+
+      if constexpr (details::HasBundle<T>) {
+        if constexpr (details::HasPrimitive<T>) {
+          // the bundle may need the primitive, so it is computed and planned once the primitive is loaded
+          auto bundle_task = [path, manager, plan = m_plan]() {
+            T::bundle(path).load_from(manager, plan->pool());
+          };
+
+          auto bundle_undo = [path, manager]() {
+            T::bundle(path).unload_from(manager);
+          };
+
+          dependencies = { m_plan->add_task(std::move(bundle_task), false, dependencies, std::move(bundle_undo)) };
+        } else {
+          const std::vector<VertexId> bundle_dependencies = T::bundle(path).plan_into(m_plan, manager);
+          dependencies.insert(dependencies.end(), bundle_dependencies.begin(), bundle_dependencies.end());
+        }
+      }
+
+      auto task = [path, manager]() {
+        manager->load<T>(path);
+      };
+
+      auto undo = [path, manager]() {
+        manager->unload<T>(path);
+      };
+
+      return m_plan->add_task(std::move(task), EnableParallelLoad<T>::value, dependencies, std::move(undo));
+    }
+
+    template<typename T>
+    VertexId plan_load(const std::filesystem::path& path, const ResourceContext<T>& context, ResourceManager* manager)
+    {
+      std::vector<VertexId> dependencies;
+
+      if constexpr (details::HasPrimitive<T>) {
+        if constexpr (details::HasContext<typename T::Primitive>) {
+          dependencies.push_back(plan_load<typename T::Primitive>(path, context, manager));
+        } else {
+          dependencies.push_back(plan_load<typename T::Primitive>(path, manager));
+        }
+      }
+
+      if constexpr (details::HasBundleWithContext<T>) {
+        if constexpr (details::HasPrimitive<T>) {
+          // the bundle may need the primitive, so it is computed and planned once the primitive is loaded
+          auto bundle_task = [path, context, manager, plan = m_plan]() {
+            T::bundle(path, context).load_from(manager, plan->pool());
+          };
+
+          auto bundle_undo = [path, context, manager]() {
+            T::bundle(path, context).unload_from(manager);
+          };
+
+          dependencies = { m_plan->add_task(std::move(bundle_task), false, dependencies, std::move(bundle_undo)) };
+        } else {
+          const std::vector<VertexId> bundle_dependencies = T::bundle(path, context).plan_into(m_plan, manager);
+          dependencies.insert(dependencies.end(), bundle_dependencies.begin(), bundle_dependencies.end());
+        }
+      }
+
+      auto task = [path, context, manager]() {
+        manager->load<T>(path, context);
+      };
+
+      auto undo = [path, manager]() {
+        manager->unload<T>(path);
+      };
+
+      return m_plan->add_task(std::move(task), EnableParallelLoad<T>::value, dependencies, std::move(undo));
+    }
+
     std::function<void(ResourceBundle*, ResourceManager*, ResourceAction)> m_callback;
+    details::ResourcePlan* m_plan = nullptr; // only while the bundle is planned
   };
 
 } // namespace gf
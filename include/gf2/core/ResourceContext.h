@@ -3,7 +3,11 @@
 #ifndef GF_RESOURCE_CONTEXT_H
 #define GF_RESOURCE_CONTEXT_H
 
+#include <cstddef>
+
+#include <filesystem>
 #include <type_traits>
+#include <utility>
 
 namespace gf {
 
@@ -27,6 +31,44 @@ namespace gf {
   template<typename T>
   using ResourceContext = ResourceContextTraits<T>::Type;
 
+  namespace details {
+    template<typename T, typename = std::void_t<>>
+    inline constexpr bool HasPrimitive = false;
+
+    template<typename T>
+    inline constexpr bool HasPrimitive<T, std::void_t<typename T::Primitive>> = true;
+
+    template<typename T, typename = std::void_t<>>
+    inline constexpr bool HasBundle = false;
+
+    template<typename T>
+    inline constexpr bool HasBundle<T, std::void_t<decltype(T::bundle(std::declval<std::filesystem::path>()))>> = true;
+
+    template<typename T, typename = std::void_t<>>
+    inline constexpr bool HasBundleWithContext = false;
+
+    template<typename T>
+    inline constexpr bool HasBundleWithContext<T, std::void_t<decltype(T::bundle(std::declval<std::filesystem::path>(), std::declval<ResourceContext<T>>()))>> = true;
+
+    // a composite resource keeps pointers to its primitive and to the resources of its bundle
+    template<typename T>
+    inline constexpr bool IsCompositeResource = HasPrimitive<T> || HasBundle<T> || HasBundleWithContext<T>;
+  }
+
+  // resources that can be loaded on any thread, concurrently with other resources
+  template<typename T>
+  struct EnableParallelLoad : std::false_type {
+  };
+
+  // an estimation of the memory used by a resource, for the memory budgets
+  template<typename T>
+  struct ResourceSize {
+    static std::size_t estimate([[maybe_unused]] const T& resource)
+    {
+      return sizeof(T);
+    }
+  };
+
 }
 
 #endif // GF_RESOURCE_CONTEXT_H
@@ -4,20 +4,34 @@
 #define GF_RESOURCE_LOADERS_H
 
 #include <map>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "AssetCache.h"
+#include "AssetPack.h"
 #include "CoreApi.h"
 #include "ResourceContext.h"
+#include "ResourceProfiler.h"
 #include "Span.h"
 #include "Streams.h"
 #include "Tarball.h"
 
 namespace gf {
+  class ThreadPool;
 
   class GF_CORE_API FileLoader {
   public:
     void add_search_directory(std::filesystem::path directory);
     std::filesystem::path search(const std::filesystem::path& relative_path);
 
+    void enable_index(ThreadPool* pool = nullptr);
+    void refresh_index();
+    bool indexed() const;
+
+    void set_asset_cache(AssetCache* cache);
+
     template<typename T>
     std::unique_ptr<T> operator()(const std::filesystem::path& path, const ResourceContext<T>& context = {})
     {
@@ -27,15 +41,61 @@ namespace gf {
         return nullptr;
       }
 
+      details::ResourceLoadProbe::add_file_read(absolute_path);
+
+      if constexpr (AssetCacheTraits<T>::Enabled) {
+        if (AssetCache* cache = asset_cache(); cache != nullptr) {
+          return load_cached<T>(cache, absolute_path, context);
+        }
+      }
+
       if constexpr (std::is_empty_v<ResourceContext<T>>) {
-        return std::make_unique<T>(absolute_path);
+        return details::decode_resource<T>(absolute_path);
       } else {
-        return std::make_unique<T>(absolute_path, context);
+        return details::decode_resource<T>(absolute_path, context);
       }
     }
 
   private:
+    template<typename T>
+    std::unique_ptr<T> load_cached(AssetCache* cache, const std::filesystem::path& absolute_path, const ResourceContext<T>& context)
+    {
+      // the key only depends on the content of the file, not on its location
+      AssetCacheKey key(AssetCacheTraits<T>::Processor, AssetCacheTraits<T>::Version);
+      key.add_file(absolute_path);
+
+      if constexpr (!std::is_empty_v<ResourceContext<T>>) {
+        key.add_parameter(context, AssetCacheTraits<T>::ArchiveVersion);
+      }
+
+      const SecureHash::Hash hash = key.result();
+
+      if (auto resource = std::make_unique<T>(); cache->load(hash, *resource, AssetCacheTraits<T>::ArchiveVersion)) {
+        return resource;
+      }
+
+      std::unique_ptr<T> resource = nullptr;
+
+      if constexpr (std::is_empty_v<ResourceContext<T>>) {
+        resource = details::decode_resource<T>(absolute_path);
+      } else {
+        resource = details::decode_resource<T>(absolute_path, context);
+      }
+
+      cache->store(hash, *resource, AssetCacheTraits<T>::ArchiveVersion);
+      return resource;
+    }
+
+    AssetCache* asset_cache() const;
+    void index_directory(const std::filesystem::path& directory, std::size_t directory_index);
+
     std::vector<std::filesystem::path> m_search_directories;
+
+    mutable std::shared_mutex m_mutex;
+    bool m_indexed = false;
+    ThreadPool* m_pool = nullptr;
+    AssetCache* m_asset_cache = nullptr;
+    std::unordered_map<std::string, std::size_t> m_index; // normalized relative path -> search directory
   };
 
   class GF_CORE_API MemoryLoader {
@@ -52,12 +112,13 @@ namespace gf {
         return nullptr;
       }
 
+      details::ResourceLoadProbe::add_bytes_read(buffer.size());
       MemoryInputStream input(buffer);
 
       if constexpr (std::is_empty_v<ResourceContext<T>>) {
-        return std::make_unique<T>(input);
+        return details::decode_resource<T>(input);
       } else {
-        return std::make_unique<T>(input, context);
+        return details::decode_resource<T>(input, context);
       }
     }
 
@@ -70,22 +131,36 @@ namespace gf {
     TarballLoader(const std::filesystem::path& tarball_path);
 
     std::vector<uint8_t> search(const std::filesystem::path& relative_path);
+    Span<const uint8_t> search_view(const std::filesystem::path& relative_path) const;
 
     template<typename T>
     std::unique_ptr<T> operator()(const std::filesystem::path& path, const ResourceContext<T>& context = {})
     {
+      // an uncompressed tarball is mapped in memory, the resource is loaded directly from the mapping
+      if (const Span<const uint8_t> memory = search_view(path); !memory.empty()) {
+        details::ResourceLoadProbe::add_bytes_read(memory.size());
+        MemoryInputStream input(memory);
+
+        if constexpr (std::is_empty_v<ResourceContext<T>>) {
+          return details::decode_resource<T>(input);
+        } else {
+          return details::decode_resource<T>(input, context);
+        }
+      }
+
       const std::vector<uint8_t> buffer = search(path);
 
       if (buffer.empty()) {
         return nullptr;
       }
 
+      details::ResourceLoadProbe::add_bytes_read(buffer.size());
       BufferInputStream input(&buffer);
 
       if constexpr (std::is_empty_v<ResourceContext<T>>) {
-        return std::make_unique<T>(input);
+        return details::decode_resource<T>(input);
       } else {
-        return std::make_unique<T>(input, context);
+        return details::decode_resource<T>(input, context);
       }
     }
 
@@ -93,6 +168,48 @@ namespace gf {
     Tarball m_tarball;
   };
 
+  class GF_CORE_API PackLoader {
+  public:
+    PackLoader(const std::filesystem::path& pack_path);
+
+    std::vector<uint8_t> search(const std::filesystem::path& relative_path) const;
+    Span<const uint8_t> search_view(const std::filesystem::path& relative_path) const;
+
+    template<typename T>
+    std::unique_ptr<T> operator()(const std::filesystem::path& path, const ResourceContext<T>& context = {})
+    {
+      // an uncompressed entry is loaded directly from the mapped pack
+      if (const Span<const uint8_t> memory = search_view(path); !memory.empty()) {
+        details::ResourceLoadProbe::add_bytes_read(memory.size());
+        MemoryInputStream input(memory);
+
+        if constexpr (std::is_empty_v<ResourceContext<T>>) {
+          return details::decode_resource<T>(input);
+        } else {
+          return details::decode_resource<T>(input, context);
+        }
+      }
+
+      const std::vector<uint8_t> buffer = search(path);
+
+      if (buffer.empty()) {
+        return nullptr;
+      }
+
+      details::ResourceLoadProbe::add_bytes_read(buffer.size());
+      BufferInputStream input(&buffer);
+
+      if constexpr (std::is_empty_v<ResourceContext<T>>) {
+        return details::decode_resource<T>(input);
+      } else {
+        return details::decode_resource<T>(input, context);
+      }
+    }
+
+  private:
+    AssetPack m_pack;
+  };
+
 } // namespace gf
 
 #endif // GF_RESOURCE_LOADERS_H
@@ -8,43 +8,80 @@
 
 #include <any>
 #include <filesystem>
+#include <future>
 #include <map>
 #include <mutex>
 #include <typeindex>
 
 #include "CoreApi.h"
 #include "Log.h"
+#include "ResourceBudget.h"
 #include "ResourceContext.h"
+#include "ResourceProfiler.h"
 #include "ResourceRegistry.h"
+#include "ThreadPool.h"
 
 namespace gf {
 
   class GF_CORE_API ResourceManager {
   public:
+    ResourceManager(ThreadPool* pool = nullptr)
+    : m_pool(pool)
+    {
+    }
 
     void add_registry(std::nullptr_t registry) = delete;
 
     template<typename T>
     void add_registry(ResourceRegistry<T>* registry)
     {
-      const std::scoped_lock<std::recursive_mutex> lock(m_mutex);
+      const std::scoped_lock<std::mutex> lock(m_mutex);
       assert(registry != nullptr);
       [[maybe_unused]] auto [iterator, inserted] = m_resources.emplace(std::type_index(typeid(T)), registry);
       assert(inserted);
+      registry->set_shared_budget(&m_budget);
+      registry->set_profiler(&m_profiler);
+    }
+
+    // the budget shared by all the registries, 0 means no budget
+    void set_memory_budget(std::size_t limit)
+    {
+      m_budget.set_limit(limit);
+    }
+
+    std::size_t memory_budget() const
+    {
+      return m_budget.limit();
+    }
+
+    std::size_t memory_usage() const
+    {
+      return m_budget.usage();
+    }
+
+    // the profiler shared by all the registries, disabled by default
+    ResourceProfiler& profiler()
+    {
+      return m_profiler;
     }
 
     template<typename T>
     T* get(const std::filesystem::path& path)
     {
-      const std::scoped_lock<std::recursive_mutex> lock(m_mutex);
       ResourceRegistry<T>* registry = search_registry<T>();
       return registry->get(path);
     }
 
+    template<typename T>
+    T* get(Id key)
+    {
+      ResourceRegistry<T>* registry = search_registry<T>();
+      return registry->get(key);
+    }
+
     template<typename T>
     T* acquire(const std::filesystem::path& path, const ResourceContext<T>& context = {})
     {
-      const std::scoped_lock<std::recursive_mutex> lock(m_mutex);
       ResourceRegistry<T>* registry = search_registry<T>();
 
       if (registry->loaded(path)) {
@@ -57,15 +94,32 @@ namespace gf {
     template<typename T>
     T* load(const std::filesystem::path& path, const ResourceContext<T>& context = {})
     {
-      const std::scoped_lock<std::recursive_mutex> lock(m_mutex);
       ResourceRegistry<T>* registry = search_registry<T>();
       return registry->load(path, context);
     }
 
+    template<typename T>
+    std::future<T*> load_async(const std::filesystem::path& path, const ResourceContext<T>& context = {})
+    {
+      ResourceRegistry<T>* registry = search_registry<T>();
+
+      auto load_resource = [registry, path, context]() {
+        return registry->load(path, context);
+      };
+
+      if (m_pool == nullptr) {
+        std::packaged_task<T*()> task(std::move(load_resource));
+        std::future<T*> result = task.get_future();
+        task();
+        return result;
+      }
+
+      return m_pool->submit(std::move(load_resource));
+    }
+
     template<typename T>
     void unload(const std::filesystem::path& path)
     {
-      const std::scoped_lock<std::recursive_mutex> lock(m_mutex);
       ResourceRegistry<T>* registry = search_registry<T>();
       registry->unload(path);
     }
@@ -74,6 +128,8 @@ namespace gf {
     template<typename T>
     ResourceRegistry<T>* search_registry()
     {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
       if (auto resources_iterator = m_resources.find(std::type_index(typeid(T))); resources_iterator != m_resources.end()) {
         auto& [type_index, any_registry] = *resources_iterator;
         assert(any_registry.type() == typeid(ResourceRegistry<T>*));
@@ -83,7 +139,10 @@ namespace gf {
       Log::fatal("No registry for this type of resource.");
     }
 
-    std::recursive_mutex m_mutex;
+    ThreadPool* m_pool = nullptr;
+    ResourceBudget m_budget;
+    ResourceProfiler m_profiler;
+    std::mutex m_mutex; // only for the registries, the registries have their own lock
     std::map<std::type_index, std::any> m_resources;
   };
 
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_RESOURCE_PROFILER_H
+#define GF_RESOURCE_PROFILER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Clock.h"
+#include "CoreApi.h"
+#include "Time.h"
+
+namespace gf {
+  class ResourceProfiler;
+
+  struct GF_CORE_API ResourceLoadRecord {
+    std::string path;
+    uint32_t thread = 0;    // index of the thread, in the order of their first load
+    Time start;             // since the creation of the profiler
+    Time wall_time;         // the whole load, including the wait for another thread loading the same resource
+    Time decode_time;       // the construction of the resource by the loader
+    std::size_t bytes_read = 0;
+    bool cache_hit = false; // the resource was already loaded or being loaded
+    uint32_t depth = 0;     // number of loads in progress in the same thread, e.g. a loader that loads another resource
+  };
+
+  enum class ResourceReportFormat : uint8_t {
+    Json,
+    ChromeTrace,
+  };
+
+  namespace details {
+
+    // measures a load in a registry, the loaders of the thread report to the current probe
+    class GF_CORE_API ResourceLoadProbe {
+    public:
+      ResourceLoadProbe(ResourceProfiler* profiler);
+      ResourceLoadProbe(const ResourceLoadProbe&) = delete;
+      ResourceLoadProbe(ResourceLoadProbe&&) noexcept = delete;
+      ~ResourceLoadProbe();
+
+      ResourceLoadProbe& operator=(const ResourceLoadProbe&) = delete;
+      ResourceLoadProbe& operator=(ResourceLoadProbe&&) noexcept = delete;
+
+      void set_cache_hit();
+      void finish(std::string path);
+
+      static void add_bytes_read(std::size_t bytes);
+      static void add_file_read(const std::filesystem::path& path);
+      static void add_decode_time(Time time);
+
+    private:
+      ResourceProfiler* m_profiler = nullptr; // null if the profiler is disabled
+      ResourceLoadProbe* m_previous = nullptr;
+      Clock m_clock;
+      ResourceLoadRecord m_record;
+    };
+
+    template<typename T, typename... Args>
+    std::unique_ptr<T> decode_resource(Args&&... args)
+    {
+      const Clock clock;
+      auto resource = std::make_unique<T>(std::forward<Args>(args)...);
+      ResourceLoadProbe::add_decode_time(clock.elapsed_time());
+      return resource;
+    }
+
+  } // namespace details
+
+  class GF_CORE_API ResourceProfiler {
+  public:
+    ResourceProfiler() = default;
+    ResourceProfiler(const ResourceProfiler&) = delete;
+    ResourceProfiler(ResourceProfiler&&) noexcept = delete;
+    ~ResourceProfiler();
+
+    ResourceProfiler& operator=(const ResourceProfiler&) = delete;
+    ResourceProfiler& operator=(ResourceProfiler&&) noexcept = delete;
+
+    void set_enabled(bool enabled);
+    bool enabled() const;
+
+    // the report is saved when the profiler is destroyed, e.g. at shutdown
+    void set_report_file(std::filesystem::path filename, ResourceReportFormat format = ResourceReportFormat::Json);
+
+    void record(ResourceLoadRecord record);
+    Time elapsed_time() const;
+
+    std::vector<ResourceLoadRecord> records() const;
+    std::vector<ResourceLoadRecord> slowest(std::size_t count) const;
+    std::size_t record_count() const;
+    std::size_t cache_hit_count() const;
+    Time total_load_time() const;
+    void clear();
+
+    void save_report(const std::filesystem::path& filename, ResourceReportFormat format = ResourceReportFormat::Json) const;
+
+  private:
+    std::atomic<bool> m_enabled = false;
+    Clock m_clock;
+
+    mutable std::mutex m_mutex;
+    std::vector<ResourceLoadRecord> m_records;
+    std::map<std::thread::id, uint32_t> m_threads;
+    std::filesystem::path m_report_file;
+    ResourceReportFormat m_report_format = ResourceReportFormat::Json;
+  };
+
+} // namespace gf
+
+#endif // GF_RESOURCE_PROFILER_H
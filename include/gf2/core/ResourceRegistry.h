@@ -5,127 +5,295 @@
 
 #include <cassert>
 
+#include <atomic>
+#include <exception>
 #include <filesystem>
-#include <map>
+#include <future>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "CoreApi.h"
+#include "Id.h"
 #include "Log.h"
+#include "ResourceBudget.h"
 #include "ResourceContext.h"
 #include "ResourceLoader.h"
+#include "ResourceProfiler.h"
 
 namespace gf {
 
+  GF_CORE_API Id resource_key(const std::filesystem::path& path);
+
   template<typename T>
-  class ResourceRegistry {
+  class ResourceRegistry : public details::ResourceCache {
   public:
+    ResourceRegistry() = default;
+    ResourceRegistry(const ResourceRegistry&) = delete;
+    ResourceRegistry(ResourceRegistry&&) noexcept = delete;
+
+    ~ResourceRegistry() override
+    {
+      set_shared_budget(nullptr);
+    }
+
+    ResourceRegistry& operator=(const ResourceRegistry&) = delete;
+    ResourceRegistry& operator=(ResourceRegistry&&) noexcept = delete;
 
     void add_loader(ResourceLoader<T> loader)
     {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
       m_loaders.push_back(std::move(loader));
     }
 
     bool loaded(const std::filesystem::path& path) const
     {
-      if (path.is_absolute()) {
-        std::filesystem::path base_path = path.parent_path();
+      return search_key(path, [this](Id key, std::string_view relative_path) { return try_loaded(key, relative_path); });
+    }
 
-        while (base_path.has_relative_path()) {
-          const std::filesystem::path relative_path = std::filesystem::relative(path, base_path);
+    bool loaded(Id key) const
+    {
+      return try_loaded(key, {});
+    }
 
-          if (try_loaded(relative_path)) {
-            return true;
-          }
+    T* get(const std::filesystem::path& path) const
+    {
+      T* resource = nullptr;
 
-          base_path = base_path.parent_path();
-        }
-      } else {
-        return try_loaded(path);
+      search_key(path, [&](Id key, std::string_view relative_path) {
+        resource = try_get(key, relative_path);
+        return resource != nullptr;
+      });
+
+      if (resource == nullptr) {
+        Log::fatal("Resource not already loaded: '{}'", path.string());
       }
 
-      return false;
+      return resource;
     }
 
-    T* get(const std::filesystem::path& path) const
+    T* get(Id key) const
     {
-      if (path.is_absolute()) {
-        std::filesystem::path base_path = path.parent_path();
+      if (T* resource = try_get(key, {}); resource != nullptr) {
+        return resource;
+      }
 
-        while (base_path.has_relative_path()) {
-          const std::filesystem::path relative_path = std::filesystem::relative(path, base_path);
+      Log::fatal("Resource not already loaded: {:x}", static_cast<uint64_t>(key));
+    }
 
-          if (T* resource = try_get(relative_path); resource != nullptr) {
-            return resource;
-          }
+    T* load(const std::filesystem::path& path, const ResourceContext<T>& context = {})
+    {
+      details::ResourceLoadProbe probe(m_profiler);
+      T* resource = nullptr;
 
-          base_path = base_path.parent_path();
-        }
-      } else {
-        if (T* resource = try_get(path); resource != nullptr) {
-          return resource;
+      search_key(path, [&](Id key, std::string_view relative_path) {
+        resource = try_load(key, relative_path, context, probe);
+
+        if (resource != nullptr) {
+          probe.finish(std::string(relative_path));
         }
+
+        return resource != nullptr;
+      });
+
+      if (resource == nullptr) {
+        Log::fatal("Resource not loaded: '{}'", path.string());
       }
 
-      Log::fatal("Resource not already loaded: '{}'", path.string());
+      return resource;
     }
 
-    T* load(const std::filesystem::path& path, const ResourceContext<T>& context = {})
+    void unload(const std::filesystem::path& path)
     {
-      if (path.is_absolute()) {
-        std::filesystem::path base_path = path.parent_path();
+      if (!search_key(path, [this](Id key, std::string_view relative_path) { return try_unload(key, relative_path); })) {
+        Log::fatal("Resource already unloaded: '{}'", path.string());
+      }
+    }
 
-        while (base_path.has_relative_path()) {
-          const std::filesystem::path relative_path = std::filesystem::relative(path, base_path);
+    // every load is recorded in the profiler, if it is enabled
+    void set_profiler(ResourceProfiler* profiler)
+    {
+      m_profiler = profiler;
+    }
 
-          if (T* resource = try_load(relative_path, context); resource != nullptr) {
-            return resource;
-          }
+    // unreferenced resources are kept until the budget is exceeded, 0 means no budget
+    void set_budget(std::size_t limit)
+    {
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+        m_limit = limit;
+      }
+
+      enforce_budget();
+    }
+
+    std::size_t budget() const
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      return m_limit;
+    }
+
+    void set_shared_budget(ResourceBudget* budget)
+    {
+      ResourceBudget* previous_budget = nullptr;
+
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+        previous_budget = std::exchange(m_shared_budget, budget);
 
-          base_path = base_path.parent_path();
+        if (previous_budget != nullptr) {
+          previous_budget->remove_usage(m_usage);
         }
-      } else {
-        if (T* resource = try_load(path, context); resource != nullptr) {
-          return resource;
+
+        if (budget != nullptr) {
+          budget->add_usage(m_usage);
         }
       }
 
-      Log::fatal("Resource not loaded: '{}'", path.string());
+      // the lock of a budget is taken before the lock of its registries (see ResourceBudget::enforce()), so the budgets are changed without the lock of the registry
+      if (previous_budget != nullptr) {
+        previous_budget->detach(this);
+      }
+
+      if (budget != nullptr) {
+        budget->attach(this);
+      }
     }
 
-    void unload(const std::filesystem::path& path)
+    std::size_t memory_usage() const
     {
-      if (path.is_absolute()) {
-        std::filesystem::path base_path = path.parent_path();
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      return m_usage;
+    }
 
-        while (base_path.has_relative_path()) {
-          const std::filesystem::path relative_path = std::filesystem::relative(path, base_path);
+    std::size_t unused_count() const
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      return m_unused.size();
+    }
 
-          if (try_unload(relative_path)) {
-            return;
-          }
+    void evict_unused()
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
+      while (!m_unused.empty()) {
+        evict_front();
+      }
+    }
+
+    std::optional<uint64_t> oldest_unused() const override
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
+      if (m_unused.empty()) {
+        return std::nullopt;
+      }
+
+      return m_cache.at(m_unused.front()).tick;
+    }
+
+    std::size_t evict_oldest_unused() override
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
 
-          base_path = base_path.parent_path();
+      if (m_unused.empty()) {
+        return 0;
+      }
+
+      return evict_front();
+    }
+
+    void detach_budget(ResourceBudget* budget) override
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
+      if (m_shared_budget == budget) {
+        m_shared_budget = nullptr;
+      }
+    }
+
+  private:
+    struct Counted {
+      std::unique_ptr<T> pointer;
+      std::string path; // normalized relative path, to detect collisions
+      std::size_t count = 1;
+      std::size_t size = 0;
+      uint64_t tick = 0; // when the resource was last unreferenced
+      std::list<Id>::iterator unused = {}; // position in m_unused if count == 0
+    };
+
+    struct Pending {
+      std::shared_future<T*> result;
+      std::string path; // normalized relative path, to detect collisions
+      std::size_t waiting = 0; // number of threads waiting for the result
+    };
+
+    // call function with the key of every relative path that could identify the resource, until it returns true
+    template<typename Func>
+    static bool search_key(const std::filesystem::path& path, Func function)
+    {
+      const std::string normalized = path.lexically_normal().generic_string();
+
+      if (!path.is_absolute()) {
+        return function(hash_string(normalized), normalized);
+      }
+
+      // the suffixes of the path after each separator, from the shortest to the longest, excluding the root
+      const std::size_t root_size = path.root_path().generic_string().size();
+      std::size_t end = normalized.size();
+
+      while (end > root_size) {
+        const std::size_t separator = normalized.rfind('/', end - 1);
+
+        if (separator == std::string::npos || separator < root_size) {
+          break;
         }
-      } else {
-        if (try_unload(path)) {
-          return;
+
+        const std::string_view relative_path = std::string_view(normalized).substr(separator + 1);
+
+        if (!relative_path.empty() && function(hash_string(relative_path), relative_path)) {
+          return true;
         }
+
+        end = separator;
       }
 
-      Log::fatal("Resource already unloaded: '{}'", path.string());
+      return false;
     }
 
-  private:
-    bool try_loaded(const std::filesystem::path& path) const
+    // two paths with the same key would silently share a resource, the relative path is empty when only the key is known
+    static void check_path(const std::string& stored_path, std::string_view relative_path)
     {
-      return m_cache.find(path) != m_cache.end();
+      if (!relative_path.empty() && stored_path != relative_path) {
+        Log::fatal("Resource key collision between '{}' and '{}'", stored_path, relative_path);
+      }
     }
 
-    T* try_get(const std::filesystem::path& path) const
+    bool try_loaded(Id key, std::string_view relative_path) const
     {
-      assert(path.is_relative());
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      auto cache_iterator = m_cache.find(key);
+
+      if (cache_iterator == m_cache.end() || cache_iterator->second.count == 0) {
+        return false;
+      }
 
-      if (auto cache_iterator = m_cache.find(path); cache_iterator != m_cache.end()) {
+      check_path(cache_iterator->second.path, relative_path);
+      return true;
+    }
+
+    T* try_get(Id key, std::string_view relative_path) const
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
+      if (auto cache_iterator = m_cache.find(key); cache_iterator != m_cache.end() && cache_iterator->second.count > 0) {
         auto& [_, counted] = *cache_iterator;
+        check_path(counted.path, relative_path);
         // no ref increase
         return counted.pointer.get();
       }
@@ -133,16 +301,98 @@ namespace gf {
       return nullptr;
     }
 
-    T* try_load(const std::filesystem::path& path, const ResourceContext<T>& context = {})
+    T* try_load(Id key, std::string_view relative_path, const ResourceContext<T>& context, details::ResourceLoadProbe& probe)
     {
-      assert(path.is_relative());
+      std::promise<T*> promise;
+      std::shared_future<T*> pending_result;
 
-      if (auto cache_iterator = m_cache.find(path); cache_iterator != m_cache.end()) {
-        auto& [_, counted] = *cache_iterator;
-        ++counted.count;
-        return counted.pointer.get();
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+
+        if (auto cache_iterator = m_cache.find(key); cache_iterator != m_cache.end()) {
+          auto& [_, counted] = *cache_iterator;
+          check_path(counted.path, relative_path);
+
+          if (counted.count == 0) {
+            // a resource kept by the budget is used again
+            m_unused.erase(counted.unused);
+          }
+
+          ++counted.count;
+          probe.set_cache_hit();
+          return counted.pointer.get();
+        }
+
+        if (auto pending_iterator = m_pending.find(key); pending_iterator != m_pending.end()) {
+          // the resource is being loaded by another thread, share its result
+          auto& [_, pending] = *pending_iterator;
+          check_path(pending.path, relative_path);
+          ++pending.waiting;
+          pending_result = pending.result;
+          probe.set_cache_hit();
+        } else {
+          m_pending.emplace(key, Pending{ promise.get_future().share(), std::string(relative_path), 0 });
+        }
+      }
+
+      if (pending_result.valid()) {
+        // the loading thread has already counted this reference
+        return pending_result.get();
+      }
+
+      // the loaders are called without the lock, so that other resources can be loaded concurrently
+      const std::filesystem::path path(relative_path);
+      std::unique_ptr<T> pointer;
+
+      try {
+        pointer = try_loaders(path, context);
+      } catch (...) {
+        {
+          const std::scoped_lock<std::mutex> lock(m_mutex);
+          m_pending.erase(key);
+        }
+
+        promise.set_exception(std::current_exception());
+        throw;
       }
 
+      T* resource = nullptr;
+
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+        auto node = m_pending.extract(key);
+        assert(!node.empty());
+
+        if (pointer) {
+          const std::size_t size = ResourceSize<T>::estimate(*pointer);
+          auto [iterator, inserted] = m_cache.emplace(key, Counted{ std::move(pointer), std::string(relative_path), 1 + node.mapped().waiting, size });
+
+          if (!inserted) {
+            Log::fatal("Resource not inserted in the registry: '{}'", path.string());
+          }
+
+          auto& [_, counted] = *iterator;
+          resource = counted.pointer.get();
+
+          m_usage += size;
+
+          if (m_shared_budget != nullptr) {
+            m_shared_budget->add_usage(size);
+          }
+        }
+      }
+
+      promise.set_value(resource);
+
+      if (resource != nullptr) {
+        enforce_budget();
+      }
+
+      return resource;
+    }
+
+    std::unique_ptr<T> try_loaders(const std::filesystem::path& path, const ResourceContext<T>& context)
+    {
       for (ResourceLoader<T>& loader : m_loaders) {
         std::unique_ptr<T> pointer;
 
@@ -152,46 +402,102 @@ namespace gf {
           pointer = loader(path, context);
         }
 
-        if (!pointer) {
-          continue;
+        if (pointer) {
+          return pointer;
+        }
+      }
+
+      return nullptr;
+    }
+
+    bool try_unload(Id key, std::string_view relative_path)
+    {
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+        auto cache_iterator = m_cache.find(key);
+
+        if (cache_iterator == m_cache.end() || cache_iterator->second.count == 0) {
+          return false;
         }
 
-        auto [iterator, inserted] = m_cache.emplace(path, Counted{ std::move(pointer), 1 });
+        auto& [_, counted] = *cache_iterator;
+        check_path(counted.path, relative_path);
+        --counted.count;
 
-        if (!inserted) {
-          Log::fatal("Resource not inserted in the registry: '{}'", path.string());
+        if (counted.count > 0) {
+          return true;
         }
 
-        auto& [_, counted] = *iterator;
-        return counted.pointer.get();
+        // a composite resource is not kept, as its dependencies may be evicted before it
+        if (details::IsCompositeResource<T> || (m_limit == 0 && (m_shared_budget == nullptr || m_shared_budget->limit() == 0))) {
+          erase(cache_iterator);
+          return true;
+        }
+
+        // keep the resource until the budget is exceeded
+        counted.tick = details::next_resource_tick();
+        counted.unused = m_unused.insert(m_unused.end(), key);
       }
 
-      return nullptr;
+      enforce_budget();
+      return true;
     }
 
-    bool try_unload(const std::filesystem::path& path)
+    void enforce_budget()
     {
-      if (auto cache_iterator = m_cache.find(path); cache_iterator != m_cache.end()) {
-        auto& [_, counted] = *cache_iterator;
-        --counted.count;
+      ResourceBudget* shared_budget = nullptr;
 
-        if (counted.count == 0) {
-          m_cache.erase(cache_iterator);
+      {
+        const std::scoped_lock<std::mutex> lock(m_mutex);
+
+        while (m_limit > 0 && m_usage > m_limit && !m_unused.empty()) {
+          evict_front();
         }
 
-        return true;
+        shared_budget = m_shared_budget;
       }
 
-      return false;
+      // the lock of the registry is released, as the shared budget may evict resources from this registry
+      if (shared_budget != nullptr) {
+        shared_budget->enforce();
+      }
     }
 
-    struct Counted {
-      std::unique_ptr<T> pointer;
-      std::size_t count = 1;
-    };
+    // the lock must be held
+    std::size_t erase(typename std::unordered_map<Id, Counted>::iterator cache_iterator)
+    {
+      const std::size_t size = cache_iterator->second.size;
+      assert(m_usage >= size);
+      m_usage -= size;
+
+      if (m_shared_budget != nullptr) {
+        m_shared_budget->remove_usage(size);
+      }
+
+      m_cache.erase(cache_iterator);
+      return size;
+    }
+
+    // the lock must be held
+    std::size_t evict_front()
+    {
+      assert(!m_unused.empty());
+      auto cache_iterator = m_cache.find(m_unused.front());
+      assert(cache_iterator != m_cache.end() && cache_iterator->second.count == 0);
+      m_unused.pop_front();
+      return erase(cache_iterator);
+    }
 
+    mutable std::mutex m_mutex;
     std::vector<ResourceLoader<T>> m_loaders;
-    std::map<std::filesystem::path, Counted> m_cache;
+    std::unordered_map<Id, Counted> m_cache;
+    std::unordered_map<Id, Pending> m_pending;
+
+    std::size_t m_limit = 0;
+    std::size_t m_usage = 0;
+    std::list<Id> m_unused; // unreferenced resources, least recently used first
+    ResourceBudget* m_shared_budget = nullptr;
+    std::atomic<ResourceProfiler*> m_profiler = nullptr;
   };
 
 } // namespace gf
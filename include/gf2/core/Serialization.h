@@ -10,6 +10,8 @@
 #include "Stream.h"
 
 namespace gf {
+  class BufferedInputStream;
+  class BufferedOutputStream;
 
   class GF_CORE_API Serializer {
   public:
@@ -17,6 +19,7 @@ namespace gf {
     using Constness = const T;
 
     Serializer(OutputStream* stream, uint16_t version = 0);
+    Serializer(BufferedOutputStream* stream, uint16_t version = 0);
 
     uint16_t version() const
     {
@@ -37,14 +40,17 @@ namespace gf {
     void write_f64(double data);
     void write_raw_string(const char* data, std::size_t size);
     void write_raw_size(std::size_t size);
+    void write_raw_bytes(Span<const uint8_t> bytes);
 
   private:
     void write_big_endian_64(uint64_t data);
     void write_big_endian_32(uint32_t data);
     void write_big_endian_16(uint16_t data);
     void write_big_endian_8(uint8_t data);
+    void write_bytes(Span<const uint8_t> bytes);
 
     OutputStream* m_stream;
+    BufferedOutputStream* m_buffered = nullptr; // same as m_stream, for the non-virtual fast path
     uint16_t m_version = 0;
   };
 
@@ -54,6 +60,7 @@ namespace gf {
     using Constness = T;
 
     Deserializer(InputStream* stream);
+    Deserializer(BufferedInputStream* stream);
 
     uint16_t version() const
     {
@@ -74,14 +81,17 @@ namespace gf {
     void read_f64(double* data);
     void read_raw_string(char* data, std::size_t size);
     void read_raw_size(std::size_t* size);
+    void read_raw_bytes(Span<uint8_t> bytes);
 
   private:
     void read_big_endian_64(uint64_t* data);
     void read_big_endian_32(uint32_t* data);
     void read_big_endian_16(uint16_t* data);
     void read_big_endian_8(uint8_t* data);
+    std::size_t read_bytes(Span<uint8_t> bytes);
 
     InputStream* m_stream;
+    BufferedInputStream* m_buffered = nullptr; // same as m_stream, for the non-virtual fast path
     uint16_t m_version = 0;
   };
 
@@ -3,11 +3,17 @@
 #ifndef GF_SERIALIZATION_CONTAINER_H
 #define GF_SERIALIZATION_CONTAINER_H
 
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <iterator>
 #include <map>
 #include <set>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -25,14 +31,97 @@ namespace gf {
    * - std::unordered_map
    * - std::unordered_set
    * - std::vector
+   *
+   * Contiguous sequences of arithmetic types (except bool) are serialized
+   * by blocks, with the same format as element by element serialization.
    */
 
+  namespace details {
+
+    template<typename T>
+    constexpr bool IsBlockSerializable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+    constexpr std::size_t BlockBufferSize = 4096;
+    constexpr std::size_t BlockGrowthSize = 65536;
+
+    template<std::size_t Size>
+    struct BlockUnsigned;
+
+    template<>
+    struct BlockUnsigned<2> {
+      using Type = uint16_t;
+    };
+
+    template<>
+    struct BlockUnsigned<4> {
+      using Type = uint32_t;
+    };
+
+    template<>
+    struct BlockUnsigned<8> {
+      using Type = uint64_t;
+    };
+
+    template<typename U>
+    constexpr U swap_bytes(U value)
+    {
+      U result = 0;
+
+      for (std::size_t i = 0; i < sizeof(U); ++i) {
+        result = static_cast<U>((result << 8) | (value & 0xFF));
+        value = static_cast<U>(value >> 8);
+      }
+
+      return result;
+    }
+
+    // the loop is simple enough to be vectorized by the compiler
+    template<typename T>
+    void swap_block(const uint8_t* source, uint8_t* target, std::size_t count)
+    {
+      using U = typename BlockUnsigned<sizeof(T)>::Type;
+
+      for (std::size_t i = 0; i < count; ++i) {
+        U value = 0;
+        std::memcpy(&value, source + (i * sizeof(U)), sizeof(U));
+        value = swap_bytes(value);
+        std::memcpy(target + (i * sizeof(U)), &value, sizeof(U));
+      }
+    }
+
+    template<typename T>
+    constexpr bool IsBlockNative = sizeof(T) == 1 || std::endian::native == std::endian::big;
+
+  }
+
   /*
    * Serializer
    */
 
   namespace details {
 
+    template<typename T>
+    Serializer& write_block(Serializer& ar, const T* data, std::size_t size)
+    {
+      ar.write_raw_size(size);
+      const auto* bytes = reinterpret_cast<const uint8_t*>(data); // NOLINT
+
+      if constexpr (IsBlockNative<T>) {
+        ar.write_raw_bytes(Span<const uint8_t>(bytes, size * sizeof(T)));
+      } else {
+        constexpr std::size_t ChunkSize = BlockBufferSize / sizeof(T);
+        std::array<uint8_t, BlockBufferSize> buffer = {};
+
+        for (std::size_t i = 0; i < size; i += ChunkSize) {
+          const std::size_t count = std::min(ChunkSize, size - i);
+          swap_block<T>(bytes + (i * sizeof(T)), buffer.data(), count);
+          ar.write_raw_bytes(Span<const uint8_t>(buffer.data(), count * sizeof(T)));
+        }
+      }
+
+      return ar;
+    }
+
     template<typename Iterator>
     Serializer& write_container(Serializer& ar, Iterator iterator, std::size_t size)
     {
@@ -50,19 +139,31 @@ namespace gf {
   template<typename T, std::size_t N>
   inline Serializer& operator|(Serializer& ar, const T (&array)[N])
   {
-    return details::write_container(ar, std::begin(array), std::size(array));
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::write_block(ar, std::data(array), std::size(array));
+    } else {
+      return details::write_container(ar, std::begin(array), std::size(array));
+    }
   }
 
   template<typename T>
   inline Serializer& operator|(Serializer& ar, const std::vector<T>& array)
   {
-    return details::write_container(ar, array.begin(), array.size());
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::write_block(ar, array.data(), array.size());
+    } else {
+      return details::write_container(ar, array.begin(), array.size());
+    }
   }
 
   template<typename T, std::size_t N>
   inline Serializer& operator|(Serializer& ar, const std::array<T, N>& array)
   {
-    return details::write_container(ar, array.begin(), array.size());
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::write_block(ar, array.data(), array.size());
+    } else {
+      return details::write_container(ar, array.begin(), array.size());
+    }
   }
 
   template<typename T>
@@ -156,31 +257,90 @@ namespace gf {
       return ar;
     }
 
+    template<typename T>
+    void read_block_data(Deserializer& ar, T* data, std::size_t size)
+    {
+      auto* bytes = reinterpret_cast<uint8_t*>(data); // NOLINT
+      ar.read_raw_bytes(Span<uint8_t>(bytes, size * sizeof(T)));
+
+      if constexpr (!IsBlockNative<T>) {
+        swap_block<T>(bytes, bytes, size);
+      }
+    }
+
+    template<typename T>
+    Deserializer& read_block(Deserializer& ar, T* data, std::size_t expected_size)
+    {
+      std::size_t size = 0;
+      ar.read_raw_size(&size);
+
+      if (size != expected_size) {
+        return ar;
+      }
+
+      read_block_data(ar, data, size);
+      return ar;
+    }
+
+    template<typename T>
+    Deserializer& read_block(Deserializer& ar, std::vector<T>& array)
+    {
+      std::size_t size = 0;
+      ar.read_raw_size(&size);
+
+      // grow progressively so that a corrupted size does not allocate everything at once
+      while (array.size() < size) {
+        const std::size_t offset = array.size();
+        const std::size_t count = std::min(BlockGrowthSize, size - offset);
+        array.resize(offset + count);
+        read_block_data(ar, array.data() + offset, count);
+      }
+
+      return ar;
+    }
+
   }
 
   template<typename T>
   inline Deserializer& operator|(Deserializer& ar, Span<T> array)
   {
-    return details::read_container<T>(ar, array.begin(), array.size());
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::read_block(ar, array.data(), array.size());
+    } else {
+      return details::read_container<T>(ar, array.begin(), array.size());
+    }
   }
 
   template<typename T, std::size_t N>
   inline Deserializer& operator|(Deserializer& ar, T (&array)[N])
   {
-    return details::read_container<T>(ar, std::begin(array), std::size(array));
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::read_block(ar, std::data(array), std::size(array));
+    } else {
+      return details::read_container<T>(ar, std::begin(array), std::size(array));
+    }
   }
 
   template<typename T>
   inline Deserializer& operator|(Deserializer& ar, std::vector<T>& array)
   {
     array.clear();
-    return details::read_container<T>(ar, std::back_inserter(array));
+
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::read_block(ar, array);
+    } else {
+      return details::read_container<T>(ar, std::back_inserter(array));
+    }
   }
 
   template<typename T, std::size_t N>
   inline Deserializer& operator|(Deserializer& ar, std::array<T, N>& array)
   {
-    return details::read_container<T>(ar, array.begin(), array.size());
+    if constexpr (details::IsBlockSerializable<T>) {
+      return details::read_block(ar, array.data(), array.size());
+    } else {
+      return details::read_container<T>(ar, array.begin(), array.size());
+    }
   }
 
   template<typename T>
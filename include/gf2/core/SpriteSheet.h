@@ -10,6 +10,7 @@
 #include "CoreApi.h"
 #include "NinePatchData.h"
 #include "Rect.h"
+#include "ResourceContext.h"
 #include "SpriteData.h"
 
 namespace gf {
@@ -34,6 +35,10 @@ namespace gf {
     std::map<std::string, RectI> m_sprites;
   };
 
+  template<>
+  struct EnableParallelLoad<SpriteSheet> : std::true_type {
+  };
+
 }
 
 #endif // GF_SPRITE_SHEET_H
@@ -26,6 +26,9 @@ namespace gf {
     virtual void skip(std::ptrdiff_t position) = 0;
     virtual bool finished() = 0;
 
+    // remaining bytes of the stream if they are already in memory, empty otherwise
+    virtual Span<const uint8_t> view();
+
     std::size_t read(uint8_t& byte)
     {
       return read(Span<uint8_t>(&byte, 1));
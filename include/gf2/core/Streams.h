@@ -5,9 +5,12 @@
 
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
 
 #include <array>
 #include <filesystem>
+#include <memory>
+#include <vector>
 
 #include <zlib.h>
 
@@ -16,6 +19,12 @@
 #include "Stream.h"
 
 namespace gf {
+  class ThreadPool;
+
+  namespace details {
+    class DeflateBlocks;
+    class InflateWindow;
+  }
 
   class GF_CORE_API FileInputStream : public InputStream {
   public:
@@ -45,15 +54,53 @@ namespace gf {
     void seek(std::ptrdiff_t position) override;
     void skip(std::ptrdiff_t position) override;
     bool finished() override;
+    Span<const uint8_t> view() override;
 
   private:
     Span<const uint8_t> m_memory;
     std::size_t m_offset = 0;
   };
 
+  class GF_CORE_API MappedFileInputStream : public InputStream {
+  public:
+    explicit MappedFileInputStream(const std::filesystem::path& path);
+    MappedFileInputStream(const MappedFileInputStream&) = delete;
+    MappedFileInputStream(MappedFileInputStream&& other) noexcept;
+    ~MappedFileInputStream() override;
+
+    MappedFileInputStream& operator=(const MappedFileInputStream&) = delete;
+    MappedFileInputStream& operator=(MappedFileInputStream&& other) noexcept;
+
+    Span<const uint8_t> memory() const
+    {
+      return { m_data, m_size };
+    }
+
+    Span<const uint8_t> read_span(std::size_t size);
+
+    std::size_t read(Span<uint8_t> buffer) override;
+    void seek(std::ptrdiff_t position) override;
+    void skip(std::ptrdiff_t position) override;
+    bool finished() override;
+    Span<const uint8_t> view() override;
+
+  private:
+    void unmap();
+
+    const uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::size_t m_offset = 0;
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+  };
+
   class GF_CORE_API CompressedInputStream : public InputStream {
   public:
-    explicit CompressedInputStream(InputStream* compressed);
+    static constexpr std::size_t DefaultCheckpointSpan = 1024 * 1024;
+
+    explicit CompressedInputStream(InputStream* compressed, std::size_t checkpoint_span = 0);
     CompressedInputStream(const CompressedInputStream&) = delete;
     CompressedInputStream(CompressedInputStream&& other) noexcept;
     ~CompressedInputStream() override;
@@ -66,13 +113,36 @@ namespace gf {
     void skip(std::ptrdiff_t position) override;
     bool finished() override;
 
+    std::size_t checkpoint_count() const
+    {
+      return m_checkpoints.size();
+    }
+
   private:
+    // an access point in the compressed stream, from which decompression can start
+    struct Checkpoint {
+      uint64_t position = 0; // in the uncompressed stream
+      uint64_t compressed_position = 0;
+      int bits = 0; // number of bits of the previous byte that belong to the next block
+      std::vector<uint8_t> window;
+    };
+
+    void restart(const Checkpoint* checkpoint);
+    void move_compressed_to(uint64_t compressed_position);
+    void discard(uint64_t size);
+
     InputStream* m_compressed;
     z_stream m_stream;
     uInt m_start = 0;
     uInt m_stop = 0;
     bool m_eof = false;
     std::array<Bytef, 256> m_buffer;
+    uint64_t m_position = 0;
+    uint64_t m_compressed_position = 0; // bytes read from the compressed stream
+    // checkpoint index
+    std::size_t m_checkpoint_span = 0;
+    std::unique_ptr<details::InflateWindow> m_window;
+    std::vector<Checkpoint> m_checkpoints;
   };
 
   class GF_CORE_API BufferInputStream : public InputStream {
@@ -88,12 +158,55 @@ namespace gf {
     void seek(std::ptrdiff_t position) override;
     void skip(std::ptrdiff_t position) override;
     bool finished() override;
+    Span<const uint8_t> view() override;
 
   private:
     const std::vector<uint8_t>* m_bytes;
     std::size_t m_offset = 0;
   };
 
+  class GF_CORE_API BufferedInputStream : public InputStream {
+  public:
+    static constexpr std::size_t DefaultBufferSize = 16384;
+
+    explicit BufferedInputStream(InputStream* stream, std::size_t buffer_size = DefaultBufferSize);
+    BufferedInputStream(const BufferedInputStream&) = delete;
+    BufferedInputStream(BufferedInputStream&& other) noexcept;
+    ~BufferedInputStream() override;
+
+    BufferedInputStream& operator=(const BufferedInputStream&) = delete;
+    BufferedInputStream& operator=(BufferedInputStream&& other) noexcept;
+
+    using InputStream::read;
+
+    std::size_t read(Span<uint8_t> buffer) final
+    {
+      // fast path: the data is already in the buffer
+      if (buffer.size() <= m_stop - m_start) {
+        if (!buffer.empty()) {
+          std::memcpy(buffer.data(), m_buffer.data() + m_start, buffer.size());
+          m_start += buffer.size();
+        }
+
+        return buffer.size();
+      }
+
+      return read_and_refill(buffer);
+    }
+
+    void seek(std::ptrdiff_t position) override;
+    void skip(std::ptrdiff_t position) override;
+    bool finished() override;
+
+  private:
+    std::size_t read_and_refill(Span<uint8_t> buffer);
+
+    InputStream* m_stream = nullptr;
+    std::vector<uint8_t> m_buffer;
+    std::size_t m_start = 0;
+    std::size_t m_stop = 0;
+  };
+
   class GF_CORE_API HashedInputStream : public InputStream {
   public:
     HashedInputStream(InputStream* stream);
@@ -145,9 +258,14 @@ namespace gf {
     std::size_t m_offset = 0;
   };
 
+  enum class CompressionFormat : uint8_t {
+    Zlib,
+    Gzip,
+  };
+
   class GF_CORE_API CompressedOutputStream : public OutputStream {
   public:
-    explicit CompressedOutputStream(OutputStream* compressed);
+    explicit CompressedOutputStream(OutputStream* compressed, CompressionFormat format = CompressionFormat::Zlib, ThreadPool* pool = nullptr);
     CompressedOutputStream(const CompressedOutputStream&) = delete;
     CompressedOutputStream(CompressedOutputStream&& other) noexcept;
     ~CompressedOutputStream() override;
@@ -159,9 +277,15 @@ namespace gf {
     std::size_t written_bytes() const override;
 
   private:
+    void write_trailer();
+
     OutputStream* m_compressed;
+    CompressionFormat m_format = CompressionFormat::Zlib;
     z_stream m_stream;
     std::array<Bytef, 256> m_buffer;
+    // parallel mode
+    std::unique_ptr<details::DeflateBlocks> m_blocks;
+    std::vector<uint8_t> m_block;
   };
 
   class GF_CORE_API BufferOutputStream : public OutputStream {
@@ -180,6 +304,47 @@ namespace gf {
     std::vector<uint8_t>* m_bytes;
   };
 
+  class GF_CORE_API BufferedOutputStream : public OutputStream {
+  public:
+    static constexpr std::size_t DefaultBufferSize = 16384;
+
+    explicit BufferedOutputStream(OutputStream* stream, std::size_t buffer_size = DefaultBufferSize);
+    BufferedOutputStream(const BufferedOutputStream&) = delete;
+    BufferedOutputStream(BufferedOutputStream&& other) noexcept;
+    ~BufferedOutputStream() override;
+
+    BufferedOutputStream& operator=(const BufferedOutputStream&) = delete;
+    BufferedOutputStream& operator=(BufferedOutputStream&& other) noexcept;
+
+    using OutputStream::write;
+
+    std::size_t write(Span<const uint8_t> buffer) final
+    {
+      // fast path: the data fits in the buffer
+      if (buffer.size() <= m_buffer.size() - m_size) {
+        if (!buffer.empty()) {
+          std::memcpy(m_buffer.data() + m_size, buffer.data(), buffer.size());
+          m_size += buffer.size();
+        }
+
+        return buffer.size();
+      }
+
+      return flush_and_write(buffer);
+    }
+
+    std::size_t written_bytes() const override;
+
+    void flush();
+
+  private:
+    std::size_t flush_and_write(Span<const uint8_t> buffer);
+
+    OutputStream* m_stream = nullptr;
+    std::vector<uint8_t> m_buffer;
+    std::size_t m_size = 0;
+  };
+
   class GF_CORE_API HashedOutputStream : public OutputStream {
   public:
     HashedOutputStream(OutputStream* stream);
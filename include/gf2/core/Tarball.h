@@ -4,13 +4,18 @@
 #define GF_TARBALL_H
 
 #include <cstdint>
+#include <cstdio>
 
 #include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
-#include <zlib.h>
-
 #include "CoreApi.h"
+#include "Span.h"
+#include "Streams.h"
 
 namespace gf {
 
@@ -25,22 +30,44 @@ namespace gf {
     Tarball& operator=(Tarball&& other) noexcept;
 
     std::vector<uint8_t> extract(const std::filesystem::path& path);
+    Span<const uint8_t> extract_view(const std::filesystem::path& path) const;
 
     std::vector<std::filesystem::path> entries() const;
 
+    void save_index() const;
+
+    static std::filesystem::path index_file(const std::filesystem::path& file);
+
   private:
     struct Entry {
       std::filesystem::path path;
-      long offset = 0;
+      uint64_t offset = 0;
       std::size_t size = 0;
     };
 
+    // an access point in the compressed stream, from which decompression can start
+    struct Checkpoint {
+      uint64_t position = 0; // in the uncompressed stream
+      uint64_t compressed_position = 0;
+      int bits = 0; // number of bits of the previous byte that belong to the next block
+      std::vector<uint8_t> window;
+    };
+
     void read_entries();
+    void add_entry(Entry entry);
     std::vector<uint8_t> extract_entry(const Entry& entry);
 
-    gzFile m_file = nullptr;
+    bool load_index();
+
+    std::filesystem::path m_path;
+    std::FILE* m_file = nullptr;
+    std::mutex m_file_mutex; // the file is shared by concurrent extractions
+    bool m_compressed = false;
+    std::optional<MappedFileInputStream> m_mapping; // only for uncompressed archives
 
     std::vector<Entry> m_entries;
+    std::unordered_map<std::string, std::size_t> m_entries_by_path;
+    std::vector<Checkpoint> m_checkpoints;
   };
 
 } // namespace gf
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_TEXTURE_DATA_H
+#define GF_TEXTURE_DATA_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <vector>
+
+#include "BlockCompression.h"
+#include "CoreApi.h"
+#include "Image.h"
+#include "Span.h"
+#include "Vec2.h"
+
+namespace gf {
+  class InputStream;
+  class OutputStream;
+  class ThreadPool;
+
+  class GF_CORE_API TextureData {
+  public:
+    TextureData() = default;
+    TextureData(const Image& image, BlockCompression compression = BlockCompression::None, ThreadPool* pool = nullptr);
+    TextureData(const std::filesystem::path& filename);
+    TextureData(InputStream& stream);
+
+    BlockCompression compression() const;
+    Vec2I size() const;
+
+    std::size_t level_count() const;
+    Vec2I level_size(std::size_t level) const;
+    Span<const uint8_t> level_data(std::size_t level) const;
+    Image level_image(std::size_t level, ThreadPool* pool = nullptr) const;
+
+    std::size_t raw_size() const;
+    const uint8_t* raw_data() const;
+
+    void save_to_file(const std::filesystem::path& filename) const;
+    void save_to_stream(OutputStream& stream) const;
+
+  private:
+    BlockCompression m_compression = BlockCompression::None;
+    Vec2I m_size = { 0, 0 };
+    std::vector<std::size_t> m_offsets; // level_count() + 1 offsets in the payload
+    std::vector<uint8_t> m_payload;
+  };
+
+} // namespace gf
+
+#endif // GF_TEXTURE_DATA_H
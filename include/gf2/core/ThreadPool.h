@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_THREAD_POOL_H
+#define GF_THREAD_POOL_H
+
+#include <cstddef>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "CoreApi.h"
+
+namespace gf {
+
+  class GF_CORE_API ThreadPool {
+  public:
+    explicit ThreadPool(std::size_t thread_count = default_thread_count());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) noexcept = delete;
+    ~ThreadPool();
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+    std::size_t thread_count() const;
+
+    template<typename Func>
+    std::future<std::invoke_result_t<Func>> submit(Func&& function)
+    {
+      using Result = std::invoke_result_t<Func>;
+      auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(function));
+      std::future<Result> result = task->get_future();
+      enqueue([task]() { (*task)(); });
+      return result;
+    }
+
+    void parallel_for(int begin, int end, const std::function<void(int, int)>& function);
+
+    static std::size_t default_thread_count();
+
+  private:
+    void enqueue(std::function<void()> task);
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<std::thread> m_threads;
+    bool m_stopped = false;
+  };
+
+  GF_CORE_API void parallel_for(ThreadPool* pool, int begin, int end, const std::function<void(int, int)>& function);
+
+} // namespace gf
+
+#endif // GF_THREAD_POOL_H
@@ -5,6 +5,7 @@
 
 #include <cstdint>
 
+#include <array>
 #include <filesystem>
 #include <optional>
 #include <string>
@@ -14,18 +15,24 @@
 #include "Array2D.h"
 #include "ColorCompositing.h"
 #include "CoreApi.h"
+#include "Flags.h"
 #include "GridTypes.h"
 #include "Id.h"
 #include "Property.h"
 #include "PropertyMap.h"
+#include "ResourceContext.h"
 #include "Rect.h"
 #include "TypeTraits.h"
 #include "Vec2.h"
 
 namespace gf {
+  class ThreadPool;
 
   constexpr uint32_t NoIndex = 0xFFFFFFFF;
 
+  // archives with a version before this one do not have the tileset offsets, the chunks and the blend modes
+  constexpr uint16_t TiledMapChunksVersion = 1;
+
   enum class MapLayerType : uint8_t {
     Tile,
     Object,
@@ -49,6 +56,7 @@ namespace gf {
   struct GF_CORE_API MapTile {
     uint32_t gid = 0;
     Flags<CellFlip> flip = None;
+    std::array<uint8_t, 3> reserved = {}; // no padding, see TiledMapView
   };
 
   template<typename Archive>
@@ -57,16 +65,51 @@ namespace gf {
     return ar | data.gid | data.flip;
   }
 
+  struct GF_CORE_API MapTileChunk {
+    Vec2I position = { 0, 0 }; // in tiles
+    Vec2I size = { 0, 0 };
+    Array2D<MapTile> tiles;     // empty until the chunk is decoded
+    std::vector<uint8_t> data; // encoded gids, empty once the chunk is decoded
+    bool compressed = false;
+
+    bool decoded() const
+    {
+      return data.empty();
+    }
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, MaybeConst<MapTileChunk, Archive>& data)
+  {
+    return ar | data.position | data.size | data.tiles | data.data | data.compressed;
+  }
+
   struct GF_CORE_API MapTileLayer {
     MapLayer layer;
-    Array2D<MapTile> tiles;
+    Array2D<MapTile> tiles;           // for finite maps
+    std::vector<MapTileChunk> chunks; // for infinite maps, sorted by position
     BlendMode mode = BlendMode::Normal;
+
+    bool chunked() const
+    {
+      return !chunks.empty();
+    }
+
+    MapTile tile(Vec2I position) const;
+    const MapTileChunk* chunk_at(Vec2I position) const;
+    void decode_chunks(RectI area, ThreadPool* pool = nullptr);
   };
 
   template<typename Archive>
   Archive& operator|(Archive& ar, MaybeConst<MapTileLayer, Archive>& data)
   {
-    return ar | data.layer | data.tiles;
+    ar | data.layer | data.tiles;
+
+    if (ar.version() >= TiledMapChunksVersion) {
+      ar | data.chunks | data.mode;
+    }
+
+    return ar;
   }
 
   enum class MapObjectType : uint8_t {
@@ -109,8 +152,17 @@ namespace gf {
   }
 
   struct GF_CORE_API MapLayerStructure {
-    MapLayerType type;
-    uint32_t layer_index;
+    constexpr MapLayerStructure() = default;
+
+    constexpr MapLayerStructure(MapLayerType type, uint32_t layer_index)
+    : type(type)
+    , layer_index(layer_index)
+    {
+    }
+
+    MapLayerType type = MapLayerType::Tile;
+    std::array<uint8_t, 3> reserved = {}; // no padding, see TiledMapView
+    uint32_t layer_index = 0;
   };
 
   template<typename Archive>
@@ -163,9 +215,24 @@ namespace gf {
   template<typename Archive>
   Archive& operator|(Archive& ar, MaybeConst<MapTileset, Archive>& data)
   {
-    return ar | data.type | data.properties_index | data.texture_index | data.first_gid | data.tile_size | data.spacing | data.margin | data.tiles;
+    ar | data.type | data.properties_index | data.texture_index | data.first_gid | data.tile_size;
+
+    if (ar.version() >= TiledMapChunksVersion) {
+      ar | data.offset;
+    }
+
+    return ar | data.spacing | data.margin | data.tiles;
   }
 
+  enum class TiledMapOption : uint8_t {
+    Cache = 0x01,
+    LazyChunks = 0x02,
+  };
+
+  template<>
+  struct EnableBitmaskOperators<TiledMapOption> : std::true_type {
+  };
+
   struct GF_CORE_API TiledMap {
     std::string type;
     uint32_t properties_index = NoIndex;
@@ -189,10 +256,26 @@ namespace gf {
     std::vector<std::filesystem::path> textures;
 
     TiledMap() = default;
-    TiledMap(const std::filesystem::path& filename);
+    TiledMap(const std::filesystem::path& filename, Flags<TiledMapOption> options = None, ThreadPool* pool = nullptr);
 
     const MapTileset* tileset_from_gid(uint32_t gid) const noexcept;
     const std::vector<MapLayerStructure>& compute_structure(std::string_view path) const;
+    void decode_chunks(RectI area, ThreadPool* pool = nullptr);
+    std::size_t memory_size() const;
+
+    static std::filesystem::path cache_file(const std::filesystem::path& filename);
+  };
+
+  template<>
+  struct EnableParallelLoad<TiledMap> : std::true_type {
+  };
+
+  template<>
+  struct ResourceSize<TiledMap> {
+    static std::size_t estimate(const TiledMap& resource)
+    {
+      return resource.memory_size();
+    }
   };
 
   template<typename Archive>
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_TILED_MAP_VIEW_H
+#define GF_TILED_MAP_VIEW_H
+
+#include <cstdint>
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+#include "Blob.h"
+#include "ColorCompositing.h"
+#include "CoreApi.h"
+#include "GridTypes.h"
+#include "Id.h"
+#include "PropertyMap.h"
+#include "Span.h"
+#include "Streams.h"
+#include "TiledMap.h"
+#include "Vec2.h"
+
+namespace gf {
+  class OutputStream;
+
+  /*
+   * Flat versions of the TiledMap structures, stored in a blob
+   *
+   * The structures are copied as a whole in the blob, so they have explicit
+   * reserved fields instead of padding, that would write indeterminate bytes.
+   */
+
+  struct GF_CORE_API MapLayerBlob {
+    uint32_t properties_index = NoIndex;
+    bool visible = true;
+    std::array<uint8_t, 3> reserved = {};
+    BlobString name;
+    BlobString type;
+    Vec2I offset = { 0, 0 };
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapLayerBlob>);
+
+  struct GF_CORE_API MapTileLayerBlob {
+    MapLayerBlob layer;
+    Vec2I size = { 0, 0 };
+    BlobArray<MapTile> tiles;
+    BlendMode mode = BlendMode::Normal;
+    std::array<uint8_t, 3> reserved = {};
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapTile>);
+  static_assert(std::has_unique_object_representations_v<MapTileLayerBlob>);
+
+  enum class MapObjectFeature : uint8_t {
+    None,
+    Point,
+    Tile,
+    Points,
+  };
+
+  struct GF_CORE_API MapObjectBlob {
+    uint32_t properties_index = NoIndex;
+    MapObjectType object_type = MapObjectType::Point;
+    bool visible = true;
+    MapObjectFeature feature = MapObjectFeature::None;
+    uint8_t reserved0 = 0;
+    Id id = InvalidId;
+    BlobString name;
+    BlobString type;
+    Vec2F location = { 0.0f, 0.0f };
+    float rotation = 0.0f;
+    Vec2F point = { 0.0f, 0.0f }; // MapObjectFeature::Point
+    MapTile tile;                 // MapObjectFeature::Tile
+    BlobArray<Vec2F> points;      // MapObjectFeature::Points
+    uint32_t reserved1 = 0;
+  };
+
+  // the floats do not have a unique representation, the size is checked instead
+  static_assert(sizeof(MapObjectBlob) == 72);
+
+  struct GF_CORE_API MapObjectLayerBlob {
+    MapLayerBlob layer;
+    BlobArray<MapObjectBlob> objects;
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapObjectLayerBlob>);
+
+  struct GF_CORE_API MapGroupLayerBlob {
+    MapLayerBlob layer;
+    BlobArray<MapLayerStructure> sub_layers;
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapLayerStructure>);
+  static_assert(std::has_unique_object_representations_v<MapGroupLayerBlob>);
+
+  struct GF_CORE_API MapTilesetTileBlob {
+    uint32_t properties_index = NoIndex;
+    uint32_t id = 0;
+    BlobString type;
+    uint32_t objects = NoIndex;
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapTilesetTileBlob>);
+
+  struct GF_CORE_API MapTilesetBlob {
+    BlobString type;
+    uint32_t properties_index = NoIndex;
+    uint32_t texture_index = NoIndex;
+    uint32_t first_gid = 0;
+    Vec2I tile_size = { 0, 0 };
+    Vec2I offset = { 0, 0 };
+    int32_t spacing = 0;
+    int32_t margin = 0;
+    BlobArray<MapTilesetTileBlob> tiles;
+  };
+
+  static_assert(std::has_unique_object_representations_v<MapTilesetBlob>);
+
+  struct GF_CORE_API TiledMapBlob {
+    BlobString type;
+    uint32_t properties_index = NoIndex;
+    GridOrientation orientation = GridOrientation::Unknown;
+    CellAxis cell_axis = CellAxis::X;
+    CellIndex cell_index = CellIndex::Odd;
+    uint8_t reserved = 0;
+    int32_t hex_side_length = 0;
+    Vec2I map_size = { 0, 0 };
+    Vec2I tile_size = { 0, 0 };
+    BlobArray<BlobArray<uint8_t>> properties; // serialized property maps, decoded on demand
+    BlobArray<MapTilesetBlob> tilesets;
+    BlobArray<MapTileLayerBlob> tile_layers;
+    BlobArray<MapObjectLayerBlob> object_layers;
+    BlobArray<MapGroupLayerBlob> group_layers;
+    BlobArray<MapLayerStructure> layers;
+    BlobArray<BlobString> textures;
+  };
+
+  static_assert(std::has_unique_object_representations_v<TiledMapBlob>);
+
+  class GF_CORE_API TiledMapView {
+  public:
+    TiledMapView(Span<const uint8_t> memory);
+    TiledMapView(const std::filesystem::path& filename);
+
+    const TiledMapBlob& map() const
+    {
+      return m_blob.root<TiledMapBlob>();
+    }
+
+    template<typename T>
+    Span<const T> operator[](BlobArray<T> array) const
+    {
+      return m_blob.array(array);
+    }
+
+    std::string_view operator[](BlobString string) const
+    {
+      return m_blob.string(string);
+    }
+
+    PropertyMap properties(uint32_t index) const;
+    MapTile tile(const MapTileLayerBlob& layer, Vec2I position) const;
+    const MapTilesetBlob* tileset_from_gid(uint32_t gid) const;
+
+    TiledMap to_map() const;
+
+    static void save(const TiledMap& map, OutputStream& stream);
+    static void save_to_file(const TiledMap& map, const std::filesystem::path& filename);
+
+  private:
+    std::optional<MappedFileInputStream> m_file;
+    BlobView m_blob;
+  };
+
+} // namespace gf
+
+#endif // GF_TILED_MAP_VIEW_H
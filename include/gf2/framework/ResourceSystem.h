@@ -24,7 +24,8 @@ namespace gf {
 
   class GF_FRAMEWORK_API ResourceSystem : public ResourceManager {
   public:
-    ResourceSystem(const std::filesystem::path& asset_directory);
+    // load_async() only loads in parallel if a pool is given
+    ResourceSystem(const std::filesystem::path& asset_directory, ThreadPool* pool = nullptr);
 
     void add_search_directory(std::filesystem::path directory)
     {
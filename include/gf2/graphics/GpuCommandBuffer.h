@@ -2,6 +2,7 @@
 #define GF_GPU_COMMAND_BUFFER_H
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 #include <SDL3/SDL_gpu.h>
@@ -56,6 +57,7 @@ namespace gf {
 
     void copy_buffer_to_buffer(GpuTransferBuffer* source, GpuBuffer* destination, std::size_t size);
     void copy_buffer_to_texture(GpuTransferBuffer* source, GpuTexture* destination, Vec2I size);
+    void copy_buffer_to_texture(GpuTransferBuffer* source, std::size_t offset, GpuTexture* destination, uint32_t level, Vec2I size);
 
   private:
     friend class RenderManager;
@@ -3,6 +3,8 @@
 #ifndef GF_GPU_TEXTURE_H
 #define GF_GPU_TEXTURE_H
 
+#include <cstddef>
+
 #include <filesystem>
 #include <string>
 #include <type_traits>
@@ -12,6 +14,7 @@
 #include <gf2/core/Bitmap.h>
 #include <gf2/core/Flags.h>
 #include <gf2/core/Image.h>
+#include <gf2/core/TextureData.h>
 
 #include "GpuRenderTarget.h"
 #include "GraphicsApi.h"
@@ -29,6 +32,9 @@ namespace gf {
     R8_UNorm = SDL_GPU_TEXTUREFORMAT_R8_UNORM,
     R32G32_Float = SDL_GPU_TEXTUREFORMAT_R32G32_FLOAT,
     R8G8B8A8_UNorm_Srgb = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM_SRGB,
+    BC1_RGBA_UNorm_Srgb = SDL_GPU_TEXTUREFORMAT_BC1_RGBA_UNORM_SRGB,
+    BC3_RGBA_UNorm_Srgb = SDL_GPU_TEXTUREFORMAT_BC3_RGBA_UNORM_SRGB,
+    BC7_RGBA_UNorm_Srgb = SDL_GPU_TEXTUREFORMAT_BC7_RGBA_UNORM_SRGB,
   };
 
   // NOLINTNEXTLINE(performance-enum-size)
@@ -54,8 +60,10 @@ namespace gf {
     GpuTexture(const std::filesystem::path& filename, RenderManager* render_manager);
     GpuTexture(const Image& image, RenderManager* render_manager);
     GpuTexture(const Bitmap& bitmap, RenderManager* render_manager);
+    GpuTexture(const TextureData& data, RenderManager* render_manager);
     GpuTexture(Vec2I size, RenderManager* render_manager);
     GpuTexture(Vec2I size, Flags<GpuTextureUsage> usage, GpuTextureFormat format, RenderManager* render_manager);
+    GpuTexture(Vec2I size, Flags<GpuTextureUsage> usage, GpuTextureFormat format, std::size_t level_count, RenderManager* render_manager);
 
     void set_debug_name(const std::string& name);
 
@@ -68,6 +76,13 @@ namespace gf {
       return m_image_size;
     }
 
+    std::size_t level_count() const
+    {
+      return m_level_count;
+    }
+
+    std::size_t memory_size() const;
+
     GpuRenderTarget as_render_target();
 
   private:
@@ -78,10 +93,19 @@ namespace gf {
     details::GraphicsHandle<SDL_GPUSampler, SDL_ReleaseGPUSampler> m_sampler_handle;
 
     Vec2I m_image_size = { 0, 0 };
+    std::size_t m_level_count = 0;
     Flags<GpuTextureUsage> m_usage = None;
     GpuTextureFormat m_format = GpuTextureFormat::Undefined;
   };
 
+  template<>
+  struct ResourceSize<GpuTexture> {
+    static std::size_t estimate(const GpuTexture& resource)
+    {
+      return sizeof(GpuTexture) + resource.memory_size();
+    }
+  };
+
 }
 
 #endif // GF_GPU_TEXTURE_H
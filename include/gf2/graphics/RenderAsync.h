@@ -3,10 +3,19 @@
 #ifndef GF_RENDER_ASYNC_H
 #define GF_RENDER_ASYNC_H
 
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <gf2/core/Clock.h>
+#include <gf2/core/ThreadPool.h>
 
 #include "GraphicsApi.h"
 
@@ -14,17 +23,68 @@ namespace gf {
 
   class RenderManager;
 
+  enum class RenderAsyncStatus : uint8_t {
+    Queued,
+    Running,
+    Finished,
+    Cancelled,
+    Failed,
+  };
+
+  // The function of a job runs on a thread of the pool where RenderManager::current_copy_pass() is
+  // valid. Any other thread has no copy pass and current_copy_pass() asserts (undefined behavior in
+  // release), including the tasks of another ThreadPool started by the job: they must not upload.
+  class GF_GRAPHICS_API RenderAsyncJob {
+  public:
+    // called by the job
+    void set_progress(float progress);
+    bool cancelled() const;
+
+    // called by the owner of the job
+    float progress() const;
+    RenderAsyncStatus status() const;
+    bool done() const;
+    void cancel();
+
+  private:
+    friend class RenderAsync;
+
+    std::function<void(RenderAsyncJob&)> m_function;
+    std::atomic<float> m_progress = 0.0f;
+    std::atomic<bool> m_cancelled = false;
+    std::atomic<RenderAsyncStatus> m_status = RenderAsyncStatus::Queued;
+    std::exception_ptr m_exception; // set before the status becomes Failed
+    std::future<void> m_result;
+  };
+
   class GF_GRAPHICS_API RenderAsync {
   public:
-    RenderAsync(RenderManager* render_manager);
+    RenderAsync(RenderManager* render_manager, std::size_t thread_count = 2);
+    RenderAsync(const RenderAsync&) = delete;
+    RenderAsync(RenderAsync&&) noexcept = delete;
+    ~RenderAsync();
+
+    RenderAsync& operator=(const RenderAsync&) = delete;
+    RenderAsync& operator=(RenderAsync&&) noexcept = delete;
 
+    std::shared_ptr<RenderAsyncJob> submit(std::function<void(RenderAsyncJob&)> function);
     void run_async(std::function<void()> function);
+
+    void cancel_all();
+
+    std::size_t pending_count() const;
+    float progress() const;
     bool finished();
 
   private:
+    void run_job(RenderAsyncJob& job);
+    std::exception_ptr complete_jobs(const std::vector<std::shared_ptr<RenderAsyncJob>>& jobs);
+
     RenderManager* m_render_manager;
     Clock m_clock;
-    std::future<void> m_result;
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<RenderAsyncJob>> m_jobs; // since the last completion
+    ThreadPool m_pool;
   };
 
 }
@@ -4,6 +4,8 @@
 #define GF_RENDER_MANAGER_H
 
 #include <array>
+#include <map>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -25,11 +27,11 @@ namespace gf {
   public:
     RenderManager(Window* window);
     RenderManager(const RenderManager&) = delete;
-    RenderManager(RenderManager&&) = default;
+    RenderManager(RenderManager&&) = delete;
     ~RenderManager();
 
     RenderManager& operator=(const RenderManager&) = delete;
-    RenderManager& operator=(RenderManager&&) = default;
+    RenderManager& operator=(RenderManager&&) = delete;
 
     Vec2I surface_size() const;
     GpuTextureFormat surface_format();
@@ -95,11 +97,16 @@ namespace gf {
 
     std::array<std::vector<GpuTransferBuffer>, FramesInFlight> m_transfer_buffers;
 
-    // asynchronous load objects
+    // asynchronous load objects, each loading thread records its own copy pass
 
-    bool m_async_loading = false;
-    MemOps m_async_memops = {};
-    std::vector<GpuTransferBuffer> m_async_staging_buffers;
+    struct AsyncMemOps {
+      MemOps memops;
+      std::vector<GpuTransferBuffer> staging_buffers;
+    };
+
+    std::mutex m_async_mutex;
+    std::size_t m_async_loads = 0; // prepared and not finished
+    std::map<std::thread::id, AsyncMemOps> m_async_memops;
   };
 
 }
@@ -3,9 +3,14 @@
 #ifndef GF_SCENE_MANAGER_H
 #define GF_SCENE_MANAGER_H
 
+#include <cstdint>
+
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <gf2/core/ResourceBundle.h>
 #include <gf2/core/Span.h>
 #include <gf2/core/Vec2.h>
 
@@ -15,6 +20,7 @@
 #include "GpuTexture.h"
 #include "GraphicsApi.h"
 #include "GraphicsInitializer.h"
+#include "RenderAsync.h"
 #include "RenderManager.h"
 #include "RenderObject.h"
 #include "Window.h"
@@ -83,6 +89,12 @@ namespace gf {
     BasicScene* m_scene = nullptr;
   };
 
+  enum class SceneTransition : uint8_t {
+    Push,
+    Replace,
+    ReplaceAll,
+  };
+
   class GF_GRAPHICS_API SceneManager : public BasicSceneManager {
   public:
     SceneManager(const std::string& title, Vec2I size, Flags<WindowHints> hints = All);
@@ -124,10 +136,33 @@ namespace gf {
       push_scenes(scenes);
     }
 
+    // the caller owns the preloaded scene, a scene that is not swapped in is given back to on_discard
+    std::shared_ptr<RenderAsyncJob> preload_scene(std::function<BasicScene*(RenderAsyncJob&)> loader, SceneTransition transition = SceneTransition::Replace, std::function<void()> on_swap = {}, std::function<void(BasicScene*)> on_discard = {});
+    std::shared_ptr<RenderAsyncJob> preload_scene(ResourceBundle bundle, ResourceManager* resource_manager, std::function<BasicScene*()> factory, SceneTransition transition = SceneTransition::Replace, std::function<void()> on_swap = {}, std::function<void(BasicScene*)> on_discard = {});
+
+    bool preloading() const;
+    float preload_progress() const;
+    void cancel_preloads();
+
   private:
+    struct ScenePreload {
+      std::shared_ptr<RenderAsyncJob> job;
+      SceneTransition transition = SceneTransition::Replace;
+      std::function<void()> on_swap;
+      std::function<void(BasicScene*)> on_discard;
+      std::function<void()> release; // unloads the resources of a scene that is not swapped in
+      BasicScene* scene = nullptr; // set by the job
+    };
+
+    std::shared_ptr<RenderAsyncJob> submit_preload(std::shared_ptr<ScenePreload> preload, std::function<BasicScene*(RenderAsyncJob&)> loader);
+    void swap_preloaded_scenes();
+    static void discard_preloaded_scene(ScenePreload& preload);
+
     bool m_scenes_changed = false;
     std::vector<BasicScene*> m_curr_scenes;
     std::vector<BasicScene*> m_prev_scenes;
+    std::vector<std::shared_ptr<ScenePreload>> m_preloads;
+    RenderAsync m_preload_async;
   };
 
 }
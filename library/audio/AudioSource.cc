@@ -275,4 +275,26 @@ namespace gf {
     return seconds(length);
   }
 
+  std::size_t AudioSource::memory_size() const
+  {
+    if ((m_flags & MA_SOUND_FLAG_DECODE) == 0) {
+      return 0; // streamed
+    }
+
+    ma_format format = ma_format_unknown;
+    ma_uint32 channels = 0;
+
+    if (ma_sound_get_data_format(m_source.get(), &format, &channels, nullptr, nullptr, 0) != MA_SUCCESS) {
+      return 0;
+    }
+
+    ma_uint64 frames = 0;
+
+    if (ma_sound_get_length_in_pcm_frames(m_source.get(), &frames) != MA_SUCCESS) {
+      return 0;
+    }
+
+    return static_cast<std::size_t>(frames) * channels * ma_get_bytes_per_sample(format);
+  }
+
 }
@@ -0,0 +1,418 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/AssetCache.h>
+
+#include <cassert>
+#include <cstdio>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+namespace gf {
+
+  namespace {
+
+    /*
+     * Each entry of the cache is a gf archive in the directory of the cache,
+     * named after the key, with the following content:
+     *
+     * - a tag: 'GFAC'
+     * - the key
+     * - the SecureHash of the value
+     * - the size of the value
+     * - the value, compressed with zlib
+     *
+     * The last write time of an entry is the time of its last access, so that
+     * the least recently used entries are known across runs.
+     */
+
+    constexpr uint16_t AssetCacheVersion = 1;
+    constexpr uint32_t AssetCacheTag = 0x47464143; // 'GFAC'
+    constexpr std::string_view AssetCacheExtension = ".gfcache";
+    constexpr std::string_view AssetCacheTemporaryExtension = ".tmp";
+
+    std::string to_hex(const SecureHash::Hash& key)
+    {
+      std::string hex;
+
+      for (const uint8_t byte : key) {
+        fmt::format_to(std::back_inserter(hex), "{:02x}", byte);
+      }
+
+      return hex;
+    }
+
+    std::optional<SecureHash::Hash> from_hex(std::string_view hex)
+    {
+      if (hex.size() != 2 * SecureHash::HashSize) {
+        return std::nullopt;
+      }
+
+      auto convert_hex_char = [](char c) -> int {
+        if ('0' <= c && c <= '9') {
+          return c - '0';
+        }
+
+        if ('a' <= c && c <= 'f') {
+          return c - 'a' + 10;
+        }
+
+        return -1;
+      };
+
+      SecureHash::Hash key = {};
+
+      for (std::size_t i = 0; i < SecureHash::HashSize; ++i) {
+        const int high = convert_hex_char(hex[2 * i]);
+        const int low = convert_hex_char(hex[2 * i + 1]);
+
+        if (high < 0 || low < 0) {
+          return std::nullopt;
+        }
+
+        key[i] = static_cast<uint8_t>(high * 16 + low);
+      }
+
+      return key;
+    }
+
+    SecureHash::Hash compute_value_hash(Span<const uint8_t> value)
+    {
+      SecureHash hash;
+      hash.input(value);
+      return hash.result();
+    }
+
+    struct FileCloseDeleter {
+      void operator()(std::FILE* file) const noexcept
+      {
+        std::fclose(file);
+      }
+    };
+
+  } // namespace
+
+  /*
+   * AssetCacheKey
+   */
+
+  AssetCacheKey::AssetCacheKey(std::string_view processor, uint16_t version)
+  {
+    add_bytes(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(processor.data()), processor.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    add_bytes(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(&version), sizeof(version))); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  void AssetCacheKey::add_bytes(Span<const uint8_t> bytes)
+  {
+    // the size is part of the key, so that the inputs can not be confused
+    const uint64_t size = bytes.size();
+    m_hash.input(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(&size), sizeof(size))); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    m_hash.input(bytes);
+  }
+
+  bool AssetCacheKey::add_file(const std::filesystem::path& filename)
+  {
+    if (!std::filesystem::is_regular_file(filename)) {
+      return false;
+    }
+
+    MappedFileInputStream file(filename);
+    add_bytes(file.memory());
+    return true;
+  }
+
+  SecureHash::Hash AssetCacheKey::result()
+  {
+    return m_hash.result();
+  }
+
+  /*
+   * AssetCache
+   */
+
+  AssetCache::AssetCache(std::filesystem::path directory, std::size_t size_limit)
+  : m_directory(std::move(directory))
+  , m_size_limit(size_limit)
+  {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+
+    if (error) {
+      Log::warning("Could not create the asset cache directory '{}': {}", m_directory.string(), error.message());
+      return;
+    }
+
+    std::vector<std::tuple<std::filesystem::file_time_type, SecureHash::Hash, std::size_t>> files;
+
+    for (std::filesystem::directory_iterator iterator(m_directory, error); !error && iterator != std::filesystem::directory_iterator(); iterator.increment(error)) {
+      const std::filesystem::path& path = iterator->path();
+
+      if (!iterator->is_regular_file(error)) {
+        continue;
+      }
+
+      // the temporary files of an interrupted store
+      if (path.extension() == AssetCacheTemporaryExtension) {
+        std::filesystem::remove(path, error);
+        continue;
+      }
+
+      if (path.extension() != AssetCacheExtension) {
+        continue;
+      }
+
+      const std::optional<SecureHash::Hash> key = from_hex(path.stem().string());
+      const std::uintmax_t size = iterator->file_size(error);
+      const std::filesystem::file_time_type time = iterator->last_write_time(error);
+
+      if (key && !error) {
+        files.emplace_back(time, *key, static_cast<std::size_t>(size));
+      }
+    }
+
+    if (error) {
+      Log::warning("Could not read the asset cache directory '{}': {}", m_directory.string(), error.message());
+    }
+
+    std::ranges::sort(files);
+
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    for (const auto& [time, key, size] : files) {
+      const uint64_t access = m_access++;
+      m_entries.emplace(key, Entry{ size, access });
+      m_lru.emplace(access, key);
+      m_size += size;
+    }
+
+    evict();
+    Log::info("Opened the asset cache '{}': {} entries, {} bytes", m_directory.string(), m_entries.size(), m_size);
+  }
+
+  void AssetCache::set_size_limit(std::size_t size_limit)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    m_size_limit = size_limit;
+    evict();
+  }
+
+  std::size_t AssetCache::size_limit() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_size_limit;
+  }
+
+  std::size_t AssetCache::size() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_size;
+  }
+
+  std::size_t AssetCache::entry_count() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+  bool AssetCache::contains(const SecureHash::Hash& key) const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_entries.contains(key);
+  }
+
+  std::optional<std::vector<uint8_t>> AssetCache::load_raw(const SecureHash::Hash& key)
+  {
+    if (!contains(key)) {
+      return std::nullopt;
+    }
+
+    const std::filesystem::path filename = entry_file(key);
+    std::error_code error;
+
+    // an entry may have been removed by another process, FileInputStream would report an error
+    if (!std::filesystem::is_regular_file(filename, error)) {
+      Log::warning("Missing entry in the asset cache: {}", to_hex(key));
+      remove(key);
+      return std::nullopt;
+    }
+
+    std::vector<uint8_t> value;
+
+    try {
+      FileInputStream file(filename);
+      BufferedInputStream stream(&file);
+      Deserializer ar(&stream);
+
+      uint32_t tag = 0;
+      SecureHash::Hash stored_key = {};
+      SecureHash::Hash hash = {};
+      uint64_t size = 0;
+      std::vector<uint8_t> payload;
+      ar | tag | stored_key | hash | size | payload;
+
+      bool valid = ar.version() == AssetCacheVersion && tag == AssetCacheTag && stored_key == key;
+
+      if (valid && size > 0) {
+        value.resize(static_cast<std::size_t>(size));
+        uLongf uncompressed_size = static_cast<uLongf>(value.size());
+        valid = uncompress(value.data(), &uncompressed_size, payload.data(), static_cast<uLong>(payload.size())) == Z_OK && uncompressed_size == value.size();
+      }
+
+      valid = valid && compute_value_hash(value) == hash;
+
+      if (!valid) {
+        Log::warning("Invalid entry in the asset cache: {}", to_hex(key));
+        remove(key);
+        return std::nullopt;
+      }
+    } catch (const std::exception& ex) {
+      Log::warning("Could not read an entry of the asset cache: {}", ex.what());
+      remove(key);
+      return std::nullopt;
+    }
+
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (auto iterator = m_entries.find(key); iterator != m_entries.end()) {
+      touch(key, iterator->second);
+    }
+
+    return value;
+  }
+
+  void AssetCache::store_raw(const SecureHash::Hash& key, Span<const uint8_t> value)
+  {
+    const std::filesystem::path file = entry_file(key);
+    std::filesystem::path temporary = file;
+
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      temporary += fmt::format(".{}{}", m_temporary++, AssetCacheTemporaryExtension);
+    }
+
+    // the entry is written in a temporary file and then renamed, so that an entry is never partially written
+    std::error_code error;
+
+    std::vector<uint8_t> payload(compressBound(static_cast<uLong>(value.size())));
+    uLongf payload_size = static_cast<uLongf>(payload.size());
+
+    if (compress2(payload.data(), &payload_size, value.data(), static_cast<uLong>(value.size()), Z_DEFAULT_COMPRESSION) != Z_OK) {
+      Log::warning("Could not compress an entry of the asset cache.");
+      return;
+    }
+
+    payload.resize(payload_size);
+
+    std::vector<uint8_t> bytes;
+
+    {
+      BufferOutputStream stream(&bytes);
+      Serializer ar(&stream, AssetCacheVersion);
+      ar | AssetCacheTag | key | compute_value_hash(value) | static_cast<uint64_t>(value.size()) | payload;
+    }
+
+    // the file is opened directly, FileOutputStream would report an error for an unwritable cache
+    {
+      const std::unique_ptr<std::FILE, FileCloseDeleter> output(std::fopen(temporary.string().c_str(), "wb"));
+
+      if (!output) {
+        Log::warning("Could not open an entry of the asset cache: '{}'", temporary.string());
+        return;
+      }
+
+      if (std::fwrite(bytes.data(), 1, bytes.size(), output.get()) != bytes.size() || std::fflush(output.get()) != 0) {
+        error = std::make_error_code(std::errc::io_error);
+      }
+    }
+
+    const std::size_t size = bytes.size();
+
+    if (!error) {
+      std::filesystem::rename(temporary, file, error);
+    }
+
+    if (error) {
+      Log::warning("Could not write an entry of the asset cache: {}", error.message());
+      std::filesystem::remove(temporary, error);
+      return;
+    }
+
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    auto [iterator, inserted] = m_entries.try_emplace(key);
+
+    if (!inserted) {
+      m_size -= iterator->second.size;
+      m_lru.erase(iterator->second.access);
+    }
+
+    iterator->second.size = size;
+    iterator->second.access = m_access++;
+    m_lru.emplace(iterator->second.access, key);
+    m_size += iterator->second.size;
+
+    evict();
+  }
+
+  void AssetCache::remove(const SecureHash::Hash& key)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (auto iterator = m_entries.find(key); iterator != m_entries.end()) {
+      erase(iterator);
+    }
+  }
+
+  void AssetCache::clear()
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    while (!m_entries.empty()) {
+      erase(m_entries.begin());
+    }
+  }
+
+  std::filesystem::path AssetCache::entry_file(const SecureHash::Hash& key) const
+  {
+    std::filesystem::path file = m_directory / to_hex(key);
+    file += AssetCacheExtension;
+    return file;
+  }
+
+  void AssetCache::touch(const SecureHash::Hash& key, Entry& entry)
+  {
+    m_lru.erase(entry.access);
+    entry.access = m_access++;
+    m_lru.emplace(entry.access, key);
+
+    std::error_code error;
+    std::filesystem::last_write_time(entry_file(key), std::filesystem::file_time_type::clock::now(), error);
+  }
+
+  void AssetCache::erase(std::map<SecureHash::Hash, Entry>::iterator iterator)
+  {
+    std::error_code error;
+    std::filesystem::remove(entry_file(iterator->first), error);
+
+    m_size -= iterator->second.size;
+    m_lru.erase(iterator->second.access);
+    m_entries.erase(iterator);
+  }
+
+  void AssetCache::evict()
+  {
+    while (m_size > m_size_limit && !m_lru.empty()) {
+      auto iterator = m_entries.find(m_lru.begin()->second);
+      assert(iterator != m_entries.end());
+      erase(iterator);
+    }
+  }
+
+} // namespace gf
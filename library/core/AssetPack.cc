@@ -0,0 +1,406 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/AssetPack.h>
+
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <numeric>
+#include <string>
+
+#include <zlib.h>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/ThreadPool.h>
+
+namespace gf {
+
+  /*
+   * The .gfpack format is a single file with the following layout:
+   *
+   * - a header (see PackHeader)
+   * - the string table: the paths of the entries, without separators
+   * - the table of contents: an array of AssetPackEntry, sorted by key then by path
+   * - the payloads, aligned so that they can be used directly from a mapping
+   *
+   * Everything is stored in the native layout, like the blobs. A payload is
+   * compressed with zlib only if it is worth it, so already compressed media
+   * are stored as is and can be used without any copy.
+   */
+
+  namespace {
+
+    constexpr uint32_t AssetPackTag = 0x4746504B; // 'GFPK'
+    constexpr uint16_t AssetPackVersion = 1;
+
+    constexpr uint64_t SmallPayloadAlignment = 16;
+    constexpr uint64_t LargePayloadAlignment = 4096;
+    constexpr uint64_t LargePayloadSize = 64 * 1024;
+    constexpr uint64_t MaxCompressionRatio = 1032; // the best ratio of deflate
+
+    struct PackHeader {
+      uint32_t tag = AssetPackTag;
+      uint16_t version = AssetPackVersion;
+      uint16_t reserved = 0;
+      uint64_t entry_count = 0;
+      uint64_t names_offset = 0;
+      uint64_t names_size = 0;
+      uint64_t toc_offset = 0;
+    };
+
+    static_assert(std::is_trivially_copyable_v<PackHeader>);
+
+    uint64_t align_offset(uint64_t offset, uint64_t alignment)
+    {
+      return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    uint64_t payload_alignment(uint64_t size)
+    {
+      return size >= LargePayloadSize ? LargePayloadAlignment : SmallPayloadAlignment;
+    }
+
+    std::string normalize_path(const std::filesystem::path& path)
+    {
+      return path.lexically_normal().generic_string();
+    }
+
+    bool entry_before(const AssetPackEntry& entry, Id key)
+    {
+      return entry.key < key;
+    }
+
+    SecureHash::Hash compute_hash(Span<const uint8_t> content)
+    {
+      SecureHash hash;
+      hash.input(content);
+      return hash.result();
+    }
+
+    bool decompress_payload(Span<const uint8_t> payload, std::vector<uint8_t>& content)
+    {
+      uLongf size = static_cast<uLongf>(content.size());
+      return uncompress(content.data(), &size, payload.data(), static_cast<uLong>(payload.size())) == Z_OK && size == content.size();
+    }
+
+    bool is_compressed_media(const std::filesystem::path& filename)
+    {
+      static constexpr std::array Extensions = { ".png", ".jpg", ".jpeg", ".gif", ".webp", ".ogg", ".mp3", ".flac", ".gz", ".zip" };
+      const std::string extension = filename.extension().string();
+      return std::any_of(Extensions.begin(), Extensions.end(), [&](const char* candidate) { return extension == candidate; });
+    }
+
+    void write_bytes(OutputStream& stream, Span<const uint8_t> bytes, const std::filesystem::path& filename)
+    {
+      if (!bytes.empty() && stream.write(bytes) != bytes.size()) {
+        Log::fatal("Could not write the asset pack: '{}'", filename.string());
+      }
+    }
+
+    void write_padding(OutputStream& stream, uint64_t offset, const std::filesystem::path& filename)
+    {
+      static constexpr std::array<uint8_t, LargePayloadAlignment> Zeros = {};
+      assert(offset >= stream.written_bytes());
+
+      while (stream.written_bytes() < offset) {
+        const std::size_t size = std::min<std::size_t>(offset - stream.written_bytes(), Zeros.size());
+        write_bytes(stream, Span<const uint8_t>(Zeros.data(), size), filename);
+      }
+    }
+
+  } // namespace
+
+  /*
+   * AssetPack
+   */
+
+  AssetPack::AssetPack(const std::filesystem::path& filename)
+  : m_file(filename)
+  {
+    const Span<const uint8_t> memory = m_file.memory();
+    PackHeader header;
+
+    if (memory.size() < sizeof(PackHeader)) {
+      Log::fatal("Could not read the asset pack: '{}'", filename.string());
+    }
+
+    std::memcpy(&header, memory.data(), sizeof(PackHeader));
+
+    if (header.tag != AssetPackTag) {
+      Log::fatal("The file is not an asset pack: '{}'", filename.string());
+    }
+
+    if (header.version > AssetPackVersion) {
+      Log::fatal("Unsupported asset pack version: {}.", header.version);
+    }
+
+    if (header.names_offset > memory.size() || header.names_size > memory.size() - header.names_offset || header.toc_offset > memory.size() || header.entry_count > (memory.size() - header.toc_offset) / sizeof(AssetPackEntry)) {
+      Log::fatal("Truncated asset pack: '{}'", filename.string());
+    }
+
+    m_names = std::string_view(reinterpret_cast<const char*>(memory.data() + header.names_offset), header.names_size); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    m_entries.resize(header.entry_count);
+    std::memcpy(m_entries.data(), memory.data() + header.toc_offset, m_entries.size() * sizeof(AssetPackEntry));
+
+    for (const AssetPackEntry& entry : m_entries) {
+      if (entry.offset > memory.size() || entry.size > memory.size() - entry.offset || entry.name_offset > m_names.size() || entry.name_size > m_names.size() - entry.name_offset) {
+        Log::fatal("Invalid entry in the asset pack: '{}'", filename.string());
+      }
+
+      // the decompressed content is allocated before the decompression
+      if (entry.flags.test(AssetPackFlag::Compressed) && entry.original_size / MaxCompressionRatio > entry.size) {
+        Log::fatal("Invalid entry in the asset pack: '{}'", filename.string());
+      }
+    }
+  }
+
+  std::vector<uint8_t> AssetPack::extract(const std::filesystem::path& path) const
+  {
+    const AssetPackEntry* entry = find(path);
+
+    if (entry == nullptr) {
+      return {};
+    }
+
+    const Span<const uint8_t> payload = entry_payload(*entry);
+    std::vector<uint8_t> content;
+
+    if (entry->flags.test(AssetPackFlag::Compressed)) {
+      content.resize(entry->original_size);
+
+      if (!decompress_payload(payload, content)) {
+        Log::fatal("Could not decompress the following entry of the asset pack: '{}'", entry_path(*entry));
+      }
+    } else {
+      content.assign(payload.begin(), payload.end());
+    }
+
+    if (entry->flags.test(AssetPackFlag::Hashed) && compute_hash(content) != entry->hash) {
+      Log::fatal("Corrupted entry in the asset pack: '{}'", entry_path(*entry));
+    }
+
+    return content;
+  }
+
+  Span<const uint8_t> AssetPack::extract_view(const std::filesystem::path& path) const
+  {
+    const AssetPackEntry* entry = find(path);
+
+    if (entry == nullptr || entry->flags.test(AssetPackFlag::Compressed)) {
+      return {};
+    }
+
+    return entry_payload(*entry);
+  }
+
+  bool AssetPack::verify(const std::filesystem::path& path) const
+  {
+    const AssetPackEntry* entry = find(path);
+
+    if (entry == nullptr) {
+      return false;
+    }
+
+    if (!entry->flags.test(AssetPackFlag::Hashed)) {
+      return true;
+    }
+
+    if (entry->flags.test(AssetPackFlag::Compressed)) {
+      std::vector<uint8_t> content(entry->original_size);
+      return decompress_payload(entry_payload(*entry), content) && compute_hash(content) == entry->hash;
+    }
+
+    return compute_hash(entry_payload(*entry)) == entry->hash;
+  }
+
+  std::vector<std::filesystem::path> AssetPack::entries() const
+  {
+    std::vector<std::filesystem::path> paths;
+    paths.reserve(m_entries.size());
+
+    for (const AssetPackEntry& entry : m_entries) {
+      paths.emplace_back(entry_path(entry));
+    }
+
+    return paths;
+  }
+
+  Span<const AssetPackEntry> AssetPack::raw_entries() const
+  {
+    return m_entries;
+  }
+
+  std::string_view AssetPack::entry_path(const AssetPackEntry& entry) const
+  {
+    return m_names.substr(entry.name_offset, entry.name_size);
+  }
+
+  Span<const uint8_t> AssetPack::entry_payload(const AssetPackEntry& entry) const
+  {
+    return m_file.memory().slice(entry.offset, entry.offset + entry.size);
+  }
+
+  const AssetPackEntry* AssetPack::find(const std::filesystem::path& path) const
+  {
+    const std::string normalized = normalize_path(path);
+    const Id key = hash_string(normalized);
+
+    for (auto iterator = std::lower_bound(m_entries.begin(), m_entries.end(), key, entry_before); iterator != m_entries.end() && iterator->key == key; ++iterator) {
+      if (entry_path(*iterator) == normalized) {
+        return &*iterator;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /*
+   * AssetPackWriter
+   */
+
+  void AssetPackWriter::add_entry(const std::filesystem::path& path, std::vector<uint8_t> content, Flags<AssetPackFlag> flags)
+  {
+    if (path.empty() || path.is_absolute()) {
+      Log::fatal("The path of an asset pack entry must be relative: '{}'", path.string());
+    }
+
+    m_entries.push_back({ normalize_path(path), std::move(content), flags });
+  }
+
+  void AssetPackWriter::add_file(const std::filesystem::path& path, const std::filesystem::path& filename, Flags<AssetPackFlag> flags)
+  {
+    if (!std::filesystem::is_regular_file(filename)) {
+      Log::fatal("Could not find the following file for the asset pack: '{}'", filename.string());
+    }
+
+    if (is_compressed_media(filename)) {
+      flags.reset(AssetPackFlag::Compressed);
+    }
+
+    const MappedFileInputStream file(filename);
+    const Span<const uint8_t> memory = file.memory();
+    add_entry(path, std::vector<uint8_t>(memory.begin(), memory.end()), flags);
+  }
+
+  void AssetPackWriter::add_directory(const std::filesystem::path& directory, Flags<AssetPackFlag> flags)
+  {
+    if (!std::filesystem::is_directory(directory)) {
+      Log::fatal("Could not find the following directory for the asset pack: '{}'", directory.string());
+    }
+
+    for (const std::filesystem::directory_entry& file : std::filesystem::recursive_directory_iterator(directory)) {
+      if (file.is_regular_file()) {
+        add_file(file.path().lexically_relative(directory), file.path(), flags);
+      }
+    }
+  }
+
+  void AssetPackWriter::save(const std::filesystem::path& filename, ThreadPool* pool)
+  {
+    std::vector<AssetPackEntry> toc(m_entries.size());
+    std::atomic<bool> failed = false;
+
+    // compress and hash the entries, the content is replaced by the payload
+
+    parallel_for(pool, 0, static_cast<int>(m_entries.size()), [&](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        Entry& entry = m_entries[i];
+        AssetPackEntry& info = toc[i];
+        info.key = hash_string(entry.path);
+        info.original_size = entry.content.size();
+
+        if (entry.flags.test(AssetPackFlag::Hashed)) {
+          info.hash = compute_hash(entry.content);
+          info.flags |= AssetPackFlag::Hashed;
+        }
+
+        if (entry.flags.test(AssetPackFlag::Compressed) && !entry.content.empty()) {
+          std::vector<uint8_t> payload(compressBound(static_cast<uLong>(entry.content.size())));
+          uLongf size = static_cast<uLongf>(payload.size());
+
+          if (compress2(payload.data(), &size, entry.content.data(), static_cast<uLong>(entry.content.size()), Z_BEST_COMPRESSION) != Z_OK) {
+            failed = true;
+            continue;
+          }
+
+          // keep the compressed payload only if it saves at least 1/16 of the size
+          if (size < entry.content.size() - (entry.content.size() / 16)) {
+            payload.resize(size);
+            entry.content = std::move(payload);
+            info.flags |= AssetPackFlag::Compressed;
+          }
+        }
+
+        info.size = entry.content.size();
+      }
+    });
+
+    if (failed) {
+      Log::fatal("Could not compress the entries of the asset pack: '{}'", filename.string());
+    }
+
+    // sort the table of contents
+
+    std::vector<std::size_t> order(m_entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+      return toc[lhs].key != toc[rhs].key ? toc[lhs].key < toc[rhs].key : m_entries[lhs].path < m_entries[rhs].path;
+    });
+
+    for (std::size_t i = 1; i < order.size(); ++i) {
+      if (m_entries[order[i - 1]].path == m_entries[order[i]].path) {
+        Log::fatal("Duplicate entry in the asset pack: '{}'", m_entries[order[i]].path);
+      }
+    }
+
+    // compute the layout
+
+    PackHeader header;
+    header.entry_count = m_entries.size();
+    header.names_offset = sizeof(PackHeader);
+
+    std::string names;
+    std::vector<AssetPackEntry> sorted_toc;
+    sorted_toc.reserve(order.size());
+
+    for (const std::size_t index : order) {
+      AssetPackEntry info = toc[index];
+      info.name_offset = names.size();
+      info.name_size = static_cast<uint32_t>(m_entries[index].path.size());
+      names.append(m_entries[index].path);
+      sorted_toc.push_back(info);
+    }
+
+    header.names_size = names.size();
+    header.toc_offset = align_offset(header.names_offset + header.names_size, alignof(AssetPackEntry));
+
+    uint64_t offset = header.toc_offset + (sorted_toc.size() * sizeof(AssetPackEntry));
+
+    for (AssetPackEntry& info : sorted_toc) {
+      offset = align_offset(offset, payload_alignment(info.size));
+      info.offset = offset;
+      offset += info.size;
+    }
+
+    // write the pack
+
+    // a stream that could not be opened does not write anything, so the header fails first
+    FileOutputStream stream(filename);
+    write_bytes(stream, Span<const uint8_t>(reinterpret_cast<const uint8_t*>(&header), sizeof(PackHeader)), filename); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    write_bytes(stream, Span<const uint8_t>(reinterpret_cast<const uint8_t*>(names.data()), names.size()), filename); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    write_padding(stream, header.toc_offset, filename);
+    write_bytes(stream, Span<const uint8_t>(reinterpret_cast<const uint8_t*>(sorted_toc.data()), sorted_toc.size() * sizeof(AssetPackEntry)), filename); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      write_padding(stream, sorted_toc[i].offset, filename);
+      write_bytes(stream, m_entries[order[i]].content, filename);
+    }
+
+    m_entries.clear();
+  }
+
+} // namespace gf
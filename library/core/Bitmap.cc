@@ -134,6 +134,17 @@ namespace gf {
     return bitmap;
   }
 
+  Bitmap Bitmap::resized(Vec2I size, ResamplingFilter filter, ThreadPool* pool) const
+  {
+    if (size.w <= 0 || size.h <= 0 || m_pixels.empty()) {
+      return {};
+    }
+
+    Bitmap bitmap(size);
+    resample_gray8(m_pixels, m_size, bitmap.m_pixels, size, filter, pool);
+    return bitmap;
+  }
+
   std::size_t Bitmap::raw_size() const
   {
     return static_cast<std::size_t>(m_size.w) * static_cast<std::size_t>(m_size.h);
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/Blob.h>
+
+#include <cstddef>
+
+#include <array>
+#include <limits>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/Stream.h>
+
+namespace gf {
+
+  /*
+   * A blob is a relocatable memory image: the header is followed by aligned
+   * arrays of trivially copyable types, that refer to each other with offsets
+   * from the beginning of the blob. The data is stored with the byte order of
+   * the platform so that it can be used in place.
+   */
+
+  namespace {
+
+    constexpr std::array<char, 4> BlobMagic = { 'g', 'f', 'b', 'l' };
+    constexpr uint16_t BlobByteOrder = 0x0102;
+
+    struct BlobHeader {
+      std::array<char, 4> magic;
+      uint32_t tag;
+      uint16_t version;
+      uint16_t byte_order;
+      uint32_t root;
+      uint64_t size;
+    };
+
+    static_assert(std::is_trivially_copyable_v<BlobHeader>);
+
+  } // namespace
+
+  /*
+   * BlobWriter
+   */
+
+  BlobWriter::BlobWriter(uint32_t tag, uint16_t version)
+  : m_bytes(sizeof(BlobHeader), 0)
+  {
+    BlobHeader header = {};
+    header.magic = BlobMagic;
+    header.tag = tag;
+    header.version = version;
+    header.byte_order = BlobByteOrder;
+    std::memcpy(m_bytes.data(), &header, sizeof(BlobHeader));
+  }
+
+  BlobString BlobWriter::add_string(std::string_view string)
+  {
+    return add_array(Span<const char>(string.data(), string.size()));
+  }
+
+  void BlobWriter::save_to_stream(OutputStream& stream) const
+  {
+    stream.write(m_bytes);
+  }
+
+  uint32_t BlobWriter::allocate(std::size_t size, std::size_t alignment)
+  {
+    assert(alignment > 0 && alignment <= alignof(std::max_align_t));
+    const std::size_t offset = (m_bytes.size() + alignment - 1) / alignment * alignment;
+
+    if (offset + size > std::numeric_limits<uint32_t>::max()) {
+      Log::fatal("The blob is too large.");
+    }
+
+    m_bytes.resize(offset + size, 0);
+    return static_cast<uint32_t>(offset);
+  }
+
+  void BlobWriter::finish_with_root(uint32_t offset)
+  {
+    BlobHeader header = {};
+    std::memcpy(&header, m_bytes.data(), sizeof(BlobHeader));
+    header.root = offset;
+    header.size = m_bytes.size();
+    std::memcpy(m_bytes.data(), &header, sizeof(BlobHeader));
+  }
+
+  /*
+   * BlobView
+   */
+
+  BlobView::BlobView(Span<const uint8_t> memory, uint32_t tag)
+  : m_memory(memory)
+  {
+    BlobHeader header = {};
+
+    if (memory.size() < sizeof(BlobHeader)) {
+      Log::fatal("The memory is not a blob.");
+    }
+
+    std::memcpy(&header, memory.data(), sizeof(BlobHeader));
+
+    if (header.magic != BlobMagic || header.tag != tag) {
+      Log::fatal("The memory is not a blob.");
+    }
+
+    if (header.byte_order != BlobByteOrder) {
+      Log::fatal("The blob has been created with a different byte order.");
+    }
+
+    if (header.size > memory.size() || header.root == 0) {
+      Log::fatal("The blob is truncated.");
+    }
+
+    if (reinterpret_cast<std::uintptr_t>(memory.data()) % alignof(std::max_align_t) != 0) { // NOLINT
+      Log::fatal("The blob is not correctly aligned in memory.");
+    }
+
+    m_memory = memory.first(static_cast<std::size_t>(header.size));
+    m_version = header.version;
+    m_root = header.root;
+  }
+
+  std::string_view BlobView::string(BlobString string) const
+  {
+    const Span<const char> characters = array(string);
+    return { characters.data(), characters.size() };
+  }
+
+  const void* BlobView::address(uint32_t offset, std::size_t size, std::size_t alignment) const
+  {
+    if (offset % alignment != 0 || offset > m_memory.size() || size > m_memory.size() - offset) {
+      Log::fatal("Invalid reference in the blob.");
+    }
+
+    return m_memory.data() + offset;
+  }
+
+} // namespace gf
@@ -0,0 +1,678 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/BlockCompression.h>
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include <gf2/core/ThreadPool.h>
+
+namespace gf {
+
+  /*
+   * The block formats are described in the Khronos Data Format Specification:
+   * https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html#S3TC
+   *
+   * The encoders are simple and fast: the endpoints are computed along the
+   * principal axis of each block. For BC7, only mode 6 (one subset, RGBA
+   * endpoints, 4-bit indices) is produced, and only mode 6 is decoded.
+   */
+
+  namespace {
+
+    constexpr int BlockWidth = 4;
+    constexpr int BlockPixels = BlockWidth * BlockWidth;
+
+    using Pixel = std::array<uint8_t, 4>;
+    using Block = std::array<Pixel, BlockPixels>;
+    using Vec4 = std::array<float, 4>;
+
+    std::size_t block_size(BlockCompression compression)
+    {
+      switch (compression) {
+        case BlockCompression::None:
+          return 4;
+        case BlockCompression::Bc1:
+          return 8;
+        case BlockCompression::Bc3:
+        case BlockCompression::Bc7:
+          return 16;
+      }
+
+      assert(false);
+      return 0;
+    }
+
+    int block_count(int size)
+    {
+      return (size + BlockWidth - 1) / BlockWidth;
+    }
+
+    // the pixels outside the image are clamped to the edge
+    Block fetch_block(const uint8_t* source, Vec2I size, int bx, int by)
+    {
+      Block block = {};
+
+      for (int j = 0; j < BlockWidth; ++j) {
+        const int y = std::min(by * BlockWidth + j, size.h - 1);
+
+        for (int i = 0; i < BlockWidth; ++i) {
+          const int x = std::min(bx * BlockWidth + i, size.w - 1);
+          const uint8_t* pixel = source + ((static_cast<std::ptrdiff_t>(y) * size.w + x) * 4);
+          std::copy_n(pixel, 4, block[(j * BlockWidth) + i].begin());
+        }
+      }
+
+      return block;
+    }
+
+    void store_block(const Block& block, Vec2I size, int bx, int by, uint8_t* target)
+    {
+      for (int j = 0; j < BlockWidth; ++j) {
+        const int y = by * BlockWidth + j;
+
+        if (y >= size.h) {
+          break;
+        }
+
+        for (int i = 0; i < BlockWidth; ++i) {
+          const int x = bx * BlockWidth + i;
+
+          if (x >= size.w) {
+            break;
+          }
+
+          uint8_t* pixel = target + ((static_cast<std::ptrdiff_t>(y) * size.w + x) * 4);
+          std::copy_n(block[(j * BlockWidth) + i].begin(), 4, pixel);
+        }
+      }
+    }
+
+    template<int Channels>
+    int distance(const Pixel& lhs, const Pixel& rhs)
+    {
+      int result = 0;
+
+      for (int c = 0; c < Channels; ++c) {
+        const int d = static_cast<int>(lhs[c]) - static_cast<int>(rhs[c]);
+        result += d * d;
+      }
+
+      return result;
+    }
+
+    template<int Channels, std::size_t Size>
+    uint8_t nearest_index(const Pixel& pixel, const std::array<Pixel, Size>& palette)
+    {
+      uint8_t best_index = 0;
+      int best_distance = distance<Channels>(pixel, palette[0]);
+
+      for (std::size_t i = 1; i < Size; ++i) {
+        const int d = distance<Channels>(pixel, palette[i]);
+
+        if (d < best_distance) {
+          best_distance = d;
+          best_index = static_cast<uint8_t>(i);
+        }
+      }
+
+      return best_index;
+    }
+
+    // endpoints of the segment that approximates the colors of the block
+
+    template<int Channels>
+    std::pair<Vec4, Vec4> compute_endpoints(const Block& block)
+    {
+      Vec4 mean = {};
+
+      for (const Pixel& pixel : block) {
+        for (int c = 0; c < Channels; ++c) {
+          mean[c] += static_cast<float>(pixel[c]);
+        }
+      }
+
+      for (int c = 0; c < Channels; ++c) {
+        mean[c] /= static_cast<float>(BlockPixels);
+      }
+
+      std::array<std::array<float, 4>, 4> covariance = {};
+
+      for (const Pixel& pixel : block) {
+        for (int c0 = 0; c0 < Channels; ++c0) {
+          for (int c1 = 0; c1 < Channels; ++c1) {
+            covariance[c0][c1] += (static_cast<float>(pixel[c0]) - mean[c0]) * (static_cast<float>(pixel[c1]) - mean[c1]);
+          }
+        }
+      }
+
+      // principal axis with a few power iterations
+
+      Vec4 axis = {};
+
+      for (int c = 0; c < Channels; ++c) {
+        axis[c] = 1.0f;
+      }
+
+      for (int iteration = 0; iteration < 8; ++iteration) {
+        Vec4 next = {};
+        float norm = 0.0f;
+
+        for (int c0 = 0; c0 < Channels; ++c0) {
+          for (int c1 = 0; c1 < Channels; ++c1) {
+            next[c0] += covariance[c0][c1] * axis[c1];
+          }
+
+          norm = std::max(norm, std::abs(next[c0]));
+        }
+
+        if (norm < 1e-6f) {
+          break;
+        }
+
+        for (int c = 0; c < Channels; ++c) {
+          axis[c] = next[c] / norm;
+        }
+      }
+
+      float length = 0.0f;
+
+      for (int c = 0; c < Channels; ++c) {
+        length += axis[c] * axis[c];
+      }
+
+      length = std::sqrt(length);
+
+      for (int c = 0; c < Channels; ++c) {
+        axis[c] /= length;
+      }
+
+      float min = 0.0f;
+      float max = 0.0f;
+
+      for (const Pixel& pixel : block) {
+        float t = 0.0f;
+
+        for (int c = 0; c < Channels; ++c) {
+          t += (static_cast<float>(pixel[c]) - mean[c]) * axis[c];
+        }
+
+        min = std::min(min, t);
+        max = std::max(max, t);
+      }
+
+      Vec4 low = {};
+      Vec4 high = {};
+
+      for (int c = 0; c < Channels; ++c) {
+        low[c] = std::clamp(mean[c] + (min * axis[c]), 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + (max * axis[c]), 0.0f, 255.0f);
+      }
+
+      return { low, high };
+    }
+
+    void write_u16(uint8_t* target, uint16_t value)
+    {
+      target[0] = static_cast<uint8_t>(value);
+      target[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    uint16_t read_u16(const uint8_t* source)
+    {
+      return static_cast<uint16_t>(source[0] | (source[1] << 8));
+    }
+
+    /*
+     * BC1
+     */
+
+    uint16_t encode_565(const Vec4& color)
+    {
+      const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+      const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+      const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+      return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    Pixel decode_565(uint16_t color)
+    {
+      const int r = (color >> 11) & 0x1F;
+      const int g = (color >> 5) & 0x3F;
+      const int b = color & 0x1F;
+      return { static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)), static_cast<uint8_t>((b << 3) | (b >> 2)), 255 };
+    }
+
+    Pixel interpolate_color(const Pixel& p0, const Pixel& p1, int w0, int w1, int total)
+    {
+      Pixel result = {};
+
+      for (int c = 0; c < 3; ++c) {
+        result[c] = static_cast<uint8_t>(((w0 * p0[c]) + (w1 * p1[c])) / total);
+      }
+
+      result[3] = 255;
+      return result;
+    }
+
+    std::array<Pixel, 4> compute_color_palette(uint16_t c0, uint16_t c1, bool four_colors)
+    {
+      std::array<Pixel, 4> palette = {};
+      palette[0] = decode_565(c0);
+      palette[1] = decode_565(c1);
+
+      if (four_colors) {
+        palette[2] = interpolate_color(palette[0], palette[1], 2, 1, 3);
+        palette[3] = interpolate_color(palette[0], palette[1], 1, 2, 3);
+      } else {
+        palette[2] = interpolate_color(palette[0], palette[1], 1, 1, 2);
+        palette[3] = { 0, 0, 0, 0 };
+      }
+
+      return palette;
+    }
+
+    // always produces a four color block, as required by BC3
+    void encode_color_block(const Block& block, uint8_t* target)
+    {
+      auto [low, high] = compute_endpoints<3>(block);
+      uint16_t c0 = encode_565(high);
+      uint16_t c1 = encode_565(low);
+
+      if (c0 < c1) {
+        std::swap(c0, c1);
+      }
+
+      uint32_t indices = 0;
+
+      if (c0 != c1) {
+        const std::array<Pixel, 4> palette = compute_color_palette(c0, c1, true);
+
+        for (int i = 0; i < BlockPixels; ++i) {
+          indices |= static_cast<uint32_t>(nearest_index<3>(block[i], palette)) << (2 * i);
+        }
+      }
+
+      write_u16(target, c0);
+      write_u16(target + 2, c1);
+      write_u16(target + 4, static_cast<uint16_t>(indices));
+      write_u16(target + 6, static_cast<uint16_t>(indices >> 16));
+    }
+
+    void decode_color_block(const uint8_t* source, Block& block, bool allow_three_colors)
+    {
+      const uint16_t c0 = read_u16(source);
+      const uint16_t c1 = read_u16(source + 2);
+      const uint32_t indices = read_u16(source + 4) | (static_cast<uint32_t>(read_u16(source + 6)) << 16);
+      const std::array<Pixel, 4> palette = compute_color_palette(c0, c1, !allow_three_colors || c0 > c1);
+
+      for (int i = 0; i < BlockPixels; ++i) {
+        block[i] = palette[(indices >> (2 * i)) & 0x3];
+      }
+    }
+
+    /*
+     * BC3
+     */
+
+    std::array<uint8_t, 8> compute_alpha_palette(uint8_t a0, uint8_t a1)
+    {
+      std::array<uint8_t, 8> palette = {};
+      palette[0] = a0;
+      palette[1] = a1;
+
+      if (a0 > a1) {
+        for (int i = 2; i < 8; ++i) {
+          palette[i] = static_cast<uint8_t>((((8 - i) * a0) + ((i - 1) * a1)) / 7);
+        }
+      } else {
+        for (int i = 2; i < 6; ++i) {
+          palette[i] = static_cast<uint8_t>((((6 - i) * a0) + ((i - 1) * a1)) / 5);
+        }
+
+        palette[6] = 0;
+        palette[7] = 255;
+      }
+
+      return palette;
+    }
+
+    void encode_alpha_block(const Block& block, uint8_t* target)
+    {
+      uint8_t a0 = 0;
+      uint8_t a1 = 255;
+
+      for (const Pixel& pixel : block) {
+        a0 = std::max(a0, pixel[3]);
+        a1 = std::min(a1, pixel[3]);
+      }
+
+      uint64_t indices = 0;
+
+      if (a0 != a1) {
+        const std::array<uint8_t, 8> palette = compute_alpha_palette(a0, a1);
+
+        for (int i = 0; i < BlockPixels; ++i) {
+          uint64_t best_index = 0;
+          int best_distance = 256;
+
+          for (std::size_t k = 0; k < palette.size(); ++k) {
+            const int d = std::abs(static_cast<int>(palette[k]) - static_cast<int>(block[i][3]));
+
+            if (d < best_distance) {
+              best_distance = d;
+              best_index = k;
+            }
+          }
+
+          indices |= best_index << (3 * i);
+        }
+      }
+
+      target[0] = a0;
+      target[1] = a1;
+
+      for (int i = 0; i < 6; ++i) {
+        target[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+      }
+    }
+
+    void decode_alpha_block(const uint8_t* source, Block& block)
+    {
+      const std::array<uint8_t, 8> palette = compute_alpha_palette(source[0], source[1]);
+      uint64_t indices = 0;
+
+      for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<uint64_t>(source[2 + i]) << (8 * i);
+      }
+
+      for (int i = 0; i < BlockPixels; ++i) {
+        block[i][3] = palette[(indices >> (3 * i)) & 0x7];
+      }
+    }
+
+    /*
+     * BC7 (mode 6)
+     */
+
+    constexpr std::array<int, 16> Bc7Weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    class BitWriter {
+    public:
+      BitWriter(uint8_t* target)
+      : m_target(target)
+      {
+        std::fill_n(m_target, 16, uint8_t(0));
+      }
+
+      void write(uint32_t value, int bits)
+      {
+        for (int i = 0; i < bits; ++i, ++m_offset) {
+          if ((value >> i) & 1) {
+            m_target[m_offset / 8] |= static_cast<uint8_t>(1 << (m_offset % 8));
+          }
+        }
+      }
+
+    private:
+      uint8_t* m_target = nullptr;
+      int m_offset = 0;
+    };
+
+    class BitReader {
+    public:
+      BitReader(const uint8_t* source)
+      : m_source(source)
+      {
+      }
+
+      uint32_t read(int bits)
+      {
+        uint32_t value = 0;
+
+        for (int i = 0; i < bits; ++i, ++m_offset) {
+          value |= static_cast<uint32_t>((m_source[m_offset / 8] >> (m_offset % 8)) & 1) << i;
+        }
+
+        return value;
+      }
+
+    private:
+      const uint8_t* m_source = nullptr;
+      int m_offset = 0;
+    };
+
+    struct Bc7Endpoint {
+      std::array<uint8_t, 4> color = {}; // 7 bits
+      uint8_t pbit = 0;
+
+      Pixel expand() const
+      {
+        Pixel pixel = {};
+
+        for (int c = 0; c < 4; ++c) {
+          pixel[c] = static_cast<uint8_t>((color[c] << 1) | pbit);
+        }
+
+        return pixel;
+      }
+    };
+
+    Bc7Endpoint quantize_bc7_endpoint(const Vec4& color)
+    {
+      Bc7Endpoint best_endpoint;
+      float best_error = INFINITY;
+
+      for (uint8_t pbit = 0; pbit < 2; ++pbit) {
+        Bc7Endpoint endpoint;
+        endpoint.pbit = pbit;
+        float error = 0.0f;
+
+        for (int c = 0; c < 4; ++c) {
+          const long value = std::lround((color[c] - static_cast<float>(pbit)) / 2.0f);
+          endpoint.color[c] = static_cast<uint8_t>(std::clamp(value, 0L, 127L));
+          const float d = static_cast<float>((endpoint.color[c] << 1) | pbit) - color[c];
+          error += d * d;
+        }
+
+        if (error < best_error) {
+          best_error = error;
+          best_endpoint = endpoint;
+        }
+      }
+
+      return best_endpoint;
+    }
+
+    std::array<Pixel, 16> compute_bc7_palette(const Pixel& e0, const Pixel& e1)
+    {
+      std::array<Pixel, 16> palette = {};
+
+      for (std::size_t i = 0; i < palette.size(); ++i) {
+        for (int c = 0; c < 4; ++c) {
+          palette[i][c] = static_cast<uint8_t>((((64 - Bc7Weights[i]) * e0[c]) + (Bc7Weights[i] * e1[c]) + 32) >> 6);
+        }
+      }
+
+      return palette;
+    }
+
+    void encode_bc7_block(const Block& block, uint8_t* target)
+    {
+      auto [low, high] = compute_endpoints<4>(block);
+      Bc7Endpoint e0 = quantize_bc7_endpoint(low);
+      Bc7Endpoint e1 = quantize_bc7_endpoint(high);
+
+      const std::array<Pixel, 16> palette = compute_bc7_palette(e0.expand(), e1.expand());
+      std::array<uint8_t, BlockPixels> indices = {};
+
+      for (int i = 0; i < BlockPixels; ++i) {
+        indices[i] = nearest_index<4>(block[i], palette);
+      }
+
+      // the most significant bit of the anchor index is implicitly 0
+      if ((indices[0] & 0x8) != 0) {
+        std::swap(e0, e1);
+
+        for (uint8_t& index : indices) {
+          index = static_cast<uint8_t>(15 - index);
+        }
+      }
+
+      BitWriter writer(target);
+      writer.write(1 << 6, 7);
+
+      for (int c = 0; c < 4; ++c) {
+        writer.write(e0.color[c], 7);
+        writer.write(e1.color[c], 7);
+      }
+
+      writer.write(e0.pbit, 1);
+      writer.write(e1.pbit, 1);
+      writer.write(indices[0], 3);
+
+      for (int i = 1; i < BlockPixels; ++i) {
+        writer.write(indices[i], 4);
+      }
+    }
+
+    void decode_bc7_block(const uint8_t* source, Block& block)
+    {
+      BitReader reader(source);
+
+      if (reader.read(7) != (1 << 6)) {
+        // unsupported mode, decoded as transparent black like invalid blocks
+        block.fill({ 0, 0, 0, 0 });
+        return;
+      }
+
+      Bc7Endpoint e0;
+      Bc7Endpoint e1;
+
+      for (int c = 0; c < 4; ++c) {
+        e0.color[c] = static_cast<uint8_t>(reader.read(7));
+        e1.color[c] = static_cast<uint8_t>(reader.read(7));
+      }
+
+      e0.pbit = static_cast<uint8_t>(reader.read(1));
+      e1.pbit = static_cast<uint8_t>(reader.read(1));
+
+      const std::array<Pixel, 16> palette = compute_bc7_palette(e0.expand(), e1.expand());
+
+      for (int i = 0; i < BlockPixels; ++i) {
+        block[i] = palette[reader.read(i == 0 ? 3 : 4)];
+      }
+    }
+
+    template<typename Func>
+    void for_each_block_row(Vec2I size, ThreadPool* pool, Func function)
+    {
+      const int columns = block_count(size.w);
+
+      parallel_for(pool, 0, block_count(size.h), [&](int begin, int end) {
+        for (int by = begin; by < end; ++by) {
+          for (int bx = 0; bx < columns; ++bx) {
+            function(bx, by, static_cast<std::size_t>(by) * static_cast<std::size_t>(columns) + static_cast<std::size_t>(bx));
+          }
+        }
+      });
+    }
+
+  } // namespace
+
+  std::size_t compute_compressed_size(Vec2I size, BlockCompression compression)
+  {
+    if (compression == BlockCompression::None) {
+      return static_cast<std::size_t>(size.w) * static_cast<std::size_t>(size.h) * 4;
+    }
+
+    return static_cast<std::size_t>(block_count(size.w)) * static_cast<std::size_t>(block_count(size.h)) * block_size(compression);
+  }
+
+  void compress_blocks(Span<const uint8_t> source, Vec2I size, BlockCompression compression, Span<uint8_t> target, ThreadPool* pool)
+  {
+    assert(source.size() == static_cast<std::size_t>(size.w) * static_cast<std::size_t>(size.h) * 4);
+    assert(target.size() == compute_compressed_size(size, compression));
+
+    if (size.w <= 0 || size.h <= 0) {
+      return;
+    }
+
+    const std::size_t stride = block_size(compression);
+
+    switch (compression) {
+      case BlockCompression::None:
+        std::copy(source.begin(), source.end(), target.begin());
+        break;
+
+      case BlockCompression::Bc1:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          encode_color_block(fetch_block(source.data(), size, bx, by), target.data() + (index * stride));
+        });
+        break;
+
+      case BlockCompression::Bc3:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          const Block block = fetch_block(source.data(), size, bx, by);
+          encode_alpha_block(block, target.data() + (index * stride));
+          encode_color_block(block, target.data() + (index * stride) + 8);
+        });
+        break;
+
+      case BlockCompression::Bc7:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          encode_bc7_block(fetch_block(source.data(), size, bx, by), target.data() + (index * stride));
+        });
+        break;
+    }
+  }
+
+  void decompress_blocks(Span<const uint8_t> source, Vec2I size, BlockCompression compression, Span<uint8_t> target, ThreadPool* pool)
+  {
+    assert(source.size() == compute_compressed_size(size, compression));
+    assert(target.size() == static_cast<std::size_t>(size.w) * static_cast<std::size_t>(size.h) * 4);
+
+    if (size.w <= 0 || size.h <= 0) {
+      return;
+    }
+
+    const std::size_t stride = block_size(compression);
+
+    switch (compression) {
+      case BlockCompression::None:
+        std::copy(source.begin(), source.end(), target.begin());
+        break;
+
+      case BlockCompression::Bc1:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          Block block = {};
+          decode_color_block(source.data() + (index * stride), block, true);
+          store_block(block, size, bx, by, target.data());
+        });
+        break;
+
+      case BlockCompression::Bc3:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          Block block = {};
+          decode_color_block(source.data() + (index * stride) + 8, block, false);
+          decode_alpha_block(source.data() + (index * stride), block);
+          store_block(block, size, bx, by, target.data());
+        });
+        break;
+
+      case BlockCompression::Bc7:
+        for_each_block_row(size, pool, [&](int bx, int by, std::size_t index) {
+          Block block = {};
+          decode_bc7_block(source.data() + (index * stride), block);
+          store_block(block, size, bx, by, target.data());
+        });
+        break;
+    }
+  }
+
+} // namespace gf
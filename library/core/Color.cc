@@ -7,6 +7,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <array>
 #include <limits>
 
 namespace gf {
@@ -128,25 +129,164 @@ namespace gf {
   }
 
   namespace {
-    float srgb_to_linear(float c)
+
+    /*
+     * The conversions are done with lookup tables instead of std::pow. For
+     * floats in [0, 1], the tables are linearly interpolated, the error is
+     * below 1e-4. For 8 bit channels, the tables give the exact results.
+     */
+
+    constexpr std::size_t ConversionTableSize = 4096;
+
+    double compute_srgb_to_linear(double c)
+    {
+      return (c < 0.04045) ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+    }
+
+    double compute_linear_to_srgb(double c)
+    {
+      return (c < 0.0031308) ? 12.92 * c : (1.055 * std::pow(c, 1.0 / 2.4)) - 0.055;
+    }
+
+    uint8_t to_channel_u8(double c)
     {
-      return (c < 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+      return static_cast<uint8_t>(std::clamp(c * 255.0 + 0.5, 0.0, 255.0));
     }
 
-    float linear_to_srgb(float c)
+    struct ConversionTables {
+      std::array<float, ConversionTableSize + 1> srgb_to_linear;
+      std::array<float, ConversionTableSize + 1> linear_to_srgb;
+      std::array<float, 256> srgb_u8_to_linear;
+      std::array<uint8_t, 256> srgb_u8_to_linear_u8;
+      std::array<uint8_t, 256> linear_u8_to_srgb_u8;
+    };
+
+    ConversionTables compute_conversion_tables()
     {
-      return (c < 0.0031308f) ? 12.92f * c : (1.055f * std::pow(c, 1.f / 2.4f)) - 0.055f;
+      ConversionTables tables = {};
+
+      for (std::size_t i = 0; i <= ConversionTableSize; ++i) {
+        const double c = static_cast<double>(i) / static_cast<double>(ConversionTableSize);
+        tables.srgb_to_linear[i] = static_cast<float>(compute_srgb_to_linear(c));
+        tables.linear_to_srgb[i] = static_cast<float>(compute_linear_to_srgb(c));
+      }
+
+      for (std::size_t i = 0; i < 256; ++i) {
+        const double c = static_cast<double>(i) / 255.0;
+        tables.srgb_u8_to_linear[i] = static_cast<float>(compute_srgb_to_linear(c));
+        tables.srgb_u8_to_linear_u8[i] = to_channel_u8(compute_srgb_to_linear(c));
+        tables.linear_u8_to_srgb_u8[i] = to_channel_u8(compute_linear_to_srgb(c));
+      }
+
+      return tables;
     }
+
+    const ConversionTables& conversion_tables()
+    {
+      static const ConversionTables tables = compute_conversion_tables();
+      return tables;
+    }
+
+    float interpolate_table(const std::array<float, ConversionTableSize + 1>& table, float c)
+    {
+      const float position = c * static_cast<float>(ConversionTableSize);
+      const auto index = std::min(static_cast<std::size_t>(position), ConversionTableSize - 1);
+      const float t = position - static_cast<float>(index);
+      return table[index] + (t * (table[index + 1] - table[index]));
+    }
+
+    float srgb_to_linear(const ConversionTables& tables, float c)
+    {
+      if (c > 0.0f && c < 1.0f) {
+        return interpolate_table(tables.srgb_to_linear, c);
+      }
+
+      return static_cast<float>(compute_srgb_to_linear(c));
+    }
+
+    float linear_to_srgb(const ConversionTables& tables, float c)
+    {
+      if (c > 0.0f && c < 1.0f) {
+        return interpolate_table(tables.linear_to_srgb, c);
+      }
+
+      return static_cast<float>(compute_linear_to_srgb(c));
+    }
+
+    template<typename Func>
+    void transform_rgba32(Span<const uint8_t> source, Span<uint8_t> target, Func function)
+    {
+      assert(source.size() == target.size());
+      assert(source.size() % 4 == 0);
+
+      const uint8_t* input = source.data();
+      uint8_t* output = target.data();
+
+      for (std::size_t i = 0; i < source.size(); i += 4) {
+        output[i + 0] = function(input[i + 0]);
+        output[i + 1] = function(input[i + 1]);
+        output[i + 2] = function(input[i + 2]);
+        output[i + 3] = input[i + 3];
+      }
+    }
+
   }
 
   Color srgb_to_linear(Color color)
   {
-    return { srgb_to_linear(color.r), srgb_to_linear(color.g), srgb_to_linear(color.b), color.a };
+    const ConversionTables& tables = conversion_tables();
+    return { srgb_to_linear(tables, color.r), srgb_to_linear(tables, color.g), srgb_to_linear(tables, color.b), color.a };
   }
 
   Color linear_to_srgb(Color color)
   {
-    return { linear_to_srgb(color.r), linear_to_srgb(color.g), linear_to_srgb(color.b), color.a };
+    const ConversionTables& tables = conversion_tables();
+    return { linear_to_srgb(tables, color.r), linear_to_srgb(tables, color.g), linear_to_srgb(tables, color.b), color.a };
+  }
+
+  float srgb_to_linear_u8(uint8_t channel)
+  {
+    return conversion_tables().srgb_u8_to_linear[channel];
+  }
+
+  uint8_t linear_to_srgb_u8(float channel)
+  {
+    return to_channel_u8(linear_to_srgb(conversion_tables(), channel));
+  }
+
+  void srgb_to_linear(Span<const Color> source, Span<Color> target)
+  {
+    assert(source.size() == target.size());
+    const ConversionTables& tables = conversion_tables();
+
+    for (std::size_t i = 0; i < source.size(); ++i) {
+      const Color color = source[i];
+      target[i] = { srgb_to_linear(tables, color.r), srgb_to_linear(tables, color.g), srgb_to_linear(tables, color.b), color.a };
+    }
+  }
+
+  void srgb_to_linear_rgba32(Span<const uint8_t> source, Span<uint8_t> target)
+  {
+    const std::array<uint8_t, 256>& table = conversion_tables().srgb_u8_to_linear_u8;
+    transform_rgba32(source, target, [&table](uint8_t channel) { return table[channel]; });
+  }
+
+  void srgb_to_linear_rgba32(Span<const uint8_t> source, Span<Color> target)
+  {
+    assert(source.size() == target.size() * 4);
+    const std::array<float, 256>& table = conversion_tables().srgb_u8_to_linear;
+    const uint8_t* input = source.data();
+
+    for (Color& color : target) {
+      color = { table[input[0]], table[input[1]], table[input[2]], static_cast<float>(input[3]) / 255.0f };
+      input += 4;
+    }
+  }
+
+  void linear_to_srgb_rgba32(Span<const uint8_t> source, Span<uint8_t> target)
+  {
+    const std::array<uint8_t, 256>& table = conversion_tables().linear_u8_to_srgb_u8;
+    transform_rgba32(source, target, [&table](uint8_t channel) { return table[channel]; });
   }
 
 } // namespace gf
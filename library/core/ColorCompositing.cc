@@ -3,6 +3,10 @@
 
 #include <gf2/core/ColorCompositing.h>
 
+#include <cassert>
+
+#include <type_traits>
+
 #include <gf2/core/Math.h>
 
 namespace gf {
@@ -95,79 +99,130 @@ namespace gf {
       return 1.0f;
     }
 
-    Color compute_raw_mixed_color(Color source, Color backdrop, BlendMode mode)
+    template<BlendMode Mode>
+    Color compute_raw_mixed_color(Color source, Color backdrop)
+    {
+      if constexpr (Mode == BlendMode::Normal) {
+        return source;
+      } else if constexpr (Mode == BlendMode::Darken) {
+        return min(backdrop, source);
+      } else if constexpr (Mode == BlendMode::Multiply) {
+        return backdrop * source;
+      } else if constexpr (Mode == BlendMode::ColorBurn) {
+        return {
+          channel_color_burn(backdrop.r, source.r),
+          channel_color_burn(backdrop.g, source.g),
+          channel_color_burn(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::LinearBurn) {
+        return backdrop + source - White;
+      } else if constexpr (Mode == BlendMode::Lighten) {
+        return max(backdrop, source);
+      } else if constexpr (Mode == BlendMode::Screen) {
+        return 1.0f - (1.0f - backdrop) * (1.0f - source);
+      } else if constexpr (Mode == BlendMode::ColorDodge) {
+        return {
+          channel_color_dodge(backdrop.r, source.r),
+          channel_color_dodge(backdrop.g, source.g),
+          channel_color_dodge(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::LinearDodge) {
+        return backdrop + source;
+      } else if constexpr (Mode == BlendMode::Overlay) {
+        return {
+          channel_overlay(backdrop.r, source.r),
+          channel_overlay(backdrop.g, source.g),
+          channel_overlay(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::SoftLight) {
+        return {
+          channel_soft_light(backdrop.r, source.r),
+          channel_soft_light(backdrop.g, source.g),
+          channel_soft_light(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::HardLight) {
+        return {
+          channel_hard_light(backdrop.r, source.r),
+          channel_hard_light(backdrop.g, source.g),
+          channel_hard_light(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::VividLight) {
+        return {
+          channel_vivid_light(backdrop.r, source.r),
+          channel_vivid_light(backdrop.g, source.g),
+          channel_vivid_light(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::LinearLight) {
+        return backdrop + 2.0f *source - White;
+      } else if constexpr (Mode == BlendMode::HardMix) {
+        return {
+          channel_hard_mix(backdrop.r, source.r),
+          channel_hard_mix(backdrop.g, source.g),
+          channel_hard_mix(backdrop.b, source.b)
+        };
+      } else if constexpr (Mode == BlendMode::Difference) {
+        return abs(source - backdrop);
+      } else if constexpr (Mode == BlendMode::Exclusion) {
+        return source + backdrop - (2.0f * source * backdrop);
+      } else if constexpr (Mode == BlendMode::Substract) {
+        return backdrop - source;
+      } else {
+        static_assert(Mode == BlendMode::Divide);
+        return clamp(backdrop / source);
+      }
+    }
+
+    template<BlendMode Mode>
+    using BlendModeConstant = std::integral_constant<BlendMode, Mode>;
+
+    // calls `function` with the mode as a compile-time constant, so that the
+    // switch is done once and not for every color
+    template<typename Func>
+    decltype(auto) visit_blend_mode(BlendMode mode, Func&& function)
     {
       switch (mode) {
         case BlendMode::Normal:
-          return source;
+          return function(BlendModeConstant<BlendMode::Normal>());
         case BlendMode::Darken:
-          return min(backdrop, source);
+          return function(BlendModeConstant<BlendMode::Darken>());
         case BlendMode::Multiply:
-          return backdrop * source;
+          return function(BlendModeConstant<BlendMode::Multiply>());
         case BlendMode::ColorBurn:
-          return {
-            channel_color_burn(backdrop.r, source.r),
-            channel_color_burn(backdrop.g, source.g),
-            channel_color_burn(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::ColorBurn>());
         case BlendMode::LinearBurn:
-          return backdrop + source - White;
+          return function(BlendModeConstant<BlendMode::LinearBurn>());
         case BlendMode::Lighten:
-          return max(backdrop, source);
+          return function(BlendModeConstant<BlendMode::Lighten>());
         case BlendMode::Screen:
-          return 1.0f - (1.0f - backdrop) * (1.0f - source);
+          return function(BlendModeConstant<BlendMode::Screen>());
         case BlendMode::ColorDodge:
-          return {
-            channel_color_dodge(backdrop.r, source.r),
-            channel_color_dodge(backdrop.g, source.g),
-            channel_color_dodge(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::ColorDodge>());
         case BlendMode::LinearDodge:
-          return backdrop + source;
+          return function(BlendModeConstant<BlendMode::LinearDodge>());
         case BlendMode::Overlay:
-          return {
-            channel_overlay(backdrop.r, source.r),
-            channel_overlay(backdrop.g, source.g),
-            channel_overlay(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::Overlay>());
         case BlendMode::SoftLight:
-          return {
-            channel_soft_light(backdrop.r, source.r),
-            channel_soft_light(backdrop.g, source.g),
-            channel_soft_light(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::SoftLight>());
         case BlendMode::HardLight:
-          return {
-            channel_hard_light(backdrop.r, source.r),
-            channel_hard_light(backdrop.g, source.g),
-            channel_hard_light(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::HardLight>());
         case BlendMode::VividLight:
-          return {
-            channel_vivid_light(backdrop.r, source.r),
-            channel_vivid_light(backdrop.g, source.g),
-            channel_vivid_light(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::VividLight>());
         case BlendMode::LinearLight:
-          return backdrop + 2.0f *source - White;
+          return function(BlendModeConstant<BlendMode::LinearLight>());
         case BlendMode::HardMix:
-          return {
-            channel_hard_mix(backdrop.r, source.r),
-            channel_hard_mix(backdrop.g, source.g),
-            channel_hard_mix(backdrop.b, source.b)
-          };
+          return function(BlendModeConstant<BlendMode::HardMix>());
         case BlendMode::Difference:
-          return abs(source - backdrop);
+          return function(BlendModeConstant<BlendMode::Difference>());
         case BlendMode::Exclusion:
-          return source + backdrop - (2.0f * source * backdrop);
+          return function(BlendModeConstant<BlendMode::Exclusion>());
         case BlendMode::Substract:
-          return backdrop - source;
+          return function(BlendModeConstant<BlendMode::Substract>());
         case BlendMode::Divide:
-          return clamp(backdrop / source);
+          return function(BlendModeConstant<BlendMode::Divide>());
       }
 
       assert(false);
-      return Black;
+      return function(BlendModeConstant<BlendMode::Normal>());
     }
 
     /*
@@ -190,60 +245,197 @@ namespace gf {
       };
     }
 
-    Color compute_raw_composed_color(Color source, Color backdrop, CompositingOperation operation)
+    template<CompositingOperation Operation>
+    Color compute_raw_composed_color(Color source, Color backdrop)
+    {
+      if constexpr (Operation == CompositingOperation::Clear) {
+        return { 0.0f, 0.0f, 0.0f, 0.0f };
+      } else if constexpr (Operation == CompositingOperation::Source) {
+        return compute_porter_duff_equation(source, backdrop, 1.0f, 0.0f);
+      } else if constexpr (Operation == CompositingOperation::Destination) {
+        return compute_porter_duff_equation(source, backdrop, 0.0f, 1.0f);
+      } else if constexpr (Operation == CompositingOperation::SourceOver) {
+        return compute_porter_duff_equation(source, backdrop, 1.0f, 1.0f - source.a);
+      } else if constexpr (Operation == CompositingOperation::DestinationOver) {
+        return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 1.0f);
+      } else if constexpr (Operation == CompositingOperation::SourceIn) {
+        return compute_porter_duff_equation(source, backdrop, backdrop.a, 0.0f);
+      } else if constexpr (Operation == CompositingOperation::DestinationIn) {
+        return compute_porter_duff_equation(source, backdrop, 0.0f, source.a);
+      } else if constexpr (Operation == CompositingOperation::SourceOut) {
+        return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 0.0f);
+      } else if constexpr (Operation == CompositingOperation::DestinationOut) {
+        return compute_porter_duff_equation(source, backdrop, 0.0f, 1.0f - source.a);
+      } else if constexpr (Operation == CompositingOperation::SourceAtop) {
+        return compute_porter_duff_equation(source, backdrop, backdrop.a, 1.0f - source.a);
+      } else if constexpr (Operation == CompositingOperation::DestinationAtop) {
+        return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, source.a);
+      } else {
+        static_assert(Operation == CompositingOperation::Xor);
+        return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 1.0f - source.a);
+      }
+    }
+
+    template<CompositingOperation Operation>
+    using CompositingOperationConstant = std::integral_constant<CompositingOperation, Operation>;
+
+    template<typename Func>
+    decltype(auto) visit_compositing_operation(CompositingOperation operation, Func&& function)
     {
       switch (operation) {
         case CompositingOperation::Clear:
-          return { 0.0f, 0.0f, 0.0f, 0.0f };
+          return function(CompositingOperationConstant<CompositingOperation::Clear>());
         case CompositingOperation::Source:
-          return compute_porter_duff_equation(source, backdrop, 1.0f, 0.0f);
+          return function(CompositingOperationConstant<CompositingOperation::Source>());
         case CompositingOperation::Destination:
-          return compute_porter_duff_equation(source, backdrop, 0.0f, 1.0f);
+          return function(CompositingOperationConstant<CompositingOperation::Destination>());
         case CompositingOperation::SourceOver:
-          return compute_porter_duff_equation(source, backdrop, 1.0f, 1.0f - source.a);
+          return function(CompositingOperationConstant<CompositingOperation::SourceOver>());
         case CompositingOperation::DestinationOver:
-          return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 1.0f);
+          return function(CompositingOperationConstant<CompositingOperation::DestinationOver>());
         case CompositingOperation::SourceIn:
-          return compute_porter_duff_equation(source, backdrop, backdrop.a, 0.0f);
+          return function(CompositingOperationConstant<CompositingOperation::SourceIn>());
         case CompositingOperation::DestinationIn:
-          return compute_porter_duff_equation(source, backdrop, 0.0f, source.a);
+          return function(CompositingOperationConstant<CompositingOperation::DestinationIn>());
         case CompositingOperation::SourceOut:
-          return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 0.0f);
+          return function(CompositingOperationConstant<CompositingOperation::SourceOut>());
         case CompositingOperation::DestinationOut:
-          return compute_porter_duff_equation(source, backdrop, 0.0f, 1.0f - source.a);
+          return function(CompositingOperationConstant<CompositingOperation::DestinationOut>());
         case CompositingOperation::SourceAtop:
-          return compute_porter_duff_equation(source, backdrop, backdrop.a, 1.0f - source.a);
+          return function(CompositingOperationConstant<CompositingOperation::SourceAtop>());
         case CompositingOperation::DestinationAtop:
-          return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, source.a);
+          return function(CompositingOperationConstant<CompositingOperation::DestinationAtop>());
         case CompositingOperation::Xor:
-          return compute_porter_duff_equation(source, backdrop, 1.0f - backdrop.a, 1.0f - source.a);
+          return function(CompositingOperationConstant<CompositingOperation::Xor>());
       }
 
       assert(false);
-      return Black;
+      return function(CompositingOperationConstant<CompositingOperation::Clear>());
+    }
+
+    /*
+     * Kernels
+     */
+
+    template<BlendMode Mode>
+    Color compute_mixed_color(Color source, Color backdrop)
+    {
+      return mix_normalize(compute_raw_mixed_color<Mode>(source, backdrop));
+    }
+
+    template<CompositingOperation Operation>
+    Color compute_composed_color(Color source, Color backdrop)
+    {
+      return clamp(compute_raw_composed_color<Operation>(source, backdrop));
+    }
+
+    template<BlendMode Mode, CompositingOperation Operation>
+    Color compute_combined_color(Color source, Color backdrop)
+    {
+      Color mixed = clamp(compute_raw_mixed_color<Mode>(source, backdrop));
+      mixed.a = source.a;
+      return clamp(compute_raw_composed_color<Operation>(mixed, backdrop));
+    }
+
+    // the loops are instantiated for each mode and each operation (the kernel
+    // is a different lambda each time), the body is fully inlined and the
+    // compiler is able to vectorize it
+
+    template<typename Kernel>
+    void apply_kernel(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, Kernel kernel)
+    {
+      assert(sources.size() == backdrops.size());
+      assert(results.size() == backdrops.size());
+      const std::size_t count = results.size();
+
+      for (std::size_t i = 0; i < count; ++i) {
+        results[i] = kernel(sources[i], backdrops[i]);
+      }
+    }
+
+    template<typename Kernel>
+    void apply_kernel(Color source, Span<const Color> backdrops, Span<Color> results, Kernel kernel)
+    {
+      assert(results.size() == backdrops.size());
+      const std::size_t count = results.size();
+
+      for (std::size_t i = 0; i < count; ++i) {
+        results[i] = kernel(source, backdrops[i]);
+      }
+    }
+
+    template<typename Source>
+    void apply_combine(Source source, Span<const Color> backdrops, Span<Color> results, BlendMode mode, CompositingOperation operation)
+    {
+      visit_blend_mode(mode, [&](auto mode_constant) {
+        visit_compositing_operation(operation, [&](auto operation_constant) {
+          apply_kernel(source, backdrops, results, [](Color source_color, Color backdrop_color) {
+            return compute_combined_color<decltype(mode_constant)::value, decltype(operation_constant)::value>(source_color, backdrop_color);
+          });
+        });
+      });
     }
 
   }
 
   Color mix_colors(Color source, Color backdrop, BlendMode mode)
   {
-    return mix_normalize(compute_raw_mixed_color(source, backdrop, mode));
+    return visit_blend_mode(mode, [&](auto mode_constant) {
+      return compute_mixed_color<decltype(mode_constant)::value>(source, backdrop);
+    });
   }
 
   Color compose_colors(Color source, Color backdrop, CompositingOperation operation)
   {
-    return clamp(compute_raw_composed_color(source, backdrop, operation));
+    return visit_compositing_operation(operation, [&](auto operation_constant) {
+      return compute_composed_color<decltype(operation_constant)::value>(source, backdrop);
+    });
   }
 
   Color combine_colors(Color source, Color backdrop, BlendMode mode, CompositingOperation operation)
   {
-    Color mixed = clamp(compute_raw_mixed_color(source, backdrop, mode));
-    mixed.a = source.a;
-    return clamp(compute_raw_composed_color(mixed, backdrop, operation));
+    return visit_blend_mode(mode, [&](auto mode_constant) {
+      return visit_compositing_operation(operation, [&](auto operation_constant) {
+        return compute_combined_color<decltype(mode_constant)::value, decltype(operation_constant)::value>(source, backdrop);
+      });
+    });
   }
 
   Color blend_colors(Color source, Color backdrop, BlendMode mode) {
     return combine_colors(source, backdrop, mode, CompositingOperation::SourceOver);
   }
 
+  void mix_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode)
+  {
+    visit_blend_mode(mode, [&](auto mode_constant) {
+      apply_kernel(sources, backdrops, results, [](Color source, Color backdrop) {
+        return compute_mixed_color<decltype(mode_constant)::value>(source, backdrop);
+      });
+    });
+  }
+
+  void compose_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, CompositingOperation operation)
+  {
+    visit_compositing_operation(operation, [&](auto operation_constant) {
+      apply_kernel(sources, backdrops, results, [](Color source, Color backdrop) {
+        return compute_composed_color<decltype(operation_constant)::value>(source, backdrop);
+      });
+    });
+  }
+
+  void combine_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode, CompositingOperation operation)
+  {
+    apply_combine(sources, backdrops, results, mode, operation);
+  }
+
+  void combine_colors(Color source, Span<const Color> backdrops, Span<Color> results, BlendMode mode, CompositingOperation operation)
+  {
+    apply_combine(source, backdrops, results, mode, operation);
+  }
+
+  void blend_colors(Span<const Color> sources, Span<const Color> backdrops, Span<Color> results, BlendMode mode)
+  {
+    apply_combine(sources, backdrops, results, mode, CompositingOperation::SourceOver);
+  }
+
 }
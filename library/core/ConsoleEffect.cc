@@ -12,4 +12,9 @@ namespace gf {
     return combine_colors(proposed, existing, m_mode, m_operation);
   }
 
+  void ConsoleEffect::compute_colors(Span<Color> existing, Color proposed) const
+  {
+    combine_colors(proposed, existing, existing, m_mode, m_operation);
+  }
+
 }
@@ -5,6 +5,9 @@
 
 #include <cassert>
 
+#include <optional>
+#include <vector>
+
 #include <gf2/core/Blit.h>
 #include <gf2/core/ConsoleChar.h>
 #include <gf2/core/ConsoleStyle.h>
@@ -289,6 +292,40 @@ namespace gf {
     cell.parts[1].background = effect.compute_color(cell.parts[1].background, color);
   }
 
+  void console_write_background(Console& console, RectI area, Color color, ConsoleEffect effect)
+  {
+    const std::optional<RectI> maybe_intersection = RectI::from_size(console.size()).intersection(area);
+
+    if (!maybe_intersection) {
+      return;
+    }
+
+    area = *maybe_intersection;
+
+    // the backgrounds of a row are gathered so that the effect is computed in bulk
+    std::vector<Color> backgrounds(2 * static_cast<std::size_t>(area.extent.w));
+
+    for (int y = area.offset.y; y < area.offset.y + area.extent.h; ++y) {
+      auto iterator = backgrounds.begin();
+
+      for (int x = area.offset.x; x < area.offset.x + area.extent.w; ++x) {
+        const ConsoleCell& cell = console({ x, y });
+        *iterator++ = cell.parts[0].background;
+        *iterator++ = cell.parts[1].background;
+      }
+
+      effect.compute_colors(backgrounds, color);
+      iterator = backgrounds.begin();
+
+      for (int x = area.offset.x; x < area.offset.x + area.extent.w; ++x) {
+        ConsoleCell& cell = console({ x, y });
+        // do not change the mode of the cell
+        cell.parts[0].background = *iterator++;
+        cell.parts[1].background = *iterator++;
+      }
+    }
+  }
+
   void console_write_picture(Console& console, Vec2I position, char16_t character)
   {
     if (!console.valid(position)) {
@@ -70,6 +70,20 @@ namespace gf {
   {
     assert(manager != nullptr);
 
+    if (const Span<const uint8_t> memory = stream.view(); !memory.empty()) {
+      // the data is already in memory (and must outlive the face), no need for a stream
+      FT_Face face = nullptr;
+
+      if (const FT_Error err = FT_New_Memory_Face(m_manager->library_as<FT_Library>(), memory.data(), static_cast<FT_Long>(memory.size()), 0, &face)) {
+        Log::fatal("Could not create the font face from memory: {}", FontManager::error_message(err));
+      }
+
+      m_face = face;
+
+      set_current_character_size(FontSize);
+      return;
+    }
+
     FT_StreamRec rec = {};
     std::memset(&rec, 0, sizeof(FT_StreamRec));
     rec.base = nullptr;
@@ -19,7 +19,10 @@
 
 #include <gf2/core/Blit.h>
 #include <gf2/core/Log.h>
+#include <gf2/core/PngWriter.h>
 #include <gf2/core/Stream.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/ThreadPool.h>
 
 namespace gf {
 
@@ -147,6 +150,13 @@ namespace gf {
   Image::Image(InputStream& stream)
   : m_size(0, 0)
   {
+    if (const Span<const uint8_t> memory = stream.view(); !memory.empty()) {
+      // the data is already in memory, decode it without any intermediate copy
+      *this = Image(memory);
+      stream.skip(static_cast<std::ptrdiff_t>(memory.size()));
+      return;
+    }
+
     stbi_io_callbacks callbacks;
     callbacks.read = &stb_callback_read;
     callbacks.skip = &stb_callback_skip;
@@ -164,6 +174,21 @@ namespace gf {
     stbi_image_free(pixels);
   }
 
+  Image::Image(Span<const uint8_t> memory)
+  : m_size(0, 0)
+  {
+    int n = 0;
+    uint8_t* pixels = stbi_load_from_memory(memory.data(), static_cast<int>(memory.size()), &m_size.w, &m_size.h, &n, STBI_rgb_alpha);
+
+    if (m_size.w == 0 || m_size.h == 0 || pixels == nullptr) {
+      Log::fatal("Could not load image from memory: {}\n", stbi_failure_reason());
+    }
+
+    m_pixels.resize(compute_image_size(m_size));
+    std::copy_n(pixels, m_pixels.size(), m_pixels.data());
+    stbi_image_free(pixels);
+  }
+
   Vec2I Image::size() const
   {
     return m_size;
@@ -197,7 +222,7 @@ namespace gf {
     ptr[3] = to_byte(color.a);
   }
 
-  void Image::save_to_file(const std::filesystem::path& filename) const
+  void Image::save_to_file(const std::filesystem::path& filename, ThreadPool* pool) const
   {
     if (m_size.w == 0 || m_size.h == 0 || m_pixels.empty()) {
       return;
@@ -212,7 +237,8 @@ namespace gf {
     const std::string filename_string = filename.string();
 
     if (extension == ".png") {
-      stbi_write_png(filename_string.c_str(), m_size.w, m_size.h, 4, m_pixels.data(), 0);
+      FileOutputStream stream(filename);
+      save_to_stream(stream, pool);
       return;
     }
 
@@ -229,6 +255,22 @@ namespace gf {
     Log::error("Format not supported: '{}'\n", extension);
   }
 
+  void Image::save_to_stream(OutputStream& stream, ThreadPool* pool) const
+  {
+    if (m_size.w == 0 || m_size.h == 0 || m_pixels.empty()) {
+      return;
+    }
+
+    PngWriter writer(&stream, m_size, PixelFormat::Rgba32, pool);
+    const std::size_t row_size = 4 * static_cast<std::size_t>(m_size.w);
+
+    for (int y = 0; y < m_size.h; ++y) {
+      writer.write_row(Span<const uint8_t>(m_pixels.data() + (y * row_size), row_size));
+    }
+
+    writer.finish();
+  }
+
   void Image::blit_to(RectI origin_region, Image& target_image, Vec2I target_offset) const
   {
     const Blit blit = compute_blit(origin_region, m_size, target_offset, target_image.size());
@@ -273,6 +315,17 @@ namespace gf {
     return image;
   }
 
+  Image Image::resized(Vec2I size, ResamplingFilter filter, ThreadPool* pool) const
+  {
+    if (size.w <= 0 || size.h <= 0 || m_pixels.empty()) {
+      return {};
+    }
+
+    Image image(size);
+    resample_rgba32(m_pixels, m_size, image.m_pixels, size, filter, pool);
+    return image;
+  }
+
   std::size_t Image::raw_size() const
   {
     return static_cast<std::size_t>(m_size.w) * static_cast<std::size_t>(m_size.h) * 4;
@@ -311,4 +364,20 @@ namespace gf {
     return size;
   }
 
+  std::future<Image> load_image_async(ThreadPool& pool, std::filesystem::path filename)
+  {
+    return pool.submit([filename = std::move(filename)]() { return Image(filename); });
+  }
+
+  std::future<Image> decode_image_async(ThreadPool& pool, std::vector<uint8_t> bytes)
+  {
+    return pool.submit([bytes = std::move(bytes)]() { return Image(Span<const uint8_t>(bytes)); });
+  }
+
+  std::future<void> save_image_async(ThreadPool& pool, Image image, std::filesystem::path filename)
+  {
+    // the encoding is not split on the pool, a task waiting for other tasks of the same pool could stall it
+    return pool.submit([image = std::move(image), filename = std::move(filename)]() { image.save_to_file(filename); });
+  }
+
 } // namespace gf
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/PngWriter.h>
+
+#include <cassert>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include <zlib.h>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/Stream.h>
+
+#include "bits/DeflateBlocks.h"
+
+namespace gf {
+
+  /*
+   * The PNG specification is available here:
+   * https://www.w3.org/TR/png-3/
+   *
+   * The compressed data is split in independent deflate blocks that can be
+   * compressed in parallel, see details::DeflateBlocks.
+   */
+
+  namespace {
+
+    constexpr std::size_t BlockSize = details::DeflateBlocks::BlockSize;
+
+    constexpr std::array<uint8_t, 8> PngSignature = { 0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A };
+    constexpr std::array<uint8_t, 2> ZlibHeader = { 0x78, 0x9C }; // deflate, 32K window, default compression
+
+    constexpr uint8_t PngColorTypeRgb = 2;
+    constexpr uint8_t PngColorTypeRgba = 6;
+
+    enum class PngFilter : uint8_t {
+      None = 0,
+      Sub = 1,
+      Up = 2,
+      Average = 3,
+      Paeth = 4,
+    };
+
+    void push_big_endian(std::vector<uint8_t>& bytes, uint32_t value)
+    {
+      bytes.push_back(static_cast<uint8_t>(value >> 24));
+      bytes.push_back(static_cast<uint8_t>(value >> 16));
+      bytes.push_back(static_cast<uint8_t>(value >> 8));
+      bytes.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint8_t paeth_predictor(int a, int b, int c)
+    {
+      const int p = a + b - c;
+      const int pa = std::abs(p - a);
+      const int pb = std::abs(p - b);
+      const int pc = std::abs(p - c);
+
+      if (pa <= pb && pa <= pc) {
+        return static_cast<uint8_t>(a);
+      }
+
+      if (pb <= pc) {
+        return static_cast<uint8_t>(b);
+      }
+
+      return static_cast<uint8_t>(c);
+    }
+
+    uint8_t filter_byte(PngFilter filter, const uint8_t* row, const uint8_t* previous, std::size_t i, std::size_t pixel_size)
+    {
+      const int a = i >= pixel_size ? row[i - pixel_size] : 0;
+      const int b = previous[i];
+      const int c = i >= pixel_size ? previous[i - pixel_size] : 0;
+
+      switch (filter) {
+        case PngFilter::None:
+          return row[i];
+        case PngFilter::Sub:
+          return static_cast<uint8_t>(row[i] - a);
+        case PngFilter::Up:
+          return static_cast<uint8_t>(row[i] - b);
+        case PngFilter::Average:
+          return static_cast<uint8_t>(row[i] - ((a + b) / 2));
+        case PngFilter::Paeth:
+          return static_cast<uint8_t>(row[i] - paeth_predictor(a, b, c));
+      }
+
+      assert(false);
+      return row[i];
+    }
+
+    // usual heuristic: choose the filter that minimizes the sum of absolute differences
+    PngFilter choose_filter(const uint8_t* row, const uint8_t* previous, std::size_t size, std::size_t pixel_size)
+    {
+      static constexpr PngFilter Filters[] = { PngFilter::None, PngFilter::Sub, PngFilter::Up, PngFilter::Average, PngFilter::Paeth };
+
+      PngFilter best_filter = PngFilter::None;
+      uint64_t best_cost = UINT64_MAX;
+
+      for (const PngFilter filter : Filters) {
+        uint64_t cost = 0;
+
+        for (std::size_t i = 0; i < size; ++i) {
+          cost += static_cast<uint64_t>(std::abs(static_cast<int8_t>(filter_byte(filter, row, previous, i, pixel_size))));
+        }
+
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_filter = filter;
+        }
+      }
+
+      return best_filter;
+    }
+
+  } // namespace
+
+  PngWriter::PngWriter(OutputStream* stream, Vec2I size, PixelFormat format, ThreadPool* pool)
+  : m_stream(stream)
+  , m_size(size)
+  , m_blocks(std::make_unique<details::DeflateBlocks>(details::DeflateChecksum::Adler32, pool, [this](Span<const uint8_t> bytes) { write_chunk("IDAT", bytes); }))
+  {
+    assert(stream != nullptr);
+    assert(size.w > 0 && size.h > 0);
+
+    uint8_t color_type = PngColorTypeRgba;
+
+    switch (format) {
+      case PixelFormat::Rgba32:
+        m_pixel_size = 4;
+        color_type = PngColorTypeRgba;
+        break;
+      case PixelFormat::Rgb24:
+        m_pixel_size = 3;
+        color_type = PngColorTypeRgb;
+        break;
+    }
+
+    const std::size_t row_size = m_pixel_size * static_cast<std::size_t>(m_size.w);
+    m_previous_row.resize(row_size, 0);
+    m_filtered_row.resize(row_size);
+    m_block.reserve(BlockSize + row_size + 1);
+
+    m_stream->write(Span<const uint8_t>(PngSignature.data(), PngSignature.size()));
+
+    std::vector<uint8_t> header;
+    push_big_endian(header, static_cast<uint32_t>(m_size.w));
+    push_big_endian(header, static_cast<uint32_t>(m_size.h));
+    header.push_back(8); // bit depth
+    header.push_back(color_type);
+    header.push_back(0); // compression method
+    header.push_back(0); // filter method
+    header.push_back(0); // interlace method
+    write_chunk("IHDR", header);
+
+    // the compressed data may be split in several IDAT chunks
+    write_chunk("IDAT", Span<const uint8_t>(ZlibHeader.data(), ZlibHeader.size()));
+  }
+
+  PngWriter::~PngWriter()
+  {
+    if (!m_finished) {
+      finish();
+    }
+  }
+
+  void PngWriter::write_row(Span<const uint8_t> row)
+  {
+    assert(!m_finished);
+    assert(row.size() == m_previous_row.size());
+
+    if (m_rows >= m_size.h) {
+      Log::error("Too many rows for the PNG image.");
+      return;
+    }
+
+    const std::size_t size = row.size();
+    const PngFilter filter = choose_filter(row.data(), m_previous_row.data(), size, m_pixel_size);
+
+    for (std::size_t i = 0; i < size; ++i) {
+      m_filtered_row[i] = filter_byte(filter, row.data(), m_previous_row.data(), i, m_pixel_size);
+    }
+
+    m_block.push_back(static_cast<uint8_t>(filter));
+    m_block.insert(m_block.end(), m_filtered_row.begin(), m_filtered_row.end());
+    std::copy(row.begin(), row.end(), m_previous_row.begin());
+    ++m_rows;
+
+    if (m_block.size() >= BlockSize) {
+      flush_block(false);
+    }
+  }
+
+  void PngWriter::finish()
+  {
+    if (m_finished) {
+      return;
+    }
+
+    if (m_rows != m_size.h) {
+      Log::error("Missing rows in the PNG image: {} rows written out of {}.", m_rows, m_size.h);
+    }
+
+    flush_block(true);
+    m_blocks->finish();
+
+    std::vector<uint8_t> trailer;
+    push_big_endian(trailer, m_blocks->checksum());
+    write_chunk("IDAT", trailer);
+
+    write_chunk("IEND", {});
+    m_finished = true;
+  }
+
+  void PngWriter::write_chunk(const char* type, Span<const uint8_t> data)
+  {
+    const auto* type_bytes = reinterpret_cast<const uint8_t*>(type); // NOLINT
+
+    std::vector<uint8_t> length;
+    push_big_endian(length, static_cast<uint32_t>(data.size()));
+    m_stream->write(length);
+    m_stream->write(Span<const uint8_t>(type_bytes, 4));
+    m_stream->write(data);
+
+    uLong crc = crc32(0, type_bytes, 4);
+
+    if (!data.empty()) {
+      // a null buffer would reset the crc
+      crc = crc32(crc, data.data(), static_cast<uInt>(data.size()));
+    }
+
+    std::vector<uint8_t> checksum;
+    push_big_endian(checksum, static_cast<uint32_t>(crc));
+    m_stream->write(checksum);
+  }
+
+  void PngWriter::flush_block(bool last)
+  {
+    m_blocks->push(std::exchange(m_block, {}), last);
+    m_block.reserve(BlockSize + m_previous_row.size() + 1);
+  }
+
+} // namespace gf
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/Resampling.h>
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <gf2/core/Math.h>
+#include <gf2/core/ThreadPool.h>
+
+namespace gf {
+
+  namespace {
+
+    float filter_support(ResamplingFilter filter)
+    {
+      switch (filter) {
+        case ResamplingFilter::Bilinear:
+          return 1.0f;
+        case ResamplingFilter::Lanczos:
+          return 3.0f;
+      }
+
+      assert(false);
+      return 1.0f;
+    }
+
+    float filter_kernel(ResamplingFilter filter, float x)
+    {
+      x = std::abs(x);
+
+      switch (filter) {
+        case ResamplingFilter::Bilinear:
+          return x < 1.0f ? 1.0f - x : 0.0f;
+
+        case ResamplingFilter::Lanczos:
+          {
+            if (x < 1e-6f) {
+              return 1.0f;
+            }
+
+            if (x >= 3.0f) {
+              return 0.0f;
+            }
+
+            const float px = gf::Pi * x;
+            return 3.0f * std::sin(px) * std::sin(px / 3.0f) / (px * px);
+          }
+      }
+
+      assert(false);
+      return 0.0f;
+    }
+
+    // For each target coordinate, the range of source coordinates and their
+    // normalized weights. Weights are stored with a fixed stride so that a
+    // target coordinate can find its weights without any indirection.
+    struct Contributions {
+      std::vector<int> first;
+      std::vector<int> count;
+      std::vector<float> weights;
+      int stride = 0;
+
+      const float* weights_of(int index) const
+      {
+        return weights.data() + (static_cast<std::ptrdiff_t>(index) * stride);
+      }
+    };
+
+    Contributions compute_contributions(int source_size, int target_size, ResamplingFilter filter)
+    {
+      const float scale = static_cast<float>(target_size) / static_cast<float>(source_size);
+      // when downscaling, the filter is widened to avoid aliasing
+      const float filter_scale = std::max(1.0f, 1.0f / scale);
+      const float support = filter_support(filter) * filter_scale;
+
+      Contributions contributions;
+      contributions.stride = static_cast<int>(std::ceil(2.0f * support)) + 2;
+      contributions.first.resize(target_size);
+      contributions.count.resize(target_size);
+      contributions.weights.resize(static_cast<std::size_t>(target_size) * static_cast<std::size_t>(contributions.stride), 0.0f);
+
+      for (int i = 0; i < target_size; ++i) {
+        const float center = (static_cast<float>(i) + 0.5f) / scale;
+        const int first = std::max(0, static_cast<int>(std::floor(center - support)));
+        const int last = std::min(source_size - 1, static_cast<int>(std::ceil(center + support)));
+        const int count = last - first + 1;
+        assert(count <= contributions.stride);
+
+        float* weights = contributions.weights.data() + (static_cast<std::ptrdiff_t>(i) * contributions.stride);
+        float sum = 0.0f;
+
+        for (int k = 0; k < count; ++k) {
+          const float weight = filter_kernel(filter, (static_cast<float>(first + k) + 0.5f - center) / filter_scale);
+          weights[k] = weight;
+          sum += weight;
+        }
+
+        if (sum != 0.0f) {
+          for (int k = 0; k < count; ++k) {
+            weights[k] /= sum;
+          }
+        }
+
+        contributions.first[i] = first;
+        contributions.count[i] = count;
+      }
+
+      return contributions;
+    }
+
+    uint8_t quantize(float value)
+    {
+      return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+    }
+
+    template<int Channels, bool Premultiplied>
+    void load_row(const uint8_t* source, int width, float* row)
+    {
+      if constexpr (Premultiplied) {
+        static_assert(Channels == 4);
+
+        for (int x = 0; x < width; ++x) {
+          const float alpha = static_cast<float>(source[3]) / 255.0f;
+          row[0] = static_cast<float>(source[0]) * alpha;
+          row[1] = static_cast<float>(source[1]) * alpha;
+          row[2] = static_cast<float>(source[2]) * alpha;
+          row[3] = static_cast<float>(source[3]);
+          source += 4;
+          row += 4;
+        }
+      } else {
+        for (int i = 0; i < width * Channels; ++i) {
+          row[i] = static_cast<float>(source[i]);
+        }
+      }
+    }
+
+    template<int Channels, bool Premultiplied>
+    void store_row(const float* row, int width, uint8_t* target)
+    {
+      if constexpr (Premultiplied) {
+        static_assert(Channels == 4);
+
+        for (int x = 0; x < width; ++x) {
+          const float alpha = std::clamp(row[3], 0.0f, 255.0f);
+
+          if (alpha > 0.0f) {
+            const float factor = 255.0f / alpha;
+            target[0] = quantize(row[0] * factor);
+            target[1] = quantize(row[1] * factor);
+            target[2] = quantize(row[2] * factor);
+          } else {
+            target[0] = target[1] = target[2] = 0;
+          }
+
+          target[3] = quantize(alpha);
+          row += 4;
+          target += 4;
+        }
+      } else {
+        for (int i = 0; i < width * Channels; ++i) {
+          target[i] = quantize(row[i]);
+        }
+      }
+    }
+
+    template<int Channels, bool Premultiplied>
+    void resample(Span<const uint8_t> source, Vec2I source_size, Span<uint8_t> target, Vec2I target_size, ResamplingFilter filter, ThreadPool* pool)
+    {
+      assert(source.size() == static_cast<std::size_t>(source_size.w) * static_cast<std::size_t>(source_size.h) * Channels);
+      assert(target.size() == static_cast<std::size_t>(target_size.w) * static_cast<std::size_t>(target_size.h) * Channels);
+
+      if (source_size.w <= 0 || source_size.h <= 0 || target_size.w <= 0 || target_size.h <= 0) {
+        return;
+      }
+
+      const Contributions horizontal = compute_contributions(source_size.w, target_size.w, filter);
+      const Contributions vertical = compute_contributions(source_size.h, target_size.h, filter);
+
+      const auto source_stride = static_cast<std::ptrdiff_t>(source_size.w) * Channels;
+      const auto target_stride = static_cast<std::ptrdiff_t>(target_size.w) * Channels;
+
+      // horizontal pass: source_size.w x source_size.h -> target_size.w x source_size.h
+
+      std::vector<float> intermediate(static_cast<std::size_t>(target_stride) * static_cast<std::size_t>(source_size.h));
+
+      parallel_for(pool, 0, source_size.h, [&](int begin, int end) {
+        std::vector<float> row(static_cast<std::size_t>(source_stride));
+
+        for (int y = begin; y < end; ++y) {
+          load_row<Channels, Premultiplied>(source.data() + (y * source_stride), source_size.w, row.data());
+          float* output = intermediate.data() + (y * target_stride);
+
+          for (int x = 0; x < target_size.w; ++x) {
+            const float* weights = horizontal.weights_of(x);
+            const float* input = row.data() + (static_cast<std::ptrdiff_t>(horizontal.first[x]) * Channels);
+            std::array<float, Channels> accumulator = {};
+
+            for (int k = 0; k < horizontal.count[x]; ++k) {
+              for (int c = 0; c < Channels; ++c) {
+                accumulator[c] += weights[k] * input[c];
+              }
+
+              input += Channels;
+            }
+
+            std::copy_n(accumulator.data(), Channels, output);
+            output += Channels;
+          }
+        }
+      });
+
+      // vertical pass: target_size.w x source_size.h -> target_size.w x target_size.h
+
+      parallel_for(pool, 0, target_size.h, [&](int begin, int end) {
+        std::vector<float> accumulator(static_cast<std::size_t>(target_stride));
+
+        for (int y = begin; y < end; ++y) {
+          std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+          const float* weights = vertical.weights_of(y);
+
+          for (int k = 0; k < vertical.count[y]; ++k) {
+            const float weight = weights[k];
+            const float* input = intermediate.data() + (static_cast<std::ptrdiff_t>(vertical.first[y] + k) * target_stride);
+
+            for (std::ptrdiff_t i = 0; i < target_stride; ++i) {
+              accumulator[i] += weight * input[i];
+            }
+          }
+
+          store_row<Channels, Premultiplied>(accumulator.data(), target_size.w, target.data() + (y * target_stride));
+        }
+      });
+    }
+
+  } // namespace
+
+  void resample_rgba32(Span<const uint8_t> source, Vec2I source_size, Span<uint8_t> target, Vec2I target_size, ResamplingFilter filter, ThreadPool* pool)
+  {
+    resample<4, true>(source, source_size, target, target_size, filter, pool);
+  }
+
+  void resample_gray8(Span<const uint8_t> source, Vec2I source_size, Span<uint8_t> target, Vec2I target_size, ResamplingFilter filter, ThreadPool* pool)
+  {
+    resample<1, false>(source, source_size, target, target_size, filter, pool);
+  }
+
+} // namespace gf
@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/ResourceBudget.h>
+
+#include <cassert>
+
+#include <algorithm>
+
+namespace gf {
+
+  namespace details {
+
+    ResourceCache::~ResourceCache() = default;
+
+    uint64_t next_resource_tick()
+    {
+      static std::atomic<uint64_t> tick = 0;
+      return ++tick;
+    }
+
+  } // namespace details
+
+  ResourceBudget::ResourceBudget(std::size_t limit)
+  : m_limit(limit)
+  {
+  }
+
+  ResourceBudget::~ResourceBudget()
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    for (details::ResourceCache* cache : m_caches) {
+      cache->detach_budget(this);
+    }
+  }
+
+  void ResourceBudget::set_limit(std::size_t limit)
+  {
+    m_limit = limit;
+    enforce();
+  }
+
+  std::size_t ResourceBudget::limit() const
+  {
+    return m_limit;
+  }
+
+  std::size_t ResourceBudget::usage() const
+  {
+    return m_usage;
+  }
+
+  void ResourceBudget::attach(details::ResourceCache* cache)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    assert(std::ranges::find(m_caches, cache) == m_caches.end());
+    m_caches.push_back(cache);
+  }
+
+  void ResourceBudget::detach(details::ResourceCache* cache)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    std::erase(m_caches, cache);
+  }
+
+  void ResourceBudget::add_usage(std::size_t size)
+  {
+    m_usage += size;
+  }
+
+  void ResourceBudget::remove_usage(std::size_t size)
+  {
+    assert(m_usage >= size);
+    m_usage -= size;
+  }
+
+  void ResourceBudget::enforce()
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    while (m_limit > 0 && m_usage > m_limit) {
+      // evict the least recently used resource among all the caches
+      details::ResourceCache* oldest_cache = nullptr;
+      uint64_t oldest_tick = 0;
+
+      for (details::ResourceCache* cache : m_caches) {
+        if (const std::optional<uint64_t> tick = cache->oldest_unused(); tick && (oldest_cache == nullptr || *tick < oldest_tick)) {
+          oldest_cache = cache;
+          oldest_tick = *tick;
+        }
+      }
+
+      if (oldest_cache == nullptr) {
+        break;
+      }
+
+      oldest_cache->evict_oldest_unused();
+    }
+  }
+
+} // namespace gf
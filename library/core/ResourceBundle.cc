@@ -3,8 +3,197 @@
 
 #include <gf2/core/ResourceBundle.h>
 
+#include <cassert>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <queue>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/ThreadPool.h>
+
 namespace gf {
 
+  namespace details {
+
+    VertexId ResourcePlan::add_task(std::function<void()> task, bool parallel, const std::vector<VertexId>& dependencies, std::function<void()> undo)
+    {
+      const VertexId vertex = m_graph.add_vertex();
+      assert(to_index(vertex) == m_tasks.size());
+      m_tasks.push_back({ std::move(task), parallel, std::move(undo) });
+
+      for (const VertexId dependency : dependencies) {
+        m_graph.add_edge(dependency, vertex);
+      }
+
+      return vertex;
+    }
+
+    std::size_t ResourcePlan::task_count() const
+    {
+      return m_tasks.size();
+    }
+
+    void ResourcePlan::run(ThreadPool* pool, const std::function<void(std::size_t, std::size_t)>& progress)
+    {
+      m_pool = pool;
+
+      const std::size_t total = m_tasks.size();
+      const std::vector<VertexId> order = topological_sort(m_graph);
+
+      if (order.size() != total) {
+        Log::fatal("Cycle in the dependencies of the resources.");
+      }
+
+      // the serial tasks are run on this thread, in topological order, so that they are run in the same order as a sequential load
+
+      std::vector<std::size_t> rank(total);
+      std::vector<std::size_t> remaining(total);
+
+      for (std::size_t i = 0; i < total; ++i) {
+        rank[to_index(order[i])] = i;
+        const Graph::InEdgeRange in_edges = m_graph.in_edges(order[i]);
+        remaining[to_index(order[i])] = static_cast<std::size_t>(std::distance(in_edges.begin(), in_edges.end()));
+      }
+
+      std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<>> serial_ready;
+
+      std::mutex mutex;
+      std::condition_variable condition;
+      std::vector<VertexId> completed;
+      std::vector<bool> succeeded(total, false);
+      std::exception_ptr error;
+      std::size_t in_flight = 0;
+      std::size_t loaded = 0;
+
+      auto schedule = [&](VertexId vertex) {
+        if (pool == nullptr || !m_tasks[to_index(vertex)].parallel) {
+          serial_ready.push(rank[to_index(vertex)]);
+          return;
+        }
+
+        ++in_flight;
+
+        pool->submit([&, vertex]() {
+          std::exception_ptr exception;
+
+          try {
+            m_tasks[to_index(vertex)].function();
+          } catch (...) {
+            exception = std::current_exception();
+          }
+
+          // notify with the lock held, as the waiting thread may return as soon as it is released
+          const std::scoped_lock<std::mutex> lock(mutex);
+          completed.push_back(vertex);
+
+          if (exception) {
+            if (!error) {
+              error = exception;
+            }
+          } else {
+            succeeded[to_index(vertex)] = true;
+          }
+
+          condition.notify_one();
+        });
+      };
+
+      auto complete = [&](VertexId vertex) {
+        ++loaded;
+
+        if (progress) {
+          // the progress function can stop the plan with an exception
+          try {
+            progress(loaded, total);
+          } catch (...) {
+            const std::scoped_lock<std::mutex> lock(mutex);
+            error = std::current_exception();
+            return;
+          }
+        }
+
+        for (const EdgeId edge : m_graph.out_edges(vertex)) {
+          const VertexId target = m_graph.target(edge);
+          assert(remaining[to_index(target)] > 0);
+
+          if (--remaining[to_index(target)] == 0) {
+            schedule(target);
+          }
+        }
+      };
+
+      auto failed = [&]() {
+        const std::scoped_lock<std::mutex> lock(mutex);
+        return error != nullptr;
+      };
+
+      for (const VertexId vertex : order) {
+        if (remaining[to_index(vertex)] == 0) {
+          schedule(vertex);
+        }
+      }
+
+      for (;;) {
+        if (!serial_ready.empty() && !failed()) {
+          const VertexId vertex = order[serial_ready.top()];
+          serial_ready.pop();
+
+          try {
+            m_tasks[to_index(vertex)].function();
+          } catch (...) {
+            const std::scoped_lock<std::mutex> lock(mutex);
+            error = std::current_exception();
+            continue;
+          }
+
+          succeeded[to_index(vertex)] = true;
+          complete(vertex);
+          continue;
+        }
+
+        if (in_flight == 0) {
+          break;
+        }
+
+        std::vector<VertexId> done;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          condition.wait(lock, [&]() { return !completed.empty(); });
+          done.swap(completed);
+        }
+
+        in_flight -= done.size();
+
+        if (!failed()) {
+          for (const VertexId vertex : done) {
+            complete(vertex);
+          }
+        }
+      }
+
+      if (error) {
+        // the successful tasks are undone in reverse order, so that a failed plan does not load anything
+        for (auto iterator = order.rbegin(); iterator != order.rend(); ++iterator) {
+          const Task& task = m_tasks[to_index(*iterator)];
+
+          if (succeeded[to_index(*iterator)] && task.undo) {
+            task.undo();
+          }
+        }
+
+        std::rethrow_exception(error);
+      }
+
+      assert(loaded == total);
+    }
+
+  } // namespace details
+
   void ResourceBundle::load_from(ResourceManager* manager)
   {
     if (m_callback) {
@@ -12,6 +201,13 @@ namespace gf {
     }
   }
 
+  void ResourceBundle::load_from(ResourceManager* manager, ThreadPool* pool, const ResourceProgress& progress)
+  {
+    details::ResourcePlan plan;
+    plan_into(&plan, manager);
+    plan.run(pool, progress);
+  }
+
   void ResourceBundle::unload_from(ResourceManager* manager)
   {
     if (m_callback) {
@@ -19,4 +215,30 @@ namespace gf {
     }
   }
 
+  std::vector<VertexId> ResourceBundle::plan_into(details::ResourcePlan* plan, ResourceManager* manager)
+  {
+    const std::size_t first = plan->task_count();
+
+    if (m_callback) {
+      m_plan = plan;
+
+      try {
+        m_callback(this, manager, ResourceAction::Load);
+      } catch (...) {
+        m_plan = nullptr;
+        throw;
+      }
+
+      m_plan = nullptr;
+    }
+
+    std::vector<VertexId> vertices;
+
+    for (std::size_t i = first; i < plan->task_count(); ++i) {
+      vertices.push_back(VertexId{ i });
+    }
+
+    return vertices;
+  }
+
 } // namespace gf
@@ -5,7 +5,11 @@
 
 #include <cassert>
 
+#include <mutex>
+#include <system_error>
+
 #include <gf2/core/Log.h>
+#include <gf2/core/ThreadPool.h>
 
 namespace gf {
 
@@ -13,6 +17,26 @@ namespace gf {
    * FileLoader
    */
 
+  namespace {
+
+    void collect_files(const std::filesystem::path& directory, const std::filesystem::path& base, std::vector<std::string>& files)
+    {
+      std::error_code error;
+      std::filesystem::recursive_directory_iterator iterator(directory, std::filesystem::directory_options::follow_directory_symlink | std::filesystem::directory_options::skip_permission_denied, error);
+
+      for (; !error && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error)) {
+        if (iterator->is_regular_file(error)) {
+          files.push_back(iterator->path().lexically_relative(base).generic_string());
+        }
+      }
+
+      if (error) {
+        Log::warning("Could not index directory '{}': {}", directory.string(), error.message());
+      }
+    }
+
+  } // namespace
+
   void FileLoader::add_search_directory(std::filesystem::path directory)
   {
     if (!directory.is_absolute()) {
@@ -27,18 +51,36 @@ namespace gf {
     }
 
     Log::info("Added a new search directory: '{}'", directory.string());
+
+    const std::unique_lock<std::shared_mutex> lock(m_mutex);
     m_search_directories.push_back(std::move(directory));
+
+    if (m_indexed) {
+      index_directory(m_search_directories.back(), m_search_directories.size() - 1);
+    }
   }
 
   std::filesystem::path FileLoader::search(const std::filesystem::path& relative_path)
   {
     assert(relative_path.is_relative());
 
+    const std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    if (m_indexed) {
+      if (auto iterator = m_index.find(relative_path.lexically_normal().generic_string()); iterator != m_index.end()) {
+        const std::filesystem::path& base = m_search_directories[iterator->second];
+        Log::debug("Found a resource file ['{}']: '{}'", base.string(), relative_path.string());
+        return base / relative_path;
+      }
+
+      return {};
+    }
+
     for (const std::filesystem::path& base : m_search_directories) {
       std::filesystem::path absolute_path = base / relative_path;
 
       if (std::filesystem::is_regular_file(absolute_path)) {
-        Log::info("Found a resource file ['{}']: '{}'", base.string(), relative_path.string());
+        Log::debug("Found a resource file ['{}']: '{}'", base.string(), relative_path.string());
         return absolute_path;
       }
     }
@@ -46,6 +88,88 @@ namespace gf {
     return {};
   }
 
+  void FileLoader::enable_index(ThreadPool* pool)
+  {
+    {
+      const std::unique_lock<std::shared_mutex> lock(m_mutex);
+      m_indexed = true;
+      m_pool = pool;
+    }
+
+    refresh_index();
+  }
+
+  void FileLoader::refresh_index()
+  {
+    const std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+    if (!m_indexed) {
+      return;
+    }
+
+    m_index.clear();
+
+    // the directories are indexed in order, so that a file in a former directory hides the same file in a latter directory
+    for (std::size_t i = 0; i < m_search_directories.size(); ++i) {
+      index_directory(m_search_directories[i], i);
+    }
+  }
+
+  bool FileLoader::indexed() const
+  {
+    const std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_indexed;
+  }
+
+  void FileLoader::set_asset_cache(AssetCache* cache)
+  {
+    const std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_asset_cache = cache;
+  }
+
+  AssetCache* FileLoader::asset_cache() const
+  {
+    const std::shared_lock<std::shared_mutex> lock(m_mutex);
+    return m_asset_cache;
+  }
+
+  void FileLoader::index_directory(const std::filesystem::path& directory, std::size_t directory_index)
+  {
+    // the files at the top level are indexed directly, the subdirectories are walked in parallel
+
+    std::vector<std::string> files;
+    std::vector<std::filesystem::path> subdirectories;
+
+    std::error_code error;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+      if (entry.is_directory(error)) {
+        subdirectories.push_back(entry.path());
+      } else if (entry.is_regular_file(error)) {
+        files.push_back(entry.path().lexically_relative(directory).generic_string());
+      }
+    }
+
+    std::vector<std::vector<std::string>> subdirectory_files(subdirectories.size());
+
+    parallel_for(m_pool, 0, static_cast<int>(subdirectories.size()), [&](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        collect_files(subdirectories[i], directory, subdirectory_files[i]);
+      }
+    });
+
+    subdirectory_files.push_back(std::move(files));
+    std::size_t count = 0;
+
+    for (const std::vector<std::string>& some_files : subdirectory_files) {
+      for (const std::string& file : some_files) {
+        count += m_index.emplace(file, directory_index).second ? 1 : 0;
+      }
+    }
+
+    Log::info("Indexed {} files in search directory '{}'", count, directory.string());
+  }
+
   /*
    * MemoryLoader
    */
@@ -79,4 +203,28 @@ namespace gf {
     return m_tarball.extract(relative_path);
   }
 
+  Span<const uint8_t> TarballLoader::search_view(const std::filesystem::path& relative_path) const
+  {
+    return m_tarball.extract_view(relative_path);
+  }
+
+  /*
+   * PackLoader
+   */
+
+  PackLoader::PackLoader(const std::filesystem::path& pack_path)
+  : m_pack(pack_path)
+  {
+  }
+
+  std::vector<uint8_t> PackLoader::search(const std::filesystem::path& relative_path) const
+  {
+    return m_pack.extract(relative_path);
+  }
+
+  Span<const uint8_t> PackLoader::search_view(const std::filesystem::path& relative_path) const
+  {
+    return m_pack.extract_view(relative_path);
+  }
+
 } // namespace gf
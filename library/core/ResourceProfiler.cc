@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/ResourceProfiler.h>
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+
+#include <fmt/format.h>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/Streams.h>
+
+namespace gf {
+
+  namespace {
+
+    thread_local details::ResourceLoadProbe* current_probe = nullptr; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+    std::string escape_json(std::string_view string)
+    {
+      std::string escaped;
+      escaped.reserve(string.size());
+
+      for (const char c : string) {
+        switch (c) {
+          case '"':
+            escaped += "\\\"";
+            break;
+          case '\\':
+            escaped += "\\\\";
+            break;
+          case '\n':
+            escaped += "\\n";
+            break;
+          case '\t':
+            escaped += "\\t";
+            break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+              fmt::format_to(std::back_inserter(escaped), "\\u{:04x}", static_cast<unsigned>(c));
+            } else {
+              escaped += c;
+            }
+            break;
+        }
+      }
+
+      return escaped;
+    }
+
+    std::string create_json_report(const std::vector<ResourceLoadRecord>& records, Time total_load_time, std::size_t cache_hit_count)
+    {
+      std::string report;
+      auto output = std::back_inserter(report);
+
+      fmt::format_to(output, "{{\n  \"load_count\": {},\n  \"cache_hit_count\": {},\n  \"total_load_time_us\": {},\n  \"loads\": [", records.size(), cache_hit_count, total_load_time.as_microseconds());
+
+      for (std::size_t i = 0; i < records.size(); ++i) {
+        const ResourceLoadRecord& record = records[i];
+        fmt::format_to(output, "{}\n    {{ \"path\": \"{}\", \"thread\": {}, \"start_us\": {}, \"wall_time_us\": {}, \"decode_time_us\": {}, \"bytes_read\": {}, \"cache_hit\": {}, \"depth\": {} }}", i == 0 ? "" : ",", escape_json(record.path), record.thread, record.start.as_microseconds(), record.wall_time.as_microseconds(), record.decode_time.as_microseconds(), record.bytes_read, record.cache_hit, record.depth);
+      }
+
+      report += "\n  ]\n}\n";
+      return report;
+    }
+
+    // see the Trace Event Format, the loads are complete events that can be displayed in chrome://tracing or Perfetto
+    std::string create_chrome_trace(const std::vector<ResourceLoadRecord>& records)
+    {
+      std::string trace;
+      auto output = std::back_inserter(trace);
+
+      trace += "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+
+      for (std::size_t i = 0; i < records.size(); ++i) {
+        const ResourceLoadRecord& record = records[i];
+        fmt::format_to(output, "{}\n    {{ \"name\": \"{}\", \"cat\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {}, \"dur\": {}, \"args\": {{ \"decode_time_us\": {}, \"bytes_read\": {} }} }}", i == 0 ? "" : ",", escape_json(record.path), record.cache_hit ? "cache" : "load", record.thread, record.start.as_microseconds(), record.wall_time.as_microseconds(), record.decode_time.as_microseconds(), record.bytes_read);
+      }
+
+      trace += "\n  ]\n}\n";
+      return trace;
+    }
+
+  } // namespace
+
+  namespace details {
+
+    /*
+     * ResourceLoadProbe
+     */
+
+    ResourceLoadProbe::ResourceLoadProbe(ResourceProfiler* profiler)
+    {
+      if (profiler == nullptr || !profiler->enabled()) {
+        return;
+      }
+
+      m_profiler = profiler;
+      m_previous = current_probe;
+      m_record.start = profiler->elapsed_time();
+      m_record.depth = m_previous != nullptr ? m_previous->m_record.depth + 1 : 0;
+      current_probe = this;
+    }
+
+    ResourceLoadProbe::~ResourceLoadProbe()
+    {
+      if (m_profiler != nullptr) {
+        current_probe = m_previous;
+      }
+    }
+
+    void ResourceLoadProbe::set_cache_hit()
+    {
+      m_record.cache_hit = true;
+    }
+
+    void ResourceLoadProbe::finish(std::string path)
+    {
+      if (m_profiler == nullptr) {
+        return;
+      }
+
+      m_record.path = std::move(path);
+      m_record.wall_time = m_clock.elapsed_time();
+      m_profiler->record(std::move(m_record));
+    }
+
+    void ResourceLoadProbe::add_bytes_read(std::size_t bytes)
+    {
+      if (current_probe != nullptr) {
+        current_probe->m_record.bytes_read += bytes;
+      }
+    }
+
+    void ResourceLoadProbe::add_file_read(const std::filesystem::path& path)
+    {
+      if (current_probe != nullptr) {
+        std::error_code error;
+
+        if (const std::uintmax_t size = std::filesystem::file_size(path, error); !error) {
+          current_probe->m_record.bytes_read += static_cast<std::size_t>(size);
+        }
+      }
+    }
+
+    void ResourceLoadProbe::add_decode_time(Time time)
+    {
+      if (current_probe != nullptr) {
+        current_probe->m_record.decode_time += time;
+      }
+    }
+
+  } // namespace details
+
+  /*
+   * ResourceProfiler
+   */
+
+  ResourceProfiler::~ResourceProfiler()
+  {
+    if (m_report_file.empty()) {
+      return;
+    }
+
+    try {
+      save_report(m_report_file, m_report_format);
+    } catch (const std::exception& exception) {
+      Log::error("Could not save the resource report: {}", exception.what());
+    }
+  }
+
+  void ResourceProfiler::set_enabled(bool enabled)
+  {
+    m_enabled = enabled;
+  }
+
+  bool ResourceProfiler::enabled() const
+  {
+    return m_enabled;
+  }
+
+  void ResourceProfiler::set_report_file(std::filesystem::path filename, ResourceReportFormat format)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    m_report_file = std::move(filename);
+    m_report_format = format;
+  }
+
+  void ResourceProfiler::record(ResourceLoadRecord record)
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    auto [iterator, inserted] = m_threads.emplace(std::this_thread::get_id(), static_cast<uint32_t>(m_threads.size()));
+    record.thread = iterator->second;
+    m_records.push_back(std::move(record));
+  }
+
+  Time ResourceProfiler::elapsed_time() const
+  {
+    return m_clock.elapsed_time();
+  }
+
+  std::vector<ResourceLoadRecord> ResourceProfiler::records() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_records;
+  }
+
+  std::vector<ResourceLoadRecord> ResourceProfiler::slowest(std::size_t count) const
+  {
+    std::vector<ResourceLoadRecord> records = this->records();
+    count = std::min(count, records.size());
+
+    std::partial_sort(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(count), records.end(), [](const ResourceLoadRecord& lhs, const ResourceLoadRecord& rhs) {
+      return lhs.wall_time.as_duration() > rhs.wall_time.as_duration();
+    });
+
+    records.resize(count);
+    return records;
+  }
+
+  std::size_t ResourceProfiler::record_count() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return m_records.size();
+  }
+
+  std::size_t ResourceProfiler::cache_hit_count() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return static_cast<std::size_t>(std::count_if(m_records.begin(), m_records.end(), [](const ResourceLoadRecord& record) { return record.cache_hit; }));
+  }
+
+  Time ResourceProfiler::total_load_time() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    Time total;
+
+    // a nested load is already part of the wall time of the enclosing load
+    for (const ResourceLoadRecord& record : m_records) {
+      if (!record.cache_hit && record.depth == 0) {
+        total += record.wall_time;
+      }
+    }
+
+    return total;
+  }
+
+  void ResourceProfiler::clear()
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    m_records.clear();
+  }
+
+  void ResourceProfiler::save_report(const std::filesystem::path& filename, ResourceReportFormat format) const
+  {
+    std::string report;
+
+    switch (format) {
+      case ResourceReportFormat::Json:
+        report = create_json_report(records(), total_load_time(), cache_hit_count());
+        break;
+      case ResourceReportFormat::ChromeTrace:
+        report = create_chrome_trace(records());
+        break;
+    }
+
+    FileOutputStream stream(filename);
+    stream.write(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(report.data()), report.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+} // namespace gf
@@ -2,3 +2,15 @@
 // Copyright (c) 2023-2025 Julien Bernard
 
 #include <gf2/core/ResourceRegistry.h>
+
+#include <cassert>
+
+namespace gf {
+
+  Id resource_key(const std::filesystem::path& path)
+  {
+    assert(path.is_relative());
+    return hash_string(path.lexically_normal().generic_string());
+  }
+
+} // namespace gf
@@ -9,6 +9,7 @@
 #include <limits>
 
 #include <gf2/core/Log.h>
+#include <gf2/core/Streams.h>
 
 namespace gf {
 
@@ -37,7 +38,17 @@ namespace gf {
   , m_version(version)
   {
     assert(m_stream != nullptr);
-    m_stream->write(Magic);
+    write_bytes(Magic);
+    write_big_endian_16(version);
+  }
+
+  Serializer::Serializer(BufferedOutputStream* stream, uint16_t version)
+  : m_stream(stream)
+  , m_buffered(stream)
+  , m_version(version)
+  {
+    assert(m_stream != nullptr);
+    write_bytes(Magic);
     write_big_endian_16(version);
   }
 
@@ -112,7 +123,7 @@ namespace gf {
     write_raw_size(size);
 
     if (size > 0) {
-      m_stream->write(gf::span(reinterpret_cast<const uint8_t*>(data), size)); // NOLINT
+      write_bytes(gf::span(reinterpret_cast<const uint8_t*>(data), size)); // NOLINT
     }
   }
 
@@ -179,7 +190,7 @@ namespace gf {
     auto size = static_cast<uint64_t>(raw_size);
 
     if (size < 0xFF) {
-      m_stream->write(static_cast<uint8_t>(size));
+      write_big_endian_8(static_cast<uint8_t>(size));
       return;
     }
 
@@ -229,13 +240,20 @@ namespace gf {
     write_transformed_integer<8>(m_stream, size);
   }
 
+  void Serializer::write_raw_bytes(Span<const uint8_t> bytes)
+  {
+    if (!bytes.empty()) {
+      write_bytes(bytes);
+    }
+  }
+
   void Serializer::write_big_endian_64(uint64_t data)
   {
     static constexpr std::size_t Size = sizeof(data);
 
     uint8_t buf[Size];
     write_integer(data, buf);
-    m_stream->write(buf);
+    write_bytes(buf);
   }
 
   void Serializer::write_big_endian_32(uint32_t data)
@@ -244,7 +262,7 @@ namespace gf {
 
     uint8_t buf[Size];
     write_integer(data, buf);
-    m_stream->write(buf);
+    write_bytes(buf);
   }
 
   void Serializer::write_big_endian_16(uint16_t data)
@@ -253,12 +271,21 @@ namespace gf {
 
     uint8_t buf[Size];
     write_integer(data, buf);
-    m_stream->write(buf);
+    write_bytes(buf);
   }
 
   void Serializer::write_big_endian_8(uint8_t data)
   {
-    m_stream->write(data);
+    write_bytes(Span<const uint8_t>(&data, 1));
+  }
+
+  void Serializer::write_bytes(Span<const uint8_t> bytes)
+  {
+    if (m_buffered != nullptr) {
+      m_buffered->write(bytes); // non-virtual, inlined
+    } else {
+      m_stream->write(bytes);
+    }
   }
 
   /*
@@ -270,7 +297,22 @@ namespace gf {
   {
     assert(m_stream != nullptr);
     uint8_t magic[2] = { 0u, 0u };
-    m_stream->read(magic);
+    read_bytes(magic);
+
+    if (magic[0] != Magic[0] || magic[1] != Magic[1]) {
+      Log::fatal("The stream is not a gf archive.");
+    }
+
+    read_big_endian_16(&m_version);
+  }
+
+  Deserializer::Deserializer(BufferedInputStream* stream)
+  : m_stream(stream)
+  , m_buffered(stream)
+  {
+    assert(m_stream != nullptr);
+    uint8_t magic[2] = { 0u, 0u };
+    read_bytes(magic);
 
     if (magic[0] != Magic[0] || magic[1] != Magic[1]) {
       Log::fatal("The stream is not a gf archive.");
@@ -378,7 +420,7 @@ namespace gf {
   {
     assert(data != nullptr);
 
-    if (m_stream->read(gf::span(reinterpret_cast<uint8_t*>(data), size)) != size) { // NOLINT
+    if (read_bytes(gf::span(reinterpret_cast<uint8_t*>(data), size)) != size) { // NOLINT
       Log::fatal("End of stream while reading string.");
     }
   }
@@ -455,13 +497,20 @@ namespace gf {
     *raw_size = static_cast<std::size_t>(size);
   }
 
+  void Deserializer::read_raw_bytes(Span<uint8_t> bytes)
+  {
+    if (!bytes.empty() && read_bytes(bytes) != bytes.size()) {
+      Log::fatal("End of stream while reading {} bytes.", bytes.size());
+    }
+  }
+
   void Deserializer::read_big_endian_64(uint64_t* data)
   {
     assert(data != nullptr);
     static constexpr std::size_t Size = sizeof(*data);
     uint8_t buf[Size];
 
-    if (m_stream->read(buf) != Size) {
+    if (read_bytes(buf) != Size) {
       Log::fatal("End of stream while reading 8 bytes.");
     }
 
@@ -474,7 +523,7 @@ namespace gf {
     static constexpr std::size_t Size = sizeof(*data);
     uint8_t buf[Size];
 
-    if (m_stream->read(buf) != Size) { // Flawfinder: ignore
+    if (read_bytes(buf) != Size) { // Flawfinder: ignore
       Log::fatal("End of stream while reading 4 bytes.");
     }
 
@@ -487,7 +536,7 @@ namespace gf {
     static constexpr std::size_t Size = sizeof(*data);
     uint8_t buf[Size];
 
-    if (m_stream->read(buf) != Size) {
+    if (read_bytes(buf) != Size) {
       Log::fatal("End of stream while reading 2 bytes.");
     }
 
@@ -497,9 +546,18 @@ namespace gf {
   void Deserializer::read_big_endian_8(uint8_t* data)
   {
     assert(data != nullptr);
-    if (m_stream->read(*data) != 1) {
+    if (read_bytes(Span<uint8_t>(data, 1)) != 1) {
       Log::fatal("End of stream while reading 1 byte.");
     }
   }
 
+  std::size_t Deserializer::read_bytes(Span<uint8_t> bytes)
+  {
+    if (m_buffered != nullptr) {
+      return m_buffered->read(bytes); // non-virtual, inlined
+    }
+
+    return m_stream->read(bytes);
+  }
+
 } // namespace gf
@@ -7,6 +7,11 @@ namespace gf {
 
   InputStream::~InputStream() = default;
 
+  Span<const uint8_t> InputStream::view()
+  {
+    return {};
+  }
+
   OutputStream::~OutputStream() = default;
 
 } // namespace gf
@@ -6,11 +6,28 @@
 #include <cassert>
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <string>
 #include <utility>
 
+#ifdef _WIN32
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #include <gf2/core/Log.h>
 
+#include "bits/DeflateBlocks.h"
+#include "bits/InflateWindow.h"
+
 namespace gf {
 
   /*
@@ -137,20 +154,232 @@ namespace gf {
     return m_offset == m_memory.size();
   }
 
+  Span<const uint8_t> MemoryInputStream::view()
+  {
+    return { m_memory.data() + m_offset, m_memory.size() - m_offset };
+  }
+
+  /*
+   * MappedFileInputStream
+   */
+
+  MappedFileInputStream::MappedFileInputStream(const std::filesystem::path& path)
+  {
+    if (!std::filesystem::is_regular_file(path)) {
+      Log::error("Could not find the following file for mapping: '{}'", path.string());
+      return;
+    }
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+      Log::error("Could not open the following file for mapping: '{}'", path.string());
+      return;
+    }
+
+    LARGE_INTEGER size;
+
+    if (GetFileSizeEx(file, &size) == 0) {
+      Log::error("Could not get the size of the following file: '{}'", path.string());
+      CloseHandle(file);
+      return;
+    }
+
+    m_file = file;
+
+    if (size.QuadPart == 0) {
+      return; // an empty file can not be mapped, keep an empty view
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr) {
+      Log::error("Could not map the following file: '{}'", path.string());
+      unmap();
+      return;
+    }
+
+    m_mapping = mapping;
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+      Log::error("Could not map the following file: '{}'", path.string());
+      unmap();
+      return;
+    }
+
+    m_data = static_cast<const uint8_t*>(data);
+    m_size = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1) {
+      Log::error("Could not open the following file for mapping: '{}'", path.string());
+      return;
+    }
+
+    struct stat info = {};
+
+    if (::fstat(fd, &info) == -1) {
+      Log::error("Could not get the size of the following file: '{}'", path.string());
+      ::close(fd);
+      return;
+    }
+
+    if (info.st_size > 0) {
+      void* data = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+      if (data == MAP_FAILED) {
+        Log::error("Could not map the following file: '{}'", path.string());
+      } else {
+        m_data = static_cast<const uint8_t*>(data);
+        m_size = static_cast<std::size_t>(info.st_size);
+      }
+    }
+
+    // the mapping stays valid after the file descriptor is closed
+    ::close(fd);
+#endif
+  }
+
+  MappedFileInputStream::MappedFileInputStream(MappedFileInputStream&& other) noexcept
+  : m_data(std::exchange(other.m_data, nullptr))
+  , m_size(std::exchange(other.m_size, 0))
+  , m_offset(std::exchange(other.m_offset, 0))
+#ifdef _WIN32
+  , m_file(std::exchange(other.m_file, nullptr))
+  , m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+  {
+  }
+
+  MappedFileInputStream::~MappedFileInputStream()
+  {
+    unmap();
+  }
+
+  MappedFileInputStream& MappedFileInputStream::operator=(MappedFileInputStream&& other) noexcept
+  {
+    if (this != &other) {
+      unmap();
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+      m_offset = std::exchange(other.m_offset, 0);
+#ifdef _WIN32
+      m_file = std::exchange(other.m_file, nullptr);
+      m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+
+    return *this;
+  }
+
+  Span<const uint8_t> MappedFileInputStream::read_span(std::size_t size)
+  {
+    const std::size_t count = std::min(size, m_size - m_offset);
+    Span<const uint8_t> span(m_data + m_offset, count);
+    m_offset += count;
+    return span;
+  }
+
+  std::size_t MappedFileInputStream::read(Span<uint8_t> buffer)
+  {
+    const Span<const uint8_t> span = read_span(buffer.size());
+
+    if (!span.empty()) {
+      std::copy_n(span.data(), span.size(), buffer.data());
+    }
+
+    return span.size();
+  }
+
+  void MappedFileInputStream::seek(std::ptrdiff_t position)
+  {
+    if (position < 0) {
+      return;
+    }
+
+    auto offset = static_cast<std::size_t>(position);
+    m_offset = std::min(offset, m_size);
+  }
+
+  void MappedFileInputStream::skip(std::ptrdiff_t position)
+  {
+    if (position < 0) {
+      auto offset = static_cast<std::size_t>(-position);
+      m_offset = offset < m_offset ? m_offset - offset : 0;
+    } else {
+      auto offset = static_cast<std::size_t>(position);
+      m_offset = std::min(m_offset + offset, m_size);
+    }
+  }
+
+  bool MappedFileInputStream::finished()
+  {
+    return m_offset == m_size;
+  }
+
+  Span<const uint8_t> MappedFileInputStream::view()
+  {
+    return { m_data + m_offset, m_size - m_offset };
+  }
+
+  void MappedFileInputStream::unmap()
+  {
+#ifdef _WIN32
+    if (m_data != nullptr) {
+      UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr) {
+      CloseHandle(static_cast<HANDLE>(m_mapping));
+    }
+
+    if (m_file != nullptr) {
+      CloseHandle(static_cast<HANDLE>(m_file));
+    }
+
+    m_file = nullptr;
+    m_mapping = nullptr;
+#else
+    if (m_data != nullptr) {
+      ::munmap(const_cast<uint8_t*>(m_data), m_size); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_offset = 0;
+  }
+
   /*
    * CompressedInputStream
    */
 
-  CompressedInputStream::CompressedInputStream(InputStream* compressed)
+  /*
+   * A forward skip decompresses the data and discards it. A backward seek
+   * restarts the decompression from the beginning of the compressed stream,
+   * or from the nearest checkpoint if the checkpoint index is enabled (see
+   * details::InflateWindow). In both cases, the compressed stream must support
+   * relative skips.
+   */
+
+  CompressedInputStream::CompressedInputStream(InputStream* compressed, std::size_t checkpoint_span)
   : m_compressed(compressed)
   , m_stream()
   , m_buffer()
+  , m_checkpoint_span(checkpoint_span)
   {
     assert(compressed != nullptr);
     m_stream.zalloc = nullptr;
     m_stream.zfree = nullptr;
-    [[maybe_unused]] const int err = inflateInit(&m_stream);
+    [[maybe_unused]] const int err = inflateInit2(&m_stream, 15 + 32); // allow to decode gzip and zlib format
     assert(err == Z_OK); // throw?
+
+    if (m_checkpoint_span > 0) {
+      m_window = std::make_unique<details::InflateWindow>();
+    }
   }
 
   CompressedInputStream::CompressedInputStream(CompressedInputStream&& other) noexcept
@@ -160,6 +389,11 @@ namespace gf {
   , m_stop(other.m_stop)
   , m_eof(std::exchange(other.m_eof, true))
   , m_buffer(other.m_buffer)
+  , m_position(other.m_position)
+  , m_compressed_position(other.m_compressed_position)
+  , m_checkpoint_span(std::exchange(other.m_checkpoint_span, 0))
+  , m_window(std::move(other.m_window))
+  , m_checkpoints(std::move(other.m_checkpoints))
   {
     [[maybe_unused]] const int err_copy = inflateCopy(&m_stream, &other.m_stream);
     assert(err_copy == Z_OK);
@@ -188,6 +422,11 @@ namespace gf {
     m_stop = other.m_stop;
     m_eof = std::exchange(other.m_eof, true);
     m_buffer = other.m_buffer;
+    m_position = other.m_position;
+    m_compressed_position = other.m_compressed_position;
+    m_checkpoint_span = std::exchange(other.m_checkpoint_span, 0);
+    m_window = std::move(other.m_window);
+    m_checkpoints = std::move(other.m_checkpoints);
     return *this;
   }
 
@@ -204,38 +443,88 @@ namespace gf {
       if (m_start == m_stop) {
         m_start = 0;
         m_stop = static_cast<uInt>(m_compressed->read(m_buffer));
+        m_compressed_position += m_stop;
       }
 
       const uInt remaining = m_stop - m_start;
+      const uInt available_out = m_stream.avail_out;
 
       m_stream.next_in = m_buffer.data() + m_start;
       m_stream.avail_in = remaining;
-      const int err = inflate(&m_stream, Z_NO_FLUSH);
+      // with the checkpoint index, stop at each block boundary to be able to add a checkpoint
+      const int err = inflate(&m_stream, m_window ? Z_BLOCK : Z_NO_FLUSH);
 
       if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR) {
         Log::debug("Error while calling inflate: {} '{}'\n", err, m_stream.msg);
       }
 
+      const uInt produced = available_out - m_stream.avail_out;
+      m_position += produced;
+      m_start += remaining - m_stream.avail_in;
+
+      if (m_window) {
+        m_window->append(m_stream.next_out - produced, produced);
+      }
+
       if (err == Z_STREAM_END) {
         m_eof = true;
         return buffer.size() - m_stream.avail_out;
       }
 
+      if (err == Z_BUF_ERROR && remaining == 0) {
+        Log::debug("Truncated compressed stream.\n");
+        m_eof = true;
+        return buffer.size() - m_stream.avail_out;
+      }
+
       assert(err == Z_OK || err == Z_STREAM_END || err == Z_BUF_ERROR);
-      m_start += remaining - m_stream.avail_in;
+
+      if (m_window) {
+        const bool end_of_block = (m_stream.data_type & 128) != 0 && (m_stream.data_type & 64) == 0;
+
+        if (end_of_block && (m_checkpoints.empty() || m_position > m_checkpoints.back().position + m_checkpoint_span)) {
+          Checkpoint checkpoint;
+          checkpoint.position = m_position;
+          checkpoint.compressed_position = m_compressed_position - (m_stop - m_start);
+          checkpoint.bits = m_stream.data_type & 7;
+          checkpoint.window = m_window->content();
+          m_checkpoints.push_back(std::move(checkpoint));
+        }
+      }
     }
 
     return buffer.size();
   }
 
-  void CompressedInputStream::seek([[maybe_unused]] std::ptrdiff_t position)
+  void CompressedInputStream::seek(std::ptrdiff_t position)
   {
-    Log::fatal("Not supported");
+    if (position < 0) {
+      return;
+    }
+
+    const auto target = static_cast<uint64_t>(position);
+
+    // find the nearest checkpoint before the target
+    auto iterator = std::ranges::upper_bound(m_checkpoints, target, std::less<>(), &Checkpoint::position);
+    const Checkpoint* checkpoint = iterator == m_checkpoints.begin() ? nullptr : &*std::prev(iterator);
+
+    if (target < m_position) {
+      restart(checkpoint);
+    } else if (checkpoint != nullptr && checkpoint->position > m_position) {
+      restart(checkpoint);
+    }
+
+    discard(target - m_position);
   }
 
-  void CompressedInputStream::skip([[maybe_unused]] std::ptrdiff_t position)
+  void CompressedInputStream::skip(std::ptrdiff_t position)
   {
-    Log::fatal("Not supported");
+    if (position < 0) {
+      auto offset = static_cast<uint64_t>(-position);
+      seek(static_cast<std::ptrdiff_t>(offset < m_position ? m_position - offset : 0));
+    } else {
+      discard(static_cast<uint64_t>(position));
+    }
   }
 
   bool CompressedInputStream::finished()
@@ -243,6 +532,79 @@ namespace gf {
     return m_eof;
   }
 
+  void CompressedInputStream::restart(const Checkpoint* checkpoint)
+  {
+    m_eof = false;
+
+    if (checkpoint == nullptr) {
+      move_compressed_to(0);
+      [[maybe_unused]] const int err = inflateReset2(&m_stream, 15 + 32);
+      assert(err == Z_OK);
+      m_position = 0;
+
+      if (m_window) {
+        m_window->reset();
+      }
+
+      return;
+    }
+
+    [[maybe_unused]] int err = inflateReset2(&m_stream, -15); // raw inflate
+    assert(err == Z_OK);
+
+    if (checkpoint->bits > 0) {
+      move_compressed_to(checkpoint->compressed_position - 1);
+      std::array<uint8_t, 1> byte = {};
+
+      if (m_compressed->read(byte) != byte.size()) {
+        Log::debug("Truncated compressed stream.\n");
+        m_eof = true;
+        return;
+      }
+
+      ++m_compressed_position;
+      err = inflatePrime(&m_stream, checkpoint->bits, byte[0] >> (8 - checkpoint->bits));
+      assert(err == Z_OK);
+    } else {
+      move_compressed_to(checkpoint->compressed_position);
+    }
+
+    if (!checkpoint->window.empty()) {
+      err = inflateSetDictionary(&m_stream, checkpoint->window.data(), static_cast<uInt>(checkpoint->window.size()));
+      assert(err == Z_OK);
+    }
+
+    m_position = checkpoint->position;
+
+    if (m_window) {
+      m_window->reset();
+      m_window->append(checkpoint->window.data(), checkpoint->window.size());
+    }
+  }
+
+  void CompressedInputStream::move_compressed_to(uint64_t compressed_position)
+  {
+    m_compressed->skip(static_cast<std::ptrdiff_t>(compressed_position) - static_cast<std::ptrdiff_t>(m_compressed_position));
+    m_compressed_position = compressed_position;
+    m_start = m_stop = 0;
+  }
+
+  void CompressedInputStream::discard(uint64_t size)
+  {
+    std::array<uint8_t, 4096> scratch = {};
+
+    while (size > 0 && !m_eof) {
+      const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(size, scratch.size()));
+      const std::size_t read_count = read(Span<uint8_t>(scratch.data(), count));
+
+      if (read_count == 0) {
+        break;
+      }
+
+      size -= read_count;
+    }
+  }
+
   /*
    * BufferInputStream
    */
@@ -296,6 +658,88 @@ namespace gf {
     return m_offset == m_bytes->size();
   }
 
+  Span<const uint8_t> BufferInputStream::view()
+  {
+    return { m_bytes->data() + m_offset, m_bytes->size() - m_offset };
+  }
+
+  /*
+   * BufferedInputStream
+   */
+
+  BufferedInputStream::BufferedInputStream(InputStream* stream, std::size_t buffer_size)
+  : m_stream(stream)
+  , m_buffer(std::max(buffer_size, std::size_t(1)))
+  {
+    assert(stream != nullptr);
+  }
+
+  BufferedInputStream::BufferedInputStream(BufferedInputStream&& other) noexcept
+  : m_stream(std::exchange(other.m_stream, nullptr))
+  , m_buffer(std::move(other.m_buffer))
+  , m_start(std::exchange(other.m_start, 0))
+  , m_stop(std::exchange(other.m_stop, 0))
+  {
+  }
+
+  BufferedInputStream::~BufferedInputStream() = default;
+
+  BufferedInputStream& BufferedInputStream::operator=(BufferedInputStream&& other) noexcept
+  {
+    std::swap(m_stream, other.m_stream);
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_start, other.m_start);
+    std::swap(m_stop, other.m_stop);
+    return *this;
+  }
+
+  std::size_t BufferedInputStream::read_and_refill(Span<uint8_t> buffer)
+  {
+    // first, consume what remains in the buffer
+    const std::size_t available = m_stop - m_start;
+    std::copy_n(m_buffer.data() + m_start, available, buffer.data());
+    m_start = m_stop = 0;
+
+    Span<uint8_t> rest(buffer.data() + available, buffer.size() - available);
+
+    if (rest.size() >= m_buffer.size()) {
+      // large reads bypass the buffer
+      return available + m_stream->read(rest);
+    }
+
+    m_stop = m_stream->read(m_buffer);
+    const std::size_t count = std::min(rest.size(), m_stop);
+    std::copy_n(m_buffer.data(), count, rest.data());
+    m_start = count;
+    return available + count;
+  }
+
+  void BufferedInputStream::seek(std::ptrdiff_t position)
+  {
+    m_start = m_stop = 0;
+    m_stream->seek(position);
+  }
+
+  void BufferedInputStream::skip(std::ptrdiff_t position)
+  {
+    const auto start = static_cast<std::ptrdiff_t>(m_start) + position;
+
+    if (start >= 0 && start <= static_cast<std::ptrdiff_t>(m_stop)) {
+      m_start = static_cast<std::size_t>(start);
+      return;
+    }
+
+    // the position of the underlying stream is at the end of the buffer
+    const auto available = static_cast<std::ptrdiff_t>(m_stop - m_start);
+    m_start = m_stop = 0;
+    m_stream->skip(position - available);
+  }
+
+  bool BufferedInputStream::finished()
+  {
+    return m_start == m_stop && m_stream->finished();
+  }
+
   /*
    * HashedInputStream
    */
@@ -426,22 +870,57 @@ namespace gf {
    * CompressedOutputStream
    */
 
-  CompressedOutputStream::CompressedOutputStream(OutputStream* compressed)
+  /*
+   * In parallel mode, the data is split in blocks that are compressed
+   * independently on the thread pool (see details::DeflateBlocks). The header
+   * and the trailer of the zlib or gzip stream are written here, so the result
+   * is a standard stream.
+   */
+
+  namespace {
+
+    constexpr std::array<uint8_t, 2> ZlibHeader = { 0x78, 0x9C }; // deflate, 32K window, default compression
+    constexpr std::array<uint8_t, 10> GzipHeader = { 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF }; // deflate, no flags, no time, unknown OS
+
+  } // namespace
+
+  CompressedOutputStream::CompressedOutputStream(OutputStream* compressed, CompressionFormat format, ThreadPool* pool)
   : m_compressed(compressed)
+  , m_format(format)
   , m_stream()
   , m_buffer()
   {
     assert(compressed != nullptr);
     m_stream.zalloc = nullptr;
     m_stream.zfree = nullptr;
-    [[maybe_unused]] const int err = deflateInit(&m_stream, Z_DEFAULT_COMPRESSION);
+    const int window_bits = format == CompressionFormat::Gzip ? 15 + 16 : 15;
+    [[maybe_unused]] const int err = deflateInit2(&m_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY);
     assert(err == Z_OK);
+
+    if (pool != nullptr) {
+      const auto checksum = format == CompressionFormat::Gzip ? details::DeflateChecksum::Crc32 : details::DeflateChecksum::Adler32;
+      m_blocks = std::make_unique<details::DeflateBlocks>(checksum, pool, [compressed](Span<const uint8_t> bytes) {
+        [[maybe_unused]] const std::size_t flushed = compressed->write(bytes);
+        assert(flushed == bytes.size());
+      });
+
+      if (format == CompressionFormat::Gzip) {
+        m_compressed->write(Span<const uint8_t>(GzipHeader.data(), GzipHeader.size()));
+      } else {
+        m_compressed->write(Span<const uint8_t>(ZlibHeader.data(), ZlibHeader.size()));
+      }
+
+      m_block.reserve(details::DeflateBlocks::BlockSize);
+    }
   }
 
   CompressedOutputStream::CompressedOutputStream(CompressedOutputStream&& other) noexcept
   : m_compressed(other.m_compressed)
+  , m_format(other.m_format)
   , m_stream()
   , m_buffer(other.m_buffer)
+  , m_blocks(std::move(other.m_blocks))
+  , m_block(std::move(other.m_block))
   {
     [[maybe_unused]] const int err_copy = deflateCopy(&m_stream, &other.m_stream);
     assert(err_copy == Z_OK);
@@ -451,6 +930,16 @@ namespace gf {
 
   CompressedOutputStream::~CompressedOutputStream()
   {
+    if (m_blocks) {
+      m_blocks->push(std::exchange(m_block, {}), true);
+      m_blocks->finish();
+      write_trailer();
+
+      [[maybe_unused]] const int err = deflateEnd(&m_stream);
+      assert(err == Z_OK);
+      return;
+    }
+
     const uInt buffer_size = static_cast<uInt>(m_buffer.size());
 
     m_stream.next_in = nullptr;
@@ -491,12 +980,34 @@ namespace gf {
     [[maybe_unused]] const int err_reset = deflateReset(&other.m_stream);
     assert(err_reset == Z_OK);
 
+    m_format = other.m_format;
     m_buffer = other.m_buffer;
+    m_blocks = std::move(other.m_blocks);
+    m_block = std::move(other.m_block);
     return *this;
   }
 
   std::size_t CompressedOutputStream::write(Span<const uint8_t> buffer)
   {
+    if (m_blocks) {
+      const uint8_t* data = buffer.data();
+      std::size_t remaining = buffer.size();
+
+      while (remaining > 0) {
+        const std::size_t count = std::min(remaining, details::DeflateBlocks::BlockSize - m_block.size());
+        m_block.insert(m_block.end(), data, data + count);
+        data += count;
+        remaining -= count;
+
+        if (m_block.size() == details::DeflateBlocks::BlockSize) {
+          m_blocks->push(std::exchange(m_block, {}), false);
+          m_block.reserve(details::DeflateBlocks::BlockSize);
+        }
+      }
+
+      return buffer.size();
+    }
+
     const uInt buffer_size = static_cast<uInt>(m_buffer.size());
 
     m_stream.next_in = buffer.data();
@@ -528,6 +1039,31 @@ namespace gf {
     return m_compressed->written_bytes();
   }
 
+  void CompressedOutputStream::write_trailer()
+  {
+    const uint32_t checksum = m_blocks->checksum();
+    std::array<uint8_t, 8> trailer = {};
+
+    if (m_format == CompressionFormat::Gzip) {
+      // little endian crc32 and size modulo 2^32
+      const auto size = static_cast<uint32_t>(m_blocks->size());
+
+      for (std::size_t i = 0; i < 4; ++i) {
+        trailer[i] = static_cast<uint8_t>(checksum >> (8 * i));
+        trailer[i + 4] = static_cast<uint8_t>(size >> (8 * i));
+      }
+
+      m_compressed->write(Span<const uint8_t>(trailer.data(), 8));
+    } else {
+      // big endian adler32
+      for (std::size_t i = 0; i < 4; ++i) {
+        trailer[i] = static_cast<uint8_t>(checksum >> (8 * (3 - i)));
+      }
+
+      m_compressed->write(Span<const uint8_t>(trailer.data(), 4));
+    }
+  }
+
   /*
    * BufferOutputStream
    */
@@ -549,6 +1085,70 @@ namespace gf {
     return m_bytes->size();
   }
 
+  /*
+   * BufferedOutputStream
+   */
+
+  BufferedOutputStream::BufferedOutputStream(OutputStream* stream, std::size_t buffer_size)
+  : m_stream(stream)
+  , m_buffer(std::max(buffer_size, std::size_t(1)))
+  {
+    assert(stream != nullptr);
+  }
+
+  BufferedOutputStream::BufferedOutputStream(BufferedOutputStream&& other) noexcept
+  : m_stream(std::exchange(other.m_stream, nullptr))
+  , m_buffer(std::move(other.m_buffer))
+  , m_size(std::exchange(other.m_size, 0))
+  {
+  }
+
+  BufferedOutputStream::~BufferedOutputStream()
+  {
+    flush();
+  }
+
+  BufferedOutputStream& BufferedOutputStream::operator=(BufferedOutputStream&& other) noexcept
+  {
+    std::swap(m_stream, other.m_stream);
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_size, other.m_size);
+    return *this;
+  }
+
+  std::size_t BufferedOutputStream::written_bytes() const
+  {
+    if (m_stream == nullptr) {
+      return m_size;
+    }
+
+    return m_stream->written_bytes() + m_size;
+  }
+
+  void BufferedOutputStream::flush()
+  {
+    if (m_stream == nullptr || m_size == 0) {
+      return;
+    }
+
+    m_stream->write(Span<const uint8_t>(m_buffer.data(), m_size));
+    m_size = 0;
+  }
+
+  std::size_t BufferedOutputStream::flush_and_write(Span<const uint8_t> buffer)
+  {
+    flush();
+
+    if (buffer.size() >= m_buffer.size()) {
+      // large writes bypass the buffer
+      return m_stream->write(buffer);
+    }
+
+    std::copy_n(buffer.data(), buffer.size(), m_buffer.data());
+    m_size = buffer.size();
+    return buffer.size();
+  }
+
   /*
    * HashedOutputStream
    */
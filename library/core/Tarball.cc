@@ -4,14 +4,25 @@
 #include <gf2/core/Tarball.h>
 
 #include <cassert>
+#include <cstring>
 
 #include <algorithm>
 #include <array>
+#include <exception>
+#include <functional>
 #include <iterator>
+#include <stdexcept>
 #include <string_view>
 #include <utility>
 
+#include <zlib.h>
+
 #include <gf2/core/Log.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/Streams.h>
+
+#include "bits/InflateWindow.h"
 
 namespace gf {
 
@@ -47,37 +58,99 @@ namespace gf {
 
     static_assert(sizeof(TarRecord) == 512, "Weird record size!");
 
+    /*
+     * Random access in a gzip stream is done like in zran.c from the zlib
+     * examples (see details::InflateWindow): while the archive is scanned, the
+     * state of the decompressor is saved at block boundaries every few
+     * megabytes. An entry is then extracted by restarting the decompression
+     * from the nearest checkpoint.
+     */
+
+    constexpr std::size_t BufferSize = 16 * 1024;
+    constexpr std::size_t WindowSize = details::InflateWindow::Size;
+    constexpr uint64_t CheckpointSpan = 4 * 1024 * 1024;
+
+    constexpr uint16_t TarballIndexVersion = 1;
+    constexpr uint32_t TarballIndexTag = 0x47465449; // 'GFTI'
+
+    bool is_gzip(std::FILE* file)
+    {
+      std::array<uint8_t, 2> magic = {};
+      const std::size_t read = std::fread(magic.data(), sizeof(uint8_t), magic.size(), file);
+      std::rewind(file);
+      return read == magic.size() && magic[0] == 0x1F && magic[1] == 0x8B;
+    }
+
+    void seek(std::FILE* file, uint64_t offset)
+    {
+      std::fseek(file, static_cast<long>(offset), SEEK_SET);
+    }
+
+    struct ArchiveStamp {
+      uint64_t size = 0;
+      int64_t time = 0;
+    };
+
+    ArchiveStamp compute_archive_stamp(const std::filesystem::path& file)
+    {
+      std::error_code error;
+      ArchiveStamp stamp;
+      stamp.size = static_cast<uint64_t>(std::filesystem::file_size(file, error));
+      stamp.time = static_cast<int64_t>(std::filesystem::last_write_time(file, error).time_since_epoch().count());
+      return stamp;
+    }
+
+
   } // namespace
 
   Tarball::Tarball(const std::filesystem::path& file)
+  : m_path(file)
   {
-    m_file = gzopen(file.string().c_str(), "rb");
+    m_file = std::fopen(file.string().c_str(), "rb");
 
     if (m_file == nullptr) {
       Log::warning("Could not open the tarball: '{}'", file.string());
       return;
     }
 
-    read_entries();
+    m_compressed = is_gzip(m_file);
+
+    if (!m_compressed) {
+      m_mapping.emplace(file);
+    }
+
+    if (!load_index()) {
+      read_entries();
+    }
   }
 
   Tarball::Tarball(Tarball&& other) noexcept
-  : m_file(std::exchange(other.m_file, nullptr))
+  : m_path(std::move(other.m_path))
+  , m_file(std::exchange(other.m_file, nullptr))
+  , m_compressed(other.m_compressed)
+  , m_mapping(std::move(other.m_mapping))
   , m_entries(std::move(other.m_entries))
+  , m_entries_by_path(std::move(other.m_entries_by_path))
+  , m_checkpoints(std::move(other.m_checkpoints))
   {
   }
 
   Tarball::~Tarball()
   {
     if (m_file != nullptr) {
-      gzclose(m_file);
+      std::fclose(m_file);
     }
   }
 
   Tarball& Tarball::operator=(Tarball&& other) noexcept
   {
     std::swap(m_file, other.m_file);
+    m_path = std::move(other.m_path);
+    m_compressed = other.m_compressed;
+    m_mapping = std::move(other.m_mapping);
     m_entries = std::move(other.m_entries);
+    m_entries_by_path = std::move(other.m_entries_by_path);
+    m_checkpoints = std::move(other.m_checkpoints);
     return *this;
   }
 
@@ -87,9 +160,25 @@ namespace gf {
       return {};
     }
 
-    for (auto& entry : m_entries) {
-      if (entry.path == path) {
-        return extract_entry(entry);
+    if (auto iterator = m_entries_by_path.find(path.generic_string()); iterator != m_entries_by_path.end()) {
+      return extract_entry(m_entries[iterator->second]);
+    }
+
+    return {};
+  }
+
+  Span<const uint8_t> Tarball::extract_view(const std::filesystem::path& path) const
+  {
+    if (!m_mapping) {
+      return {};
+    }
+
+    if (auto iterator = m_entries_by_path.find(path.generic_string()); iterator != m_entries_by_path.end()) {
+      const Entry& entry = m_entries[iterator->second];
+      const Span<const uint8_t> memory = m_mapping->memory();
+
+      if (entry.offset + entry.size <= memory.size()) {
+        return { memory.data() + entry.offset, entry.size };
       }
     }
 
@@ -103,16 +192,223 @@ namespace gf {
     return entries;
   }
 
+  void Tarball::save_index() const
+  {
+    if (m_file == nullptr) {
+      return;
+    }
+
+    const ArchiveStamp stamp = compute_archive_stamp(m_path);
+
+    FileOutputStream file(index_file(m_path));
+    BufferedOutputStream stream(&file);
+    Serializer ar(&stream, TarballIndexVersion);
+    ar | TarballIndexTag | stamp.size | stamp.time | m_compressed;
+
+    ar | static_cast<uint64_t>(m_entries.size());
+
+    for (const Entry& entry : m_entries) {
+      ar | entry.path | entry.offset | static_cast<uint64_t>(entry.size);
+    }
+
+    ar | static_cast<uint64_t>(m_checkpoints.size());
+
+    for (const Checkpoint& checkpoint : m_checkpoints) {
+      ar | checkpoint.position | checkpoint.compressed_position | static_cast<uint8_t>(checkpoint.bits) | static_cast<uint64_t>(checkpoint.window.size());
+    }
+
+    // the windows are written at once at the end
+    for (const Checkpoint& checkpoint : m_checkpoints) {
+      stream.write(checkpoint.window);
+    }
+  }
+
+  std::filesystem::path Tarball::index_file(const std::filesystem::path& file)
+  {
+    std::filesystem::path index = file;
+    index += ".index";
+    return index;
+  }
+
+  bool Tarball::load_index()
+  {
+    const std::filesystem::path index = index_file(m_path);
+
+    if (!std::filesystem::is_regular_file(index)) {
+      return false;
+    }
+
+    try {
+      FileInputStream file(index);
+      BufferedInputStream stream(&file);
+      Deserializer ar(&stream);
+
+      uint32_t tag = 0;
+      ArchiveStamp stamp;
+      bool compressed = false;
+      ar | tag | stamp.size | stamp.time | compressed;
+
+      const ArchiveStamp expected = compute_archive_stamp(m_path);
+
+      if (ar.version() != TarballIndexVersion || tag != TarballIndexTag || stamp.size != expected.size || stamp.time != expected.time || compressed != m_compressed) {
+        return false;
+      }
+
+      uint64_t entry_count = 0;
+      ar | entry_count;
+
+      for (uint64_t i = 0; i < entry_count; ++i) {
+        Entry entry;
+        uint64_t size = 0;
+        ar | entry.path | entry.offset | size;
+        entry.size = static_cast<std::size_t>(size);
+        add_entry(std::move(entry));
+      }
+
+      uint64_t checkpoint_count = 0;
+      ar | checkpoint_count;
+      m_checkpoints.resize(static_cast<std::size_t>(checkpoint_count));
+
+      for (Checkpoint& checkpoint : m_checkpoints) {
+        uint8_t bits = 0;
+        uint64_t window_size = 0;
+        ar | checkpoint.position | checkpoint.compressed_position | bits | window_size;
+        checkpoint.bits = bits;
+        checkpoint.window.resize(std::min(static_cast<std::size_t>(window_size), WindowSize));
+      }
+
+      for (Checkpoint& checkpoint : m_checkpoints) {
+        if (stream.read(checkpoint.window) != checkpoint.window.size()) {
+          throw std::runtime_error("Truncated index.");
+        }
+      }
+
+      // the entries of a compressed archive can not be extracted without checkpoints
+      if (m_compressed && m_checkpoints.empty()) {
+        throw std::runtime_error("No checkpoint.");
+      }
+    } catch (std::exception& ex) {
+      // the entries already read must not be added again by the scan of the archive
+      Log::warning("Invalid index for tarball '{}': {}", m_path.string(), ex.what());
+      m_entries.clear();
+      m_entries_by_path.clear();
+      m_checkpoints.clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  void Tarball::add_entry(Entry entry)
+  {
+    m_entries_by_path.emplace(entry.path.generic_string(), m_entries.size());
+    m_entries.push_back(std::move(entry));
+  }
+
   // format description: https://pubs.opengroup.org/onlinepubs/9699919799/utilities/pax.html#tag_20_92_13_06
   void Tarball::read_entries()
   {
     assert(m_file != nullptr);
 
-    while (gzeof(m_file) == 0) {
+    z_stream stream = {};
+
+    if (m_compressed) {
+      // automatic detection of the gzip header
+      [[maybe_unused]] const int err = inflateInit2(&stream, 32 + 15);
+      assert(err == Z_OK);
+    }
+
+    std::vector<uint8_t> input(BufferSize);
+    details::InflateWindow window;
+    uint64_t position = 0;
+    uint64_t compressed_position = 0;
+    bool finished = false;
+
+    auto read = [&](uint8_t* data, std::size_t size) -> std::size_t {
+      if (!m_compressed) {
+        const std::size_t read = std::fread(data, sizeof(uint8_t), size, m_file);
+        position += read;
+        return read;
+      }
+
+      std::size_t total = 0;
+
+      while (total < size && !finished) {
+        if (stream.avail_in == 0) {
+          stream.avail_in = static_cast<uInt>(std::fread(input.data(), sizeof(uint8_t), input.size(), m_file));
+          stream.next_in = input.data();
+
+          if (stream.avail_in == 0) {
+            finished = true;
+            break;
+          }
+        }
+
+        const uInt available_in = stream.avail_in;
+        const auto available_out = static_cast<uInt>(size - total);
+        stream.next_out = data + total;
+        stream.avail_out = available_out;
+
+        // stop at each block boundary to be able to add a checkpoint
+        const int err = inflate(&stream, Z_BLOCK);
+
+        const std::size_t produced = available_out - stream.avail_out;
+        compressed_position += available_in - stream.avail_in;
+        window.append(data + total, produced);
+        position += produced;
+        total += produced;
+
+        if (err == Z_STREAM_END) {
+          finished = true;
+          break;
+        }
+
+        if (err != Z_OK && err != Z_BUF_ERROR) {
+          Log::error("Corrupted tarball: '{}'", m_path.string());
+          finished = true;
+          break;
+        }
+
+        const bool end_of_block = (stream.data_type & 128) != 0 && (stream.data_type & 64) == 0;
+
+        if (end_of_block && (m_checkpoints.empty() || position - m_checkpoints.back().position > CheckpointSpan)) {
+          Checkpoint checkpoint;
+          checkpoint.position = position;
+          checkpoint.compressed_position = compressed_position;
+          checkpoint.bits = stream.data_type & 7;
+          checkpoint.window = window.content();
+          m_checkpoints.push_back(std::move(checkpoint));
+        }
+      }
+
+      return total;
+    };
+
+    std::vector<uint8_t> skipped(BufferSize);
+
+    auto skip = [&](uint64_t size) {
+      if (!m_compressed) {
+        position += size;
+        seek(m_file, position);
+        return;
+      }
+
+      while (size > 0) {
+        const std::size_t read_size = read(skipped.data(), static_cast<std::size_t>(std::min<uint64_t>(size, skipped.size())));
+
+        if (read_size == 0) {
+          break;
+        }
+
+        size -= read_size;
+      }
+    };
+
+    for (;;) {
       TarRecord record = {};
-      const std::size_t read = gzfread(&record, sizeof(uint8_t), sizeof(TarRecord), m_file);
+      const std::size_t read_size = read(record.data.data(), record.data.size());
 
-      if (read == 0) {
+      if (read_size < record.data.size()) {
         break;
       }
 
@@ -134,28 +430,33 @@ namespace gf {
         size = (size * 8) + (c - '0');
       }
 
+      const std::size_t record_count = (size + 511) / 512;
+
       if (record.header.typeflag != '0' && record.header.typeflag != 0) {
         // not a file
-        assert(size == 0);
+        skip(record_count * sizeof(TarRecord));
         continue;
       }
 
       Entry entry;
 
       if (record.header.prefix[0] == '\0') {
-        entry.path = record.header.name;
+        entry.path = std::string(record.header.name, strnlen(record.header.name, sizeof(record.header.name)));
       } else {
-        entry.path = record.header.prefix;
-        entry.path /= record.header.name;
+        entry.path = std::string(record.header.prefix, strnlen(record.header.prefix, sizeof(record.header.prefix)));
+        entry.path /= std::string(record.header.name, strnlen(record.header.name, sizeof(record.header.name)));
       }
 
-      entry.offset = gztell(m_file);
+      entry.offset = position;
       assert(entry.offset % sizeof(TarRecord) == 0);
       entry.size = size;
-      m_entries.push_back(std::move(entry));
+      add_entry(std::move(entry));
 
-      const std::size_t record_count = (size + 511) / 512;
-      gzseek(m_file, static_cast<long>(record_count * sizeof(TarRecord)), SEEK_CUR);
+      skip(record_count * sizeof(TarRecord));
+    }
+
+    if (m_compressed) {
+      inflateEnd(&stream);
     }
   }
 
@@ -163,19 +464,103 @@ namespace gf {
   {
     assert(m_file != nullptr);
 
-    std::vector<uint8_t> content;
-    content.reserve(entry.size);
+    std::vector<uint8_t> content(entry.size);
+
+    if (!m_compressed && m_mapping && entry.offset + entry.size <= m_mapping->memory().size()) {
+      std::copy_n(m_mapping->memory().data() + entry.offset, entry.size, content.data());
+      return content;
+    }
+
+    // the position of the file is shared, so the reads of concurrent extractions must not interleave
+    const std::scoped_lock<std::mutex> lock(m_file_mutex);
 
-    gzseek(m_file, entry.offset, SEEK_SET);
-    std::array<uint8_t, 512> buffer = {};
-    std::size_t size = 0;
+    if (!m_compressed) {
+      seek(m_file, entry.offset);
 
-    while (gzeof(m_file) == 0 && size < entry.size) {
-      const std::size_t wanted = std::min(buffer.size(), entry.size - size);
-      const std::size_t read = gzfread(buffer.data(), sizeof(uint8_t), wanted, m_file);
-      assert(read == wanted);
-      content.insert(content.end(), buffer.data(), buffer.data() + read);
-      size += read;
+      if (std::fread(content.data(), sizeof(uint8_t), content.size(), m_file) != content.size()) {
+        Log::error("Could not extract '{}' from the tarball.", entry.path.string());
+        return {};
+      }
+
+      return content;
+    }
+
+    // find the nearest checkpoint before the entry
+
+    auto iterator = std::ranges::upper_bound(m_checkpoints, entry.offset, std::less<>(), &Checkpoint::position);
+
+    if (iterator == m_checkpoints.begin()) {
+      Log::error("Could not extract '{}' from the tarball.", entry.path.string());
+      return {};
+    }
+
+    const Checkpoint& checkpoint = *std::prev(iterator);
+
+    z_stream stream = {};
+    [[maybe_unused]] int err = inflateInit2(&stream, -15); // raw inflate
+    assert(err == Z_OK);
+
+    if (checkpoint.bits > 0) {
+      seek(m_file, checkpoint.compressed_position - 1);
+      const int byte = std::fgetc(m_file);
+      err = inflatePrime(&stream, checkpoint.bits, byte >> (8 - checkpoint.bits));
+      assert(err == Z_OK);
+    } else {
+      seek(m_file, checkpoint.compressed_position);
+    }
+
+    if (!checkpoint.window.empty()) {
+      err = inflateSetDictionary(&stream, checkpoint.window.data(), static_cast<uInt>(checkpoint.window.size()));
+      assert(err == Z_OK);
+    }
+
+    std::vector<uint8_t> input(BufferSize);
+    std::vector<uint8_t> discarded(BufferSize);
+    uint64_t to_discard = entry.offset - checkpoint.position;
+    std::size_t extracted = 0;
+
+    while (extracted < content.size()) {
+      if (stream.avail_in == 0) {
+        stream.avail_in = static_cast<uInt>(std::fread(input.data(), sizeof(uint8_t), input.size(), m_file));
+        stream.next_in = input.data();
+
+        if (stream.avail_in == 0) {
+          break;
+        }
+      }
+
+      if (to_discard > 0) {
+        stream.next_out = discarded.data();
+        stream.avail_out = static_cast<uInt>(std::min<uint64_t>(to_discard, discarded.size()));
+      } else {
+        stream.next_out = content.data() + extracted;
+        stream.avail_out = static_cast<uInt>(std::min<std::size_t>(content.size() - extracted, UINT32_MAX));
+      }
+
+      const uInt available_out = stream.avail_out;
+      err = inflate(&stream, Z_NO_FLUSH);
+      const std::size_t produced = available_out - stream.avail_out;
+
+      if (to_discard > 0) {
+        to_discard -= produced;
+      } else {
+        extracted += produced;
+      }
+
+      if (err == Z_STREAM_END) {
+        break;
+      }
+
+      if (err != Z_OK && err != Z_BUF_ERROR) {
+        break;
+      }
+    }
+
+    inflateEnd(&stream);
+
+    if (extracted != content.size()) {
+      Log::error("Could not extract '{}' from the tarball.", entry.path.string());
+      return {};
     }
 
     return content;
@@ -0,0 +1,200 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/TextureData.h>
+
+#include <cassert>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/Stream.h>
+#include <gf2/core/Streams.h>
+
+namespace gf {
+
+  /*
+   * The .gftex format is a gf archive with the following header:
+   *
+   * - a tag: 'GFTX'
+   * - the compression
+   * - the size of the base level
+   * - the number of levels, followed by the offsets of the levels in the payload
+   *
+   * The header is followed by the payload: the levels, from the largest to the
+   * smallest, ready to be uploaded to the GPU. The payload is read at once.
+   */
+
+  namespace {
+
+    constexpr uint16_t TextureDataVersion = 1;
+    constexpr uint32_t TextureDataTag = 0x47465458; // 'GFTX'
+
+    Vec2I compute_level_size(Vec2I size, std::size_t level)
+    {
+      return gf::max(vec(size.w >> level, size.h >> level), vec(1, 1));
+    }
+
+    // the full mip chain, until a 1x1 level
+    std::size_t compute_level_count(Vec2I size)
+    {
+      std::size_t level_count = 1;
+
+      while (compute_level_size(size, level_count - 1) != vec(1, 1)) {
+        ++level_count;
+      }
+
+      return level_count;
+    }
+
+  } // namespace
+
+  TextureData::TextureData(const Image& image, BlockCompression compression, ThreadPool* pool)
+  : m_compression(compression)
+  , m_size(image.size())
+  {
+    if (m_size.w <= 0 || m_size.h <= 0) {
+      Log::fatal("Could not create texture data from an empty image.");
+    }
+
+    const std::size_t level_count = compute_level_count(m_size);
+
+    m_offsets.push_back(0);
+
+    for (std::size_t level = 0; level < level_count; ++level) {
+      m_offsets.push_back(m_offsets.back() + compute_compressed_size(compute_level_size(m_size, level), m_compression));
+    }
+
+    m_payload.resize(m_offsets.back());
+
+    Image level_image = image;
+
+    for (std::size_t level = 0; level < level_count; ++level) {
+      const Vec2I size = compute_level_size(m_size, level);
+
+      if (level > 0) {
+        level_image = level_image.resized(size, ResamplingFilter::Bilinear, pool);
+      }
+
+      assert(level_image.size() == size);
+      Span<uint8_t> target(m_payload.data() + m_offsets[level], m_offsets[level + 1] - m_offsets[level]);
+      compress_blocks(Span<const uint8_t>(level_image.raw_data(), level_image.raw_size()), size, m_compression, target, pool);
+    }
+  }
+
+  TextureData::TextureData(const std::filesystem::path& filename)
+  {
+    FileInputStream stream(filename);
+    *this = TextureData(stream);
+  }
+
+  TextureData::TextureData(InputStream& stream)
+  {
+    Deserializer ar(&stream);
+
+    if (ar.version() > TextureDataVersion) {
+      Log::fatal("Unsupported texture data version: {}.", ar.version());
+    }
+
+    uint32_t tag = 0;
+    uint32_t level_count = 0;
+    ar | tag | m_compression | m_size | level_count;
+
+    if (tag != TextureDataTag || level_count == 0 || m_compression > BlockCompression::Bc7 || m_size.w <= 0 || m_size.h <= 0) {
+      Log::fatal("The stream does not contain texture data.");
+    }
+
+    // the level count comes from the stream, it is checked before any allocation
+    if (level_count > compute_level_count(m_size)) {
+      Log::fatal("Invalid level count in the texture data: {}.", level_count);
+    }
+
+    m_offsets.resize(level_count + 1);
+
+    for (std::size_t& offset : m_offsets) {
+      uint64_t value = 0;
+      ar | value;
+      offset = static_cast<std::size_t>(value);
+    }
+
+    if (m_offsets.front() != 0) {
+      Log::fatal("Invalid level offsets in the texture data.");
+    }
+
+    for (std::size_t level = 0; level < level_count; ++level) {
+      if (m_offsets[level + 1] - m_offsets[level] != compute_compressed_size(compute_level_size(m_size, level), m_compression)) {
+        Log::fatal("Invalid level offsets in the texture data.");
+      }
+    }
+
+    m_payload.resize(m_offsets.back());
+
+    if (stream.read(m_payload) != m_payload.size()) {
+      Log::fatal("Truncated texture data.");
+    }
+  }
+
+  BlockCompression TextureData::compression() const
+  {
+    return m_compression;
+  }
+
+  Vec2I TextureData::size() const
+  {
+    return m_size;
+  }
+
+  std::size_t TextureData::level_count() const
+  {
+    return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+  }
+
+  Vec2I TextureData::level_size(std::size_t level) const
+  {
+    assert(level < level_count());
+    return compute_level_size(m_size, level);
+  }
+
+  Span<const uint8_t> TextureData::level_data(std::size_t level) const
+  {
+    assert(level < level_count());
+    return { m_payload.data() + m_offsets[level], m_offsets[level + 1] - m_offsets[level] };
+  }
+
+  Image TextureData::level_image(std::size_t level, ThreadPool* pool) const
+  {
+    const Vec2I size = level_size(level);
+    std::vector<uint8_t> pixels(compute_compressed_size(size, BlockCompression::None));
+    decompress_blocks(level_data(level), size, m_compression, pixels, pool);
+    return { size, pixels.data() };
+  }
+
+  std::size_t TextureData::raw_size() const
+  {
+    return m_payload.size();
+  }
+
+  const uint8_t* TextureData::raw_data() const
+  {
+    return m_payload.data();
+  }
+
+  void TextureData::save_to_file(const std::filesystem::path& filename) const
+  {
+    FileOutputStream stream(filename);
+    save_to_stream(stream);
+  }
+
+  void TextureData::save_to_stream(OutputStream& stream) const
+  {
+    Serializer ar(&stream, TextureDataVersion);
+    ar | TextureDataTag | m_compression | m_size | static_cast<uint32_t>(level_count());
+
+    for (const std::size_t offset : m_offsets) {
+      ar | static_cast<uint64_t>(offset);
+    }
+
+    stream.write(m_payload);
+  }
+
+} // namespace gf
@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/ThreadPool.h>
+
+#include <cassert>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <utility>
+
+namespace gf {
+
+  namespace {
+
+    constexpr std::size_t ChunksPerThread = 4;
+
+    struct ParallelState {
+      int begin = 0;
+      int count = 0;
+      int chunks = 0;
+      std::atomic<int> next_chunk = 0;
+      std::atomic<int> finished_chunks = 0;
+      std::atomic<bool> failed = false;
+      std::mutex mutex;
+      std::condition_variable condition;
+      std::exception_ptr error; // the first exception of a chunk, guarded by mutex
+    };
+
+    // runs the remaining chunks, returns when there is no more chunk to take
+    void parallel_chunks(ParallelState& state, const std::function<void(int, int)>& function)
+    {
+      for (;;) {
+        const int chunk = state.next_chunk.fetch_add(1);
+
+        if (chunk >= state.chunks) {
+          return;
+        }
+
+        // after a failure, the remaining chunks are only counted
+        if (!state.failed) {
+          const auto chunk_begin = static_cast<int>(static_cast<int64_t>(state.count) * chunk / state.chunks);
+          const auto chunk_end = static_cast<int>(static_cast<int64_t>(state.count) * (chunk + 1) / state.chunks);
+
+          try {
+            function(state.begin + chunk_begin, state.begin + chunk_end);
+          } catch (...) {
+            const std::scoped_lock<std::mutex> lock(state.mutex);
+
+            if (!state.error) {
+              state.error = std::current_exception();
+            }
+
+            state.failed = true;
+          }
+        }
+
+        if (state.finished_chunks.fetch_add(1) + 1 == state.chunks) {
+          const std::scoped_lock<std::mutex> lock(state.mutex);
+          state.condition.notify_all();
+        }
+      }
+    }
+
+  } // namespace
+
+  ThreadPool::ThreadPool(std::size_t thread_count)
+  {
+    m_threads.reserve(thread_count);
+
+    for (std::size_t i = 0; i < thread_count; ++i) {
+      m_threads.emplace_back([this]() { run(); });
+    }
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      m_stopped = true;
+    }
+
+    m_condition.notify_all();
+
+    for (std::thread& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  std::size_t ThreadPool::thread_count() const
+  {
+    return m_threads.size();
+  }
+
+  void ThreadPool::parallel_for(int begin, int end, const std::function<void(int, int)>& function)
+  {
+    if (end <= begin) {
+      return;
+    }
+
+    auto state = std::make_shared<ParallelState>();
+    state->begin = begin;
+    state->count = end - begin;
+    state->chunks = static_cast<int>(std::min(static_cast<std::size_t>(state->count), (m_threads.size() + 1) * ChunksPerThread));
+
+    const std::size_t helpers = std::min(m_threads.size(), static_cast<std::size_t>(state->chunks - 1));
+
+    for (std::size_t i = 0; i < helpers; ++i) {
+      enqueue([state, &function]() { parallel_chunks(*state, function); });
+    }
+
+    // the calling thread takes part in the work, so that a nested call can not
+    // wait for chunks that no thread is able to run
+    parallel_chunks(*state, function);
+
+    // the chunks are always waited for, even after a failure, as the helpers use the function
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->condition.wait(lock, [&state]() { return state->finished_chunks.load() == state->chunks; });
+
+    if (state->error) {
+      std::rethrow_exception(state->error);
+    }
+  }
+
+  std::size_t ThreadPool::default_thread_count()
+  {
+    const unsigned concurrency = std::thread::hardware_concurrency();
+    return concurrency > 1 ? concurrency - 1 : 1;
+  }
+
+  void ThreadPool::enqueue(std::function<void()> task)
+  {
+    if (m_threads.empty()) {
+      task();
+      return;
+    }
+
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      m_tasks.push_back(std::move(task));
+    }
+
+    m_condition.notify_one();
+  }
+
+  void ThreadPool::run()
+  {
+    for (;;) {
+      std::function<void()> task;
+
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+
+        if (m_tasks.empty()) {
+          assert(m_stopped);
+          return;
+        }
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+
+      task();
+    }
+  }
+
+  void parallel_for(ThreadPool* pool, int begin, int end, const std::function<void(int, int)>& function)
+  {
+    if (pool == nullptr) {
+      if (begin < end) {
+        function(begin, end);
+      }
+
+      return;
+    }
+
+    pool->parallel_for(begin, end, function);
+  }
+
+} // namespace gf
@@ -3,11 +3,18 @@
 
 #include <gf2/core/TiledMap.h>
 
+#include <cassert>
+#include <climits>
+
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <charconv>
+#include <exception>
 #include <fstream>
 #include <optional>
+#include <string_view>
+#include <utility>
 
 #include <fmt/std.h>
 #include <pugixml.hpp>
@@ -16,9 +23,17 @@
 
 #include <gf2/core/Blit.h>
 #include <gf2/core/Log.h>
+#include <gf2/core/Math.h>
 #include <gf2/core/Property.h>
 #include <gf2/core/ResourceBundle.h>
+#include <gf2/core/SecureHash.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationContainer.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/SerializationUtilities.h>
+#include <gf2/core/Streams.h>
 #include <gf2/core/StringUtils.h>
+#include <gf2/core/ThreadPool.h>
 #include "gf2/core/ColorCompositing.h"
 
 using namespace std::literals;
@@ -267,131 +282,132 @@ namespace gf {
       Csv,
     };
 
-    std::optional<uint8_t> parse_data_base64_byte(char c)
-    {
-      if (c >= 'A' && c <= 'Z') {
-        return c - 'A';
-      }
+    /*
+     * The tile data is decoded after the structure of the map is parsed, so
+     * that the layers and the chunks can be decoded concurrently. Each data
+     * node is decoded directly in a gid buffer of the expected size, without
+     * intermediate copies.
+     */
 
-      if (c >= 'a' && c <= 'z') {
-        return c - 'a' + 26;
-      }
+    constexpr uint8_t Base64Space = 0x40;
+    constexpr uint8_t Base64Pad = 0x41;
+    constexpr uint8_t Base64Invalid = 0xFF;
 
-      if (c >= '0' && c <= '9') {
-        return c - '0' + 52;
-      }
+    constexpr std::array<uint8_t, 256> Base64Table = []() {
+      std::array<uint8_t, 256> table = {};
+      table.fill(Base64Invalid);
 
-      if (c == '+') {
-        return 0x3E;
+      for (uint8_t i = 0; i < 26; ++i) {
+        table['A' + i] = i;
+        table['a' + i] = 26 + i;
       }
 
-      if (c == '/') {
-        return 0x3F;
+      for (uint8_t i = 0; i < 10; ++i) {
+        table['0' + i] = 52 + i;
       }
 
-      return std::nullopt;
-    }
+      table['+'] = 62;
+      table['/'] = 63;
+      table['='] = Base64Pad;
+      table[' '] = table['\n'] = table['\r'] = table['\t'] = Base64Space;
+      return table;
+    }();
 
-    std::size_t parse_data_base64_compute_padding(const std::string& input)
+    // returns the size of the decoded data, or std::nullopt if the input is invalid or too big for the output
+    std::optional<std::size_t> decode_base64(std::string_view input, Span<uint8_t> output)
     {
-      const std::size_t len = input.size();
-      size_t padding = 0;
+      const auto* data = reinterpret_cast<const uint8_t*>(input.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      const std::size_t length = input.size();
+
+      std::size_t i = 0;
+      std::size_t size = 0;
+      uint32_t quantum = 0;
+      int count = 0;
+      int padding = 0;
+
+      while (i < length) {
+        // fast path: four valid characters at once
+        if (count == 0 && i + 4 <= length) {
+          const uint32_t a = Base64Table[data[i]];
+          const uint32_t b = Base64Table[data[i + 1]];
+          const uint32_t c = Base64Table[data[i + 2]];
+          const uint32_t d = Base64Table[data[i + 3]];
+
+          if ((a | b | c | d) < 64 && padding == 0) {
+            if (size + 3 > output.size()) {
+              return std::nullopt;
+            }
 
-      if (len >= 2) {
-        if (input[len - 1] == '=') {
-          ++padding;
+            const uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
+            output[size] = static_cast<uint8_t>(value >> 16);
+            output[size + 1] = static_cast<uint8_t>(value >> 8);
+            output[size + 2] = static_cast<uint8_t>(value);
+            size += 3;
+            i += 4;
+            continue;
+          }
         }
 
-        if (input[len - 2] == '=') {
-          ++padding;
+        uint8_t value = Base64Table[data[i++]];
+
+        if (value == Base64Space) {
+          continue;
         }
-      }
 
-      return padding;
-    }
+        if (value == Base64Pad) {
+          // the padding is only allowed in the last two characters of the last quantum
+          if (count < 2) {
+            return std::nullopt;
+          }
 
-    // http://en.wikibooks.org/wiki/Algorithm_implementation/Miscellaneous/Base64
-    std::vector<uint8_t> parse_data_base64(std::string input)
-    {
-      std::erase_if(input, [](char c) { return c == '\n' || c == ' '; });
-      const std::size_t len = input.size();
-      assert(len % 4 == 0);
-      const size_t padding = parse_data_base64_compute_padding(input);
+          ++padding;
+          value = 0;
+        } else if (value >= 64 || padding > 0) {
+          return std::nullopt;
+        }
 
-      // Setup a vector to hold the result
-      std::vector<uint8_t> decoded;
-      decoded.reserve(((len / 4) * 3) - padding);
+        quantum = (quantum << 6) | value;
 
-      for (std::size_t i = 0; i < len;) {
+        if (++count == 4) {
+          const std::size_t decoded = 3 - std::min(padding, 2);
 
-        uint32_t tmp = 0; // Holds decoded quanta
-        for (int k = 0; k < 4; ++k) {
-          tmp <<= 6;
-          char c = input[i];
+          if (size + decoded > output.size()) {
+            return std::nullopt;
+          }
 
-          if (auto maybe_byte = parse_data_base64_byte(c); maybe_byte) {
-            tmp |= *maybe_byte;
-          } else if (c == '=') { // pad
-            switch (len - i) {
-              case 1: // One pad character
-                decoded.push_back((tmp >> 16) & 0x000000FF);
-                decoded.push_back((tmp >> 8) & 0x000000FF);
-                return decoded;
-              case 2: // Two pad characters
-                decoded.push_back((tmp >> 10) & 0x000000FF);
-                return decoded;
-              default:
-                assert(false);
-            }
-          } else {
-            Log::fatal("Unknown character: '{}' ({:#04X}).", c, c);
+          for (std::size_t k = 0; k < decoded; ++k) {
+            output[size + k] = static_cast<uint8_t>(quantum >> (16 - (8 * k)));
           }
 
-          ++i;
+          size += decoded;
+          quantum = 0;
+          count = 0;
         }
+      }
 
-        // clang-format off
-        decoded.push_back((tmp >> 16) & 0x000000FF);
-        decoded.push_back((tmp >> 8 ) & 0x000000FF);
-        decoded.push_back((tmp >> 0 ) & 0x000000FF);
-        // clang-format on
+      if (count != 0) {
+        return std::nullopt;
       }
 
-      return decoded;
+      return size;
     }
 
-    std::vector<uint8_t> parse_data_compressed(std::vector<uint8_t> input)
+    bool inflate_data(Span<const uint8_t> input, Span<uint8_t> output)
     {
-      std::vector<uint8_t> uncompressed;
-      std::array<uint8_t, 1024> tmp = {};
-
       z_stream stream = {};
       stream.next_in = input.data();
       stream.avail_in = static_cast<uInt>(input.size());
-      stream.zalloc = Z_NULL;
-      stream.zfree = Z_NULL;
+      stream.next_out = output.data();
+      stream.avail_out = static_cast<uInt>(output.size());
 
-      inflateInit2(&stream, 15 + 32); // allow to decode gzip and zlib format
-
-      for (;;) {
-        stream.next_out = tmp.data();
-        stream.avail_out = static_cast<uInt>(tmp.size());
-
-        const int err = inflate(&stream, Z_SYNC_FLUSH);
-
-        if (err == Z_OK) {
-          uncompressed.insert(uncompressed.end(), tmp.begin(), tmp.end() - stream.avail_out);
-        } else if (err == Z_STREAM_END) {
-          uncompressed.insert(uncompressed.end(), tmp.begin(), tmp.end() - stream.avail_out);
-          break;
-        } else {
-          assert(false);
-        }
+      if (inflateInit2(&stream, 15 + 32) != Z_OK) { // allow to decode gzip and zlib format
+        return false;
       }
 
-      assert(stream.avail_in == 0);
+      const int err = inflate(&stream, Z_FINISH);
+      const bool complete = err == Z_STREAM_END && stream.total_out == output.size();
       inflateEnd(&stream);
-      return uncompressed;
+      return complete;
     }
 
     TmxFormat parse_data_format(const pugi::xml_node node)
@@ -421,29 +437,80 @@ namespace gf {
       return TmxFormat::Xml;
     }
 
-    std::vector<uint8_t> parse_data_buffer(const pugi::xml_node node, TmxFormat format)
+    bool decode_tmx_gids(const pugi::xml_node node, TmxFormat format, Span<uint32_t> gids)
     {
       assert(node.name() == "data"sv || node.name() == "chunk"sv);
-
-      std::vector<uint8_t> data;
+      Span<uint8_t> bytes(reinterpret_cast<uint8_t*>(gids.data()), gids.size() * sizeof(uint32_t)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 
       switch (format) {
-        case TmxFormat::Xml:
-        case TmxFormat::Csv:
-          assert(false);
-          break;
-
         case TmxFormat::Base64:
-          data = parse_data_base64(node.child_value());
+          if (decode_base64(node.child_value(), bytes) != bytes.size()) {
+            return false;
+          }
+
           break;
 
         case TmxFormat::Base64_Zlib:
         case TmxFormat::Base64_Gzip:
-          data = parse_data_compressed(parse_data_base64(node.child_value()));
-          break;
+          {
+            const std::string_view input = node.child_value();
+            std::vector<uint8_t> compressed(((input.size() + 3) / 4) * 3);
+            const std::optional<std::size_t> size = decode_base64(input, compressed);
+
+            if (!size || !inflate_data(Span<const uint8_t>(compressed.data(), *size), bytes)) {
+              return false;
+            }
+
+            break;
+          }
+
+        case TmxFormat::Csv:
+          {
+            const std::string_view input = node.child_value();
+            const char* current = input.data();
+            const char* end = input.data() + input.size();
+
+            for (uint32_t& gid : gids) {
+              while (current != end && (*current == ',' || *current == ' ' || *current == '\n' || *current == '\r' || *current == '\t')) {
+                ++current;
+              }
+
+              const auto [ptr, ec] = std::from_chars(current, end, gid);
+
+              if (ec != std::errc()) {
+                return false;
+              }
+
+              current = ptr;
+            }
+
+            return true;
+          }
+
+        case TmxFormat::Xml:
+          {
+            std::size_t count = 0;
+
+            for (const pugi::xml_node tile : node.children("tile")) {
+              if (count == gids.size()) {
+                return false;
+              }
+
+              gids[count++] = tile.attribute("gid").as_uint();
+            }
+
+            return count == gids.size();
+          }
+      }
+
+      // the gids are stored in little endian
+      if constexpr (std::endian::native == std::endian::big) {
+        for (uint32_t& gid : gids) {
+          gid = ((gid & 0xFF) << 24) | ((gid & 0xFF00) << 8) | ((gid >> 8) & 0xFF00) | (gid >> 24);
+        }
       }
 
-      return data;
+      return true;
     }
 
     MapTile parse_gid(uint32_t gid)
@@ -475,48 +542,136 @@ namespace gf {
       return tile;
     }
 
-    std::vector<MapTile> parse_tmx_tiles(const pugi::xml_node node, TmxFormat format)
+    // a data or a chunk node, decoded after the structure of the map
+    struct TmxTileData {
+      pugi::xml_node node;
+      TmxFormat format = TmxFormat::Xml;
+      uint32_t layer_index = 0;
+      int32_t chunk_index = -1; // for infinite maps
+      Vec2I position = { 0, 0 };
+      Vec2I size = { 0, 0 };
+    };
+
+    void expand_gids(Span<const uint32_t> gids, Array2D<MapTile>& tiles)
     {
-      std::vector<MapTile> tiles;
+      assert(gids.size() == tiles.raw_size());
 
-      switch (format) {
+      for (const std::size_t index : tiles.index_range()) {
+        tiles[index] = parse_gid(gids[index]);
+      }
+    }
+
+    bool decode_tmx_chunk_data(const TmxTileData& data, MapTileChunk& chunk)
+    {
+      const std::size_t count = static_cast<std::size_t>(data.size.w) * static_cast<std::size_t>(data.size.h);
+
+      switch (data.format) {
         case TmxFormat::Base64:
         case TmxFormat::Base64_Zlib:
         case TmxFormat::Base64_Gzip:
           {
-            std::vector<uint8_t> buffer = parse_data_buffer(node, format);
+            // only the base64 is decoded, the chunk is decoded on demand
+            const std::string_view input = data.node.child_value();
+            chunk.data.resize(((input.size() + 3) / 4) * 3);
+            const std::optional<std::size_t> size = decode_base64(input, chunk.data);
 
-            const std::size_t size = buffer.size();
-            assert(size % 4 == 0);
-
-            for (std::size_t i = 0; i < size; i += 4) {
-              const uint32_t gid = buffer[i] | (buffer[i + 1] << 8) | (buffer[i + 2] << 16) | (buffer[i + 3] << 24);
-              tiles.push_back(parse_gid(gid));
+            if (!size || *size == 0) {
+              return false;
             }
 
-            break;
+            chunk.data.resize(*size);
+            chunk.compressed = data.format != TmxFormat::Base64;
+            return chunk.compressed || chunk.data.size() == count * sizeof(uint32_t);
           }
 
         case TmxFormat::Csv:
+        case TmxFormat::Xml:
           {
-            auto items = split_string(node.child_value(), ",");
+            std::vector<uint32_t> gids(count);
 
-            for (auto item : items) {
-              tiles.push_back(parse_gid(parse_number<uint32_t>(item)));
+            if (!decode_tmx_gids(data.node, data.format, gids)) {
+              return false;
             }
 
-            break;
+            chunk.tiles = Array2D<MapTile>(data.size);
+            expand_gids(gids, chunk.tiles);
+            return true;
           }
+      }
 
-        case TmxFormat::Xml:
-          for (const pugi::xml_node tile : node.children("tile")) {
-            tiles.push_back(parse_gid(tile.attribute("gid").as_uint()));
-          };
+      return false;
+    }
 
-          break;
+    bool decode_tmx_tile_data(const TmxTileData& data, TiledMap& map)
+    {
+      MapTileLayer& layer = map.tile_layers[data.layer_index];
+
+      if (data.chunk_index >= 0) {
+        return decode_tmx_chunk_data(data, layer.chunks[data.chunk_index]);
       }
 
-      return tiles;
+      std::vector<uint32_t> gids(static_cast<std::size_t>(data.size.w) * static_cast<std::size_t>(data.size.h));
+
+      if (!decode_tmx_gids(data.node, data.format, gids)) {
+        return false;
+      }
+
+      Array2D<MapTile>& tiles = layer.tiles;
+      const auto blit = compute_blit(RectI::from_size(data.size), data.size, data.position, tiles.size());
+
+      for (auto offset : gf::position_range(blit.origin_region.size())) {
+        const Vec2I origin = blit.origin_region.position() + offset;
+        tiles(blit.target_offset + offset) = parse_gid(gids[(origin.y * data.size.w) + origin.x]);
+      }
+
+      return true;
+    }
+
+    void decode_tmx_tiles(const std::vector<TmxTileData>& tile_data, TiledMap& map, ThreadPool* pool)
+    {
+      // the error of a chunk is rethrown by parallel_for once all the chunks are finished
+      parallel_for(pool, 0, static_cast<int>(tile_data.size()), [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+          if (!decode_tmx_tile_data(tile_data[i], map)) {
+            Log::fatal("Invalid tile data in layer '{}'.", map.tile_layers[tile_data[i].layer_index].layer.name);
+          }
+        }
+      });
+    }
+
+    bool decode_chunk(MapTileChunk& chunk)
+    {
+      std::vector<uint32_t> gids(static_cast<std::size_t>(chunk.size.w) * static_cast<std::size_t>(chunk.size.h));
+      Span<uint8_t> bytes(reinterpret_cast<uint8_t*>(gids.data()), gids.size() * sizeof(uint32_t)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+      if (chunk.compressed) {
+        if (!inflate_data(chunk.data, bytes)) {
+          return false;
+        }
+      } else {
+        if (chunk.data.size() != bytes.size()) {
+          return false;
+        }
+
+        std::copy(chunk.data.begin(), chunk.data.end(), bytes.begin());
+      }
+
+      if constexpr (std::endian::native == std::endian::big) {
+        for (uint32_t& gid : gids) {
+          gid = ((gid & 0xFF) << 24) | ((gid & 0xFF00) << 8) | ((gid >> 8) & 0xFF00) | (gid >> 24);
+        }
+      }
+
+      chunk.tiles = Array2D<MapTile>(chunk.size);
+      expand_gids(gids, chunk.tiles);
+      chunk.data = {};
+      chunk.compressed = false;
+      return true;
+    }
+
+    bool chunk_before(const MapTileChunk& chunk, Vec2I position)
+    {
+      return chunk.position.y < position.y || (chunk.position.y == position.y && chunk.position.x < position.x);
     }
 
     BlendMode parse_blend_monde(const pugi::xml_attribute attribute) {
@@ -544,7 +699,7 @@ namespace gf {
       return BlendMode::Normal;
     }
 
-    MapLayerStructure parse_tmx_tile_layer(const pugi::xml_node node, TiledMap& map)
+    MapLayerStructure parse_tmx_tile_layer(const pugi::xml_node node, TiledMap& map, std::vector<TmxTileData>& tile_data)
     {
       assert(node.name() == "layer"sv);
       assert(map.map_size.w == node.attribute("width").as_int());
@@ -554,41 +709,55 @@ namespace gf {
       tile_layer.layer = parse_tmx_layer_common(node, map);
       tile_layer.mode = parse_blend_monde(node.attribute("mode"));
 
-      for (const pugi::xml_node data_node : node.children("data")) {
-        tile_layer.tiles = Array2D<MapTile>(map.map_size);
+      const auto layer_index = static_cast<uint32_t>(map.tile_layers.size());
 
+      for (const pugi::xml_node data_node : node.children("data")) {
         auto format = parse_data_format(data_node);
         auto range = data_node.children("chunk");
 
         if (std::distance(range.begin(), range.end()) > 0) {
+          // infinite map: only the chunks are kept, sorted by position
           for (const pugi::xml_node chunk_node : range) {
-            Vec2I chunk_position = {};
-            chunk_position.x = chunk_node.attribute("x").as_int();
-            chunk_position.y = chunk_node.attribute("y").as_int();
-
-            Vec2I chunk_size = {};
-            chunk_size.w = chunk_node.attribute("width").as_int();
-            chunk_size.h = chunk_node.attribute("height").as_int();
+            MapTileChunk chunk;
+            chunk.position.x = chunk_node.attribute("x").as_int();
+            chunk.position.y = chunk_node.attribute("y").as_int();
+            chunk.size.w = chunk_node.attribute("width").as_int();
+            chunk.size.h = chunk_node.attribute("height").as_int();
+            tile_layer.chunks.push_back(std::move(chunk));
+          }
 
-            auto blit = compute_blit(RectI::from_size(chunk_size), chunk_size, chunk_position, tile_layer.tiles.size());
-            auto tiles = parse_tmx_tiles(chunk_node, format);
+          std::ranges::sort(tile_layer.chunks, [](const MapTileChunk& lhs, const MapTileChunk& rhs) { return chunk_before(lhs, rhs.position); });
 
-            for (auto offset : gf::position_range(blit.origin_region.size())) {
-              const std::size_t index = (offset.y * chunk_size.w) + offset.x;
-              const Vec2I position = blit.target_offset + offset;
-              tile_layer.tiles(position) = tiles[index];
-            }
+          for (const pugi::xml_node chunk_node : range) {
+            TmxTileData data;
+            data.node = chunk_node;
+            data.format = format;
+            data.layer_index = layer_index;
+            data.position.x = chunk_node.attribute("x").as_int();
+            data.position.y = chunk_node.attribute("y").as_int();
+            data.size.w = chunk_node.attribute("width").as_int();
+            data.size.h = chunk_node.attribute("height").as_int();
+
+            auto iterator = std::lower_bound(tile_layer.chunks.begin(), tile_layer.chunks.end(), data.position, chunk_before);
+            assert(iterator != tile_layer.chunks.end() && iterator->position == data.position);
+            data.chunk_index = static_cast<int32_t>(std::distance(tile_layer.chunks.begin(), iterator));
+            tile_data.push_back(data);
           }
         } else {
-          auto tiles = parse_tmx_tiles(data_node, format);
-          assert(tiles.size() == static_cast<std::size_t>(map.map_size.w * map.map_size.h));
-          std::ranges::copy(tiles, tile_layer.tiles.begin());
+          tile_layer.tiles = Array2D<MapTile>(map.map_size);
+
+          TmxTileData data;
+          data.node = data_node;
+          data.format = format;
+          data.layer_index = layer_index;
+          data.size = map.map_size;
+          tile_data.push_back(data);
         }
       }
 
       MapLayerStructure structure = {};
       structure.type = MapLayerType::Tile;
-      structure.layer_index = static_cast<uint32_t>(map.tile_layers.size());
+      structure.layer_index = layer_index;
 
       map.tile_layers.push_back(std::move(tile_layer));
 
@@ -679,16 +848,16 @@ namespace gf {
 
     // group layer
 
-    std::vector<MapLayerStructure> parse_tmx_layer_structure(pugi::xml_node node, TiledMap& map);
+    std::vector<MapLayerStructure> parse_tmx_layer_structure(pugi::xml_node node, TiledMap& map, std::vector<TmxTileData>& tile_data);
 
     // NOLINTNEXTLINE(misc-no-recursion)
-    MapLayerStructure parse_tmx_group_layer(const pugi::xml_node node, TiledMap& map)
+    MapLayerStructure parse_tmx_group_layer(const pugi::xml_node node, TiledMap& map, std::vector<TmxTileData>& tile_data)
     {
       assert(node.name() == "group"sv);
 
       MapGroupLayer group_layer = {};
       group_layer.layer = parse_tmx_layer_common(node, map);
-      group_layer.sub_layers = parse_tmx_layer_structure(node, map);
+      group_layer.sub_layers = parse_tmx_layer_structure(node, map, tile_data);
 
       MapLayerStructure structure = {};
       structure.type = MapLayerType::Group;
@@ -700,7 +869,7 @@ namespace gf {
     }
 
     // NOLINTNEXTLINE(misc-no-recursion)
-    std::vector<MapLayerStructure> parse_tmx_layer_structure(const pugi::xml_node node, TiledMap& map)
+    std::vector<MapLayerStructure> parse_tmx_layer_structure(const pugi::xml_node node, TiledMap& map, std::vector<TmxTileData>& tile_data)
     {
       std::vector<MapLayerStructure> layers;
 
@@ -708,11 +877,11 @@ namespace gf {
         const std::string name = layer.name();
 
         if (name == "layer") {
-          layers.push_back(parse_tmx_tile_layer(layer, map));
+          layers.push_back(parse_tmx_tile_layer(layer, map, tile_data));
         } else if (name == "objectgroup") {
           layers.push_back(parse_tmx_object_layer(layer, map));
         } else if (name == "group") {
-          layers.push_back(parse_tmx_group_layer(layer, map));
+          layers.push_back(parse_tmx_group_layer(layer, map, tile_data));
         }
       }
 
@@ -827,7 +996,7 @@ namespace gf {
      * map
      */
 
-    void parse_tmx_map(const pugi::xml_node node, TiledMap& map, const std::filesystem::path& base_directory)
+    void parse_tmx_map(const pugi::xml_node node, TiledMap& map, const std::filesystem::path& base_directory, ThreadPool* pool)
     {
       assert(node.name() == "map"sv);
 
@@ -883,7 +1052,147 @@ namespace gf {
         map.tilesets.push_back(parse_tmx_tileset(tileset, map, base_directory));
       }
 
-      map.layers = parse_tmx_layer_structure(node, map);
+      std::vector<TmxTileData> tile_data;
+      map.layers = parse_tmx_layer_structure(node, map, tile_data);
+      decode_tmx_tiles(tile_data, map, pool);
+    }
+
+    /*
+     * cache
+     *
+     * The cache of a TMX file is a compressed gf archive, next to the TMX file,
+     * written only with TiledMapOption::Cache, with the following content:
+     *
+     * - a tag: 'GFTC'
+     * - the TSX files referenced by the TMX file, relative to the TMX file
+     * - the SecureHash of the TMX file and of the TSX files
+     * - the map, with the textures relative to the TMX file
+     *
+     * Hashing the sources is much faster than parsing them, so the cache is
+     * always checked before being used.
+     */
+
+    constexpr uint16_t TiledMapCacheVersion = 2;
+    constexpr uint32_t TiledMapCacheTag = 0x47465443; // 'GFTC'
+
+    static_assert(TiledMapCacheVersion >= TiledMapChunksVersion);
+
+    std::optional<SecureHash::Hash> compute_sources_hash(const std::filesystem::path& filename, const std::vector<std::filesystem::path>& sources)
+    {
+      SecureHash hash;
+
+      auto input_file = [&hash](const std::filesystem::path& path) {
+        if (!std::filesystem::is_regular_file(path)) {
+          return false;
+        }
+
+        MappedFileInputStream file(path);
+        const uint64_t size = file.memory().size();
+        hash.input(Span<const uint8_t>(reinterpret_cast<const uint8_t*>(&size), sizeof(size))); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        hash.input(file.memory());
+        return true;
+      };
+
+      if (!input_file(filename)) {
+        return std::nullopt;
+      }
+
+      for (const std::filesystem::path& source : sources) {
+        if (!input_file(filename.parent_path() / source)) {
+          return std::nullopt;
+        }
+      }
+
+      return hash.result();
+    }
+
+    std::vector<std::filesystem::path> collect_tmx_sources(const pugi::xml_node node)
+    {
+      std::vector<std::filesystem::path> sources;
+
+      for (const pugi::xml_node tileset : node.children("tileset")) {
+        if (std::filesystem::path source = tileset.attribute("source").as_string(); !source.empty()) {
+          sources.push_back(std::move(source));
+        }
+      }
+
+      return sources;
+    }
+
+    bool load_tmx_cache(const std::filesystem::path& filename, TiledMap& map)
+    {
+      const std::filesystem::path cache = TiledMap::cache_file(filename);
+
+      if (!std::filesystem::is_regular_file(cache)) {
+        return false;
+      }
+
+      try {
+        FileInputStream file(cache);
+        CompressedInputStream compressed(&file);
+        BufferedInputStream stream(&compressed);
+        Deserializer ar(&stream);
+
+        uint32_t tag = 0;
+        ar | tag;
+
+        if (ar.version() != TiledMapCacheVersion || tag != TiledMapCacheTag) {
+          return false;
+        }
+
+        std::vector<std::filesystem::path> sources;
+        SecureHash::Hash hash = {};
+        ar | sources | hash;
+
+        if (compute_sources_hash(filename, sources) != hash) {
+          return false;
+        }
+
+        TiledMap loaded;
+        ar | loaded;
+
+        for (std::filesystem::path& texture : loaded.textures) {
+          if (texture.is_relative()) {
+            texture = filename.parent_path() / texture;
+          }
+        }
+
+        map = std::move(loaded);
+      } catch (std::exception& ex) {
+        Log::warning("Invalid cache for TMX file '{}': {}", filename, ex.what());
+        return false;
+      }
+
+      return true;
+    }
+
+    void save_tmx_cache(const std::filesystem::path& filename, const std::vector<std::filesystem::path>& sources, TiledMap& map)
+    {
+      const std::optional<SecureHash::Hash> hash = compute_sources_hash(filename, sources);
+
+      if (!hash) {
+        return;
+      }
+
+      // the textures are saved relative to the TMX file, the cache does not depend on the current directory
+      const std::filesystem::path base_directory = filename.parent_path();
+      std::vector<std::filesystem::path> textures = map.textures;
+
+      for (std::filesystem::path& texture : map.textures) {
+        if (texture.is_relative()) {
+          texture = texture.lexically_relative(base_directory);
+        }
+      }
+
+      {
+        FileOutputStream file(TiledMap::cache_file(filename));
+        CompressedOutputStream compressed(&file);
+        BufferedOutputStream stream(&compressed);
+        Serializer ar(&stream, TiledMapCacheVersion);
+        ar | TiledMapCacheTag | sources | *hash | map;
+      }
+
+      map.textures = std::move(textures);
     }
 
   }
@@ -928,12 +1237,80 @@ namespace gf {
     return &*first;
   }
 
+  /*
+   * MapTileLayer
+   */
+
+  MapTile MapTileLayer::tile(Vec2I position) const
+  {
+    if (!chunked()) {
+      return tiles.valid(position) ? tiles(position) : MapTile{};
+    }
+
+    const MapTileChunk* chunk = chunk_at(position);
+
+    if (chunk == nullptr || !chunk->decoded()) {
+      return {};
+    }
+
+    return chunk->tiles(position - chunk->position);
+  }
+
+  const MapTileChunk* MapTileLayer::chunk_at(Vec2I position) const
+  {
+    if (chunks.empty()) {
+      return nullptr;
+    }
+
+    // all the chunks of a layer have the same size
+    const Vec2I size = chunks.front().size;
+    const Vec2I origin = chunks.front().position;
+    const Vec2I chunk_position = origin + gf::vec(div_floor(position.x - origin.x, size.w) * size.w, div_floor(position.y - origin.y, size.h) * size.h);
+
+    auto iterator = std::lower_bound(chunks.begin(), chunks.end(), chunk_position, chunk_before);
+
+    if (iterator == chunks.end() || iterator->position != chunk_position) {
+      return nullptr;
+    }
+
+    return &*iterator;
+  }
+
+  void MapTileLayer::decode_chunks(RectI area, ThreadPool* pool)
+  {
+    std::vector<MapTileChunk*> pending;
+
+    for (MapTileChunk& chunk : chunks) {
+      if (!chunk.decoded() && area.intersects(RectI::from_position_size(chunk.position, chunk.size))) {
+        pending.push_back(&chunk);
+      }
+    }
+
+    parallel_for(pool, 0, static_cast<int>(pending.size()), [&](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        if (!decode_chunk(*pending[i])) {
+          Log::fatal("Invalid chunk at ({}, {}) in layer '{}'.", pending[i]->position.x, pending[i]->position.y, layer.name);
+        }
+      }
+    });
+  }
+
   /*
    * TiledMap
    */
 
-  TiledMap::TiledMap(const std::filesystem::path& filename)
+  TiledMap::TiledMap(const std::filesystem::path& filename, Flags<TiledMapOption> options, ThreadPool* pool)
   {
+    const RectI everything = RectI::from_position_size({ INT32_MIN / 2, INT32_MIN / 2 }, { INT32_MAX, INT32_MAX });
+
+    if (options.test(TiledMapOption::Cache) && load_tmx_cache(filename, *this)) {
+      if (!options.test(TiledMapOption::LazyChunks)) {
+        decode_chunks(everything, pool);
+      }
+
+      return;
+    }
+
     std::ifstream file(filename);
 
     if (!file) {
@@ -947,7 +1324,16 @@ namespace gf {
       Log::fatal("Could not load TMX file '{}': {}.", filename, result.description());
     }
 
-    parse_tmx_map(doc.child("map"), *this, filename.parent_path());
+    parse_tmx_map(doc.child("map"), *this, filename.parent_path(), pool);
+
+    // the cache keeps the chunks encoded, so that it can be used with lazy chunks
+    if (options.test(TiledMapOption::Cache)) {
+      save_tmx_cache(filename, collect_tmx_sources(doc.child("map")), *this);
+    }
+
+    if (!options.test(TiledMapOption::LazyChunks)) {
+      decode_chunks(everything, pool);
+    }
   }
 
   const MapTileset* TiledMap::tileset_from_gid(uint32_t gid) const noexcept
@@ -985,4 +1371,42 @@ namespace gf {
     return *structure;
   }
 
+  void TiledMap::decode_chunks(RectI area, ThreadPool* pool)
+  {
+    for (MapTileLayer& tile_layer : tile_layers) {
+      tile_layer.decode_chunks(area, pool);
+    }
+  }
+
+  std::size_t TiledMap::memory_size() const
+  {
+    // an estimation, only the tiles and the objects are taken into account
+    std::size_t size = sizeof(TiledMap);
+
+    for (const MapTileLayer& tile_layer : tile_layers) {
+      size += tile_layer.tiles.raw_size() * sizeof(MapTile);
+
+      for (const MapTileChunk& chunk : tile_layer.chunks) {
+        size += sizeof(MapTileChunk) + (chunk.tiles.raw_size() * sizeof(MapTile)) + chunk.data.size();
+      }
+    }
+
+    for (const MapObjectLayer& object_layer : object_layers) {
+      size += object_layer.objects.size() * sizeof(MapObject);
+    }
+
+    for (const MapTileset& tileset : tilesets) {
+      size += tileset.tiles.size() * sizeof(MapTilesetTile);
+    }
+
+    return size;
+  }
+
+  std::filesystem::path TiledMap::cache_file(const std::filesystem::path& filename)
+  {
+    std::filesystem::path cache = filename;
+    cache += ".cache";
+    return cache;
+  }
+
 }
@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include <gf2/core/TiledMapView.h>
+
+#include <cassert>
+
+#include <ranges>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <gf2/core/Log.h>
+#include <gf2/core/Property.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationContainer.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/SerializationUtilities.h>
+#include <gf2/core/Stream.h>
+
+namespace gf {
+
+  namespace {
+
+    constexpr uint32_t TiledMapViewTag = 0x4746544D; // 'GFTM'
+    constexpr uint16_t TiledMapViewVersion = 1;
+
+    /*
+     * save
+     */
+
+    MapLayerBlob write_layer(BlobWriter& writer, const MapLayer& layer)
+    {
+      MapLayerBlob blob;
+      blob.properties_index = layer.properties_index;
+      blob.visible = layer.visible;
+      blob.name = writer.add_string(layer.name);
+      blob.type = writer.add_string(layer.type);
+      blob.offset = layer.offset;
+      return blob;
+    }
+
+    BlobArray<uint8_t> write_properties(BlobWriter& writer, const PropertyMap& properties)
+    {
+      std::vector<uint8_t> bytes;
+
+      {
+        BufferOutputStream stream(&bytes);
+        Serializer ar(&stream);
+        ar | properties;
+      }
+
+      return writer.add_array(bytes);
+    }
+
+    MapTilesetBlob write_tileset(BlobWriter& writer, const MapTileset& tileset)
+    {
+      MapTilesetBlob blob;
+      blob.type = writer.add_string(tileset.type);
+      blob.properties_index = tileset.properties_index;
+      blob.texture_index = tileset.texture_index;
+      blob.first_gid = tileset.first_gid;
+      blob.tile_size = tileset.tile_size;
+      blob.offset = tileset.offset;
+      blob.spacing = tileset.spacing;
+      blob.margin = tileset.margin;
+      blob.tiles = writer.allocate_array<MapTilesetTileBlob>(tileset.tiles.size());
+
+      for (std::size_t i = 0; i < tileset.tiles.size(); ++i) {
+        const MapTilesetTile& tile = tileset.tiles[i];
+        MapTilesetTileBlob tile_blob;
+        tile_blob.properties_index = tile.properties_index;
+        tile_blob.id = tile.id;
+        tile_blob.type = writer.add_string(tile.type);
+        tile_blob.objects = tile.objects.value_or(NoIndex);
+        writer.set(blob.tiles, i, tile_blob);
+      }
+
+      return blob;
+    }
+
+    MapObjectBlob write_object(BlobWriter& writer, const MapObject& object)
+    {
+      MapObjectBlob blob;
+      blob.properties_index = object.properties_index;
+      blob.object_type = object.object_type;
+      blob.visible = object.visible;
+      blob.id = object.id;
+      blob.name = writer.add_string(object.name);
+      blob.type = writer.add_string(object.type);
+      blob.location = object.location;
+      blob.rotation = object.rotation;
+
+      if (const auto* point = std::get_if<Vec2F>(&object.feature)) {
+        blob.feature = MapObjectFeature::Point;
+        blob.point = *point;
+      } else if (const auto* tile = std::get_if<MapTile>(&object.feature)) {
+        blob.feature = MapObjectFeature::Tile;
+        blob.tile = *tile;
+      } else if (const auto* points = std::get_if<std::vector<Vec2F>>(&object.feature)) {
+        blob.feature = MapObjectFeature::Points;
+        blob.points = writer.add_array(*points);
+      }
+
+      return blob;
+    }
+
+    template<typename T, typename U, typename Function>
+    BlobArray<T> write_all(BlobWriter& writer, const std::vector<U>& data, Function function)
+    {
+      const BlobArray<T> array = writer.allocate_array<T>(data.size());
+
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        writer.set(array, i, function(writer, data[i]));
+      }
+
+      return array;
+    }
+
+    /*
+     * to_map
+     */
+
+    MapLayer read_layer(const TiledMapView& view, const MapLayerBlob& blob)
+    {
+      MapLayer layer;
+      layer.properties_index = blob.properties_index;
+      layer.visible = blob.visible;
+      layer.name = view[blob.name];
+      layer.type = view[blob.type];
+      layer.offset = blob.offset;
+      return layer;
+    }
+
+    template<typename T>
+    std::vector<T> to_vector(Span<const T> data)
+    {
+      return { data.begin(), data.end() };
+    }
+
+  } // namespace
+
+  TiledMapView::TiledMapView(Span<const uint8_t> memory)
+  : m_blob(memory, TiledMapViewTag)
+  {
+    if (m_blob.version() > TiledMapViewVersion) {
+      Log::fatal("Unsupported tiled map blob version: {}.", m_blob.version());
+    }
+  }
+
+  TiledMapView::TiledMapView(const std::filesystem::path& filename)
+  : m_file(std::in_place, filename)
+  , m_blob(m_file->memory(), TiledMapViewTag) // the mapping does not move with the stream, the view stays valid
+  {
+    if (m_blob.version() > TiledMapViewVersion) {
+      Log::fatal("Unsupported tiled map blob version: {}.", m_blob.version());
+    }
+  }
+
+  PropertyMap TiledMapView::properties(uint32_t index) const
+  {
+    const Span<const BlobArray<uint8_t>> properties = m_blob.array(map().properties);
+
+    if (index >= properties.size()) {
+      return {};
+    }
+
+    MemoryInputStream stream(m_blob.array(properties[index]));
+    Deserializer ar(&stream);
+
+    PropertyMap property_map;
+    ar | property_map;
+    return property_map;
+  }
+
+  MapTile TiledMapView::tile(const MapTileLayerBlob& layer, Vec2I position) const
+  {
+    assert(0 <= position.x && position.x < layer.size.x && 0 <= position.y && position.y < layer.size.y);
+    const Span<const MapTile> tiles = m_blob.array(layer.tiles);
+    return tiles[static_cast<std::size_t>(position.x) + (static_cast<std::size_t>(position.y) * static_cast<std::size_t>(layer.size.x))];
+  }
+
+  const MapTilesetBlob* TiledMapView::tileset_from_gid(uint32_t gid) const
+  {
+    for (const MapTilesetBlob& tileset : std::views::reverse(m_blob.array(map().tilesets))) {
+      if (tileset.first_gid <= gid) {
+        return &tileset;
+      }
+    }
+
+    return nullptr;
+  }
+
+  TiledMap TiledMapView::to_map() const
+  {
+    const TiledMapBlob& blob = map();
+    const TiledMapView& view = *this;
+
+    TiledMap map;
+    map.type = view[blob.type];
+    map.properties_index = blob.properties_index;
+    map.orientation = blob.orientation;
+    map.cell_axis = blob.cell_axis;
+    map.cell_index = blob.cell_index;
+    map.hex_side_length = blob.hex_side_length;
+    map.map_size = blob.map_size;
+    map.tile_size = blob.tile_size;
+
+    for (uint32_t i = 0; i < blob.properties.size; ++i) {
+      map.properties.push_back(properties(i));
+    }
+
+    for (const MapTilesetBlob& tileset_blob : view[blob.tilesets]) {
+      MapTileset tileset;
+      tileset.type = view[tileset_blob.type];
+      tileset.properties_index = tileset_blob.properties_index;
+      tileset.texture_index = tileset_blob.texture_index;
+      tileset.first_gid = tileset_blob.first_gid;
+      tileset.tile_size = tileset_blob.tile_size;
+      tileset.offset = tileset_blob.offset;
+      tileset.spacing = tileset_blob.spacing;
+      tileset.margin = tileset_blob.margin;
+
+      for (const MapTilesetTileBlob& tile_blob : view[tileset_blob.tiles]) {
+        MapTilesetTile tile;
+        tile.properties_index = tile_blob.properties_index;
+        tile.id = tile_blob.id;
+        tile.type = view[tile_blob.type];
+
+        if (tile_blob.objects != NoIndex) {
+          tile.objects = tile_blob.objects;
+        }
+
+        tileset.tiles.push_back(std::move(tile));
+      }
+
+      map.tilesets.push_back(std::move(tileset));
+    }
+
+    for (const MapTileLayerBlob& layer_blob : view[blob.tile_layers]) {
+      MapTileLayer layer;
+      layer.layer = read_layer(view, layer_blob.layer);
+      layer.tiles = Array2D<MapTile>(layer_blob.size);
+      const Span<const MapTile> tiles = view[layer_blob.tiles];
+
+      if (tiles.size() != layer.tiles.raw_size()) {
+        Log::fatal("Invalid tile layer in the tiled map blob.");
+      }
+
+      for (const std::size_t index : layer.tiles.index_range()) {
+        layer.tiles[index] = tiles[index];
+      }
+      layer.mode = layer_blob.mode;
+      map.tile_layers.push_back(std::move(layer));
+    }
+
+    for (const MapObjectLayerBlob& layer_blob : view[blob.object_layers]) {
+      MapObjectLayer layer;
+      layer.layer = read_layer(view, layer_blob.layer);
+
+      for (const MapObjectBlob& object_blob : view[layer_blob.objects]) {
+        MapObject object;
+        object.properties_index = object_blob.properties_index;
+        object.object_type = object_blob.object_type;
+        object.visible = object_blob.visible;
+        object.id = object_blob.id;
+        object.name = view[object_blob.name];
+        object.type = view[object_blob.type];
+        object.location = object_blob.location;
+        object.rotation = object_blob.rotation;
+
+        switch (object_blob.feature) {
+          case MapObjectFeature::None:
+            break;
+          case MapObjectFeature::Point:
+            object.feature = object_blob.point;
+            break;
+          case MapObjectFeature::Tile:
+            object.feature = object_blob.tile;
+            break;
+          case MapObjectFeature::Points:
+            object.feature = to_vector(view[object_blob.points]);
+            break;
+        }
+
+        layer.objects.push_back(std::move(object));
+      }
+
+      map.object_layers.push_back(std::move(layer));
+    }
+
+    for (const MapGroupLayerBlob& layer_blob : view[blob.group_layers]) {
+      MapGroupLayer layer;
+      layer.layer = read_layer(view, layer_blob.layer);
+      layer.sub_layers = to_vector(view[layer_blob.sub_layers]);
+      map.group_layers.push_back(std::move(layer));
+    }
+
+    map.layers = to_vector(view[blob.layers]);
+
+    for (const BlobString texture : view[blob.textures]) {
+      map.textures.emplace_back(view[texture]);
+    }
+
+    return map;
+  }
+
+  void TiledMapView::save(const TiledMap& map, OutputStream& stream)
+  {
+    BlobWriter writer(TiledMapViewTag, TiledMapViewVersion);
+
+    TiledMapBlob blob;
+    blob.type = writer.add_string(map.type);
+    blob.properties_index = map.properties_index;
+    blob.orientation = map.orientation;
+    blob.cell_axis = map.cell_axis;
+    blob.cell_index = map.cell_index;
+    blob.hex_side_length = map.hex_side_length;
+    blob.map_size = map.map_size;
+    blob.tile_size = map.tile_size;
+
+    blob.properties = write_all<BlobArray<uint8_t>>(writer, map.properties, write_properties);
+    blob.tilesets = write_all<MapTilesetBlob>(writer, map.tilesets, write_tileset);
+
+    blob.tile_layers = write_all<MapTileLayerBlob>(writer, map.tile_layers, [](BlobWriter& writer, const MapTileLayer& layer) {
+      if (layer.chunked()) {
+        Log::fatal("Could not save the chunked layer '{}' in a tiled map blob.", layer.layer.name);
+      }
+
+      MapTileLayerBlob layer_blob;
+      layer_blob.layer = write_layer(writer, layer.layer);
+      layer_blob.size = layer.tiles.size();
+      layer_blob.tiles = writer.add_array(Span<const MapTile>(layer.tiles.raw_data(), layer.tiles.raw_size()));
+      layer_blob.mode = layer.mode;
+      return layer_blob;
+    });
+
+    blob.object_layers = write_all<MapObjectLayerBlob>(writer, map.object_layers, [](BlobWriter& writer, const MapObjectLayer& layer) {
+      MapObjectLayerBlob layer_blob;
+      layer_blob.layer = write_layer(writer, layer.layer);
+      layer_blob.objects = write_all<MapObjectBlob>(writer, layer.objects, write_object);
+      return layer_blob;
+    });
+
+    blob.group_layers = write_all<MapGroupLayerBlob>(writer, map.group_layers, [](BlobWriter& writer, const MapGroupLayer& layer) {
+      MapGroupLayerBlob layer_blob;
+      layer_blob.layer = write_layer(writer, layer.layer);
+      layer_blob.sub_layers = writer.add_array(layer.sub_layers);
+      return layer_blob;
+    });
+
+    blob.layers = writer.add_array(map.layers);
+
+    blob.textures = write_all<BlobString>(writer, map.textures, [](BlobWriter& writer, const std::filesystem::path& texture) {
+      return writer.add_string(texture.generic_string());
+    });
+
+    writer.finish(blob);
+    writer.save_to_stream(stream);
+  }
+
+  void TiledMapView::save_to_file(const TiledMap& map, const std::filesystem::path& filename)
+  {
+    FileOutputStream stream(filename);
+    save(map, stream);
+  }
+
+} // namespace gf
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+
+#include "DeflateBlocks.h"
+
+#include <cassert>
+
+#include <chrono>
+#include <utility>
+
+#include <zlib.h>
+
+#include <gf2/core/ThreadPool.h>
+
+namespace gf::details {
+
+  namespace {
+
+    constexpr std::size_t DictionarySize = 32 * 1024;
+
+  } // namespace
+
+  DeflateBlocks::DeflateBlocks(DeflateChecksum checksum, ThreadPool* pool, Sink sink)
+  : m_kind(checksum)
+  , m_pool(pool)
+  , m_sink(std::move(sink))
+  , m_checksum(checksum == DeflateChecksum::Adler32 ? static_cast<uint32_t>(adler32(0, nullptr, 0)) : static_cast<uint32_t>(crc32(0, nullptr, 0)))
+  {
+  }
+
+  void DeflateBlocks::push(std::vector<uint8_t> data, bool last)
+  {
+    if (data.empty() && !last) {
+      return;
+    }
+
+    std::vector<uint8_t> dictionary = m_dictionary;
+
+    // keep the end of the uncompressed data as the dictionary of the next block
+    m_dictionary.insert(m_dictionary.end(), data.begin(), data.end());
+
+    if (m_dictionary.size() > DictionarySize) {
+      m_dictionary.erase(m_dictionary.begin(), m_dictionary.end() - DictionarySize);
+    }
+
+    auto compress = [data = std::move(data), dictionary = std::move(dictionary), last, kind = m_kind]() {
+      Block block;
+
+      z_stream stream = {};
+      [[maybe_unused]] int err = deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+      assert(err == Z_OK);
+
+      if (!dictionary.empty()) {
+        err = deflateSetDictionary(&stream, dictionary.data(), static_cast<uInt>(dictionary.size()));
+        assert(err == Z_OK);
+      }
+
+      block.bytes.resize(deflateBound(&stream, static_cast<uLong>(data.size())) + 16);
+      stream.next_in = data.data();
+      stream.avail_in = static_cast<uInt>(data.size());
+
+      for (;;) {
+        stream.next_out = block.bytes.data() + stream.total_out;
+        stream.avail_out = static_cast<uInt>(block.bytes.size() - stream.total_out);
+        err = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        assert(err == Z_OK || err == Z_STREAM_END || err == Z_BUF_ERROR);
+
+        if (stream.avail_out > 0) {
+          break;
+        }
+
+        block.bytes.resize(2 * block.bytes.size());
+      }
+
+      block.bytes.resize(stream.total_out);
+      deflateEnd(&stream);
+
+      if (!data.empty()) {
+        // a null buffer would reset the checksum
+        if (kind == DeflateChecksum::Adler32) {
+          block.checksum = static_cast<uint32_t>(adler32(1, data.data(), static_cast<uInt>(data.size())));
+        } else {
+          block.checksum = static_cast<uint32_t>(crc32(0, data.data(), static_cast<uInt>(data.size())));
+        }
+      }
+
+      block.size = data.size();
+      return block;
+    };
+
+    if (m_pool == nullptr) {
+      write_block(compress());
+      return;
+    }
+
+    auto pending = std::make_shared<PendingBlock>();
+    pending->task = std::packaged_task<Block()>(std::move(compress));
+    pending->result = pending->task.get_future();
+    m_pool->submit([pending]() { pending->run(); });
+    m_pending.push_back(std::move(pending));
+
+    collect_blocks(false);
+
+    // limit the memory used by the blocks in flight
+    while (m_pending.size() > 2 * m_pool->thread_count() + 1) {
+      write_front_block();
+    }
+  }
+
+  void DeflateBlocks::finish()
+  {
+    collect_blocks(true);
+  }
+
+  void DeflateBlocks::write_block(Block block)
+  {
+    if (block.size > 0) {
+      if (m_kind == DeflateChecksum::Adler32) {
+        m_checksum = static_cast<uint32_t>(adler32_combine(m_checksum, block.checksum, static_cast<z_off_t>(block.size)));
+      } else {
+        m_checksum = static_cast<uint32_t>(crc32_combine(m_checksum, block.checksum, static_cast<z_off_t>(block.size)));
+      }
+    }
+
+    m_size += block.size;
+    m_sink(block.bytes);
+  }
+
+  void DeflateBlocks::write_front_block()
+  {
+    const std::shared_ptr<PendingBlock> pending = std::move(m_pending.front());
+    m_pending.pop_front();
+    pending->run();
+    write_block(pending->result.get());
+  }
+
+  void DeflateBlocks::collect_blocks(bool wait)
+  {
+    while (!m_pending.empty()) {
+      if (!wait && m_pending.front()->result.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+        return;
+      }
+
+      write_front_block();
+    }
+  }
+
+} // namespace gf::details
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_DEFLATE_BLOCKS_H
+#define GF_DEFLATE_BLOCKS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <gf2/core/Span.h>
+
+namespace gf {
+  class ThreadPool;
+}
+
+namespace gf::details {
+
+  /*
+   * The data is split in independent raw deflate blocks, primed with the end
+   * of the previous block as a dictionary (like pigz), so that the blocks can
+   * be compressed in parallel while still producing a single deflate stream.
+   * The blocks are given to the sink in order.
+   */
+
+  enum class DeflateChecksum : uint8_t {
+    Adler32, // zlib
+    Crc32,   // gzip
+  };
+
+  class DeflateBlocks {
+  public:
+    static constexpr std::size_t BlockSize = 128 * 1024;
+
+    using Sink = std::function<void(Span<const uint8_t>)>;
+
+    DeflateBlocks(DeflateChecksum checksum, ThreadPool* pool, Sink sink);
+
+    void push(std::vector<uint8_t> data, bool last);
+    void finish();
+
+    uint32_t checksum() const
+    {
+      return m_checksum;
+    }
+
+    uint64_t size() const
+    {
+      return m_size;
+    }
+
+  private:
+    struct Block {
+      std::vector<uint8_t> bytes;
+      uint32_t checksum = 0;
+      std::size_t size = 0;
+    };
+
+    // a block is compressed by the first thread that takes it: a worker of the pool, or
+    // the writer when it waits for the block, so that a writer that runs on a thread of the
+    // pool can not wait for a block that no worker is able to compress
+    struct PendingBlock {
+      std::packaged_task<Block()> task;
+      std::future<Block> result;
+      std::atomic<bool> started = false;
+
+      void run()
+      {
+        if (!started.exchange(true)) {
+          task();
+        }
+      }
+    };
+
+    void write_block(Block block);
+    void write_front_block();
+    void collect_blocks(bool wait);
+
+    DeflateChecksum m_kind;
+    ThreadPool* m_pool = nullptr;
+    Sink m_sink;
+    std::vector<uint8_t> m_dictionary;
+    std::deque<std::shared_ptr<PendingBlock>> m_pending;
+    uint32_t m_checksum = 0;
+    uint64_t m_size = 0;
+  };
+
+} // namespace gf::details
+
+#endif // GF_DEFLATE_BLOCKS_H
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Zlib
+// Copyright (c) 2023-2025 Julien Bernard
+#ifndef GF_INFLATE_WINDOW_H
+#define GF_INFLATE_WINDOW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <vector>
+
+namespace gf::details {
+
+  /*
+   * Random access in a deflate stream is done like in zran.c from the zlib
+   * examples: the state of the decompressor is saved at block boundaries, with
+   * the last 32K of uncompressed data that are needed to restart the
+   * decompression. This class keeps these last bytes in a circular buffer.
+   */
+
+  class InflateWindow {
+  public:
+    static constexpr std::size_t Size = 32 * 1024;
+
+    void append(const uint8_t* data, std::size_t size)
+    {
+      m_total += size;
+
+      if (size >= Size) {
+        std::memcpy(m_buffer.data(), data + size - Size, Size);
+        m_offset = 0;
+        return;
+      }
+
+      const std::size_t first = std::min(size, Size - m_offset);
+      std::memcpy(m_buffer.data() + m_offset, data, first);
+      std::memcpy(m_buffer.data(), data + first, size - first);
+      m_offset = (m_offset + size) % Size;
+    }
+
+    std::vector<uint8_t> content() const
+    {
+      if (m_total < Size) {
+        return { m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_total) };
+      }
+
+      std::vector<uint8_t> content(m_buffer.begin() + static_cast<std::ptrdiff_t>(m_offset), m_buffer.end());
+      content.insert(content.end(), m_buffer.begin(), m_buffer.begin() + static_cast<std::ptrdiff_t>(m_offset));
+      return content;
+    }
+
+    void reset()
+    {
+      m_offset = 0;
+      m_total = 0;
+    }
+
+  private:
+    std::vector<uint8_t> m_buffer = std::vector<uint8_t>(Size);
+    std::size_t m_offset = 0;
+    uint64_t m_total = 0;
+  };
+
+} // namespace gf::details
+
+#endif // GF_INFLATE_WINDOW_H
@@ -5,7 +5,8 @@
 
 namespace gf {
 
-  ResourceSystem::ResourceSystem(const std::filesystem::path& asset_directory)
+  ResourceSystem::ResourceSystem(const std::filesystem::path& asset_directory, ThreadPool* pool)
+  : ResourceManager(pool)
   {
     m_file_loader.add_search_directory(asset_directory);
 
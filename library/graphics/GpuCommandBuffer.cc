@@ -166,4 +166,16 @@ namespace gf {
     SDL_UploadToGPUTexture(m_copy_pass, &source_buffer, &destination_texture, false);
   }
 
+  void GpuCopyPass::copy_buffer_to_texture(GpuTransferBuffer* source, std::size_t offset, GpuTexture* destination, uint32_t level, Vec2I size)
+  {
+    assert(m_copy_pass);
+
+    // the data is tightly packed, which also works for block compressed formats
+    const SDL_GPUTextureTransferInfo source_buffer = { source->m_handle, static_cast<Uint32>(offset), 0, 0 };
+    assert(source_buffer.transfer_buffer != nullptr);
+    const SDL_GPUTextureRegion destination_texture = { destination->m_texture_handle, level, 0, 0, 0, 0, static_cast<Uint32>(size.w), static_cast<Uint32>(size.h), 1 };
+    assert(destination_texture.texture != nullptr);
+    SDL_UploadToGPUTexture(m_copy_pass, &source_buffer, &destination_texture, false);
+  }
+
 }
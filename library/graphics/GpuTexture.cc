@@ -5,6 +5,8 @@
 
 #include <cassert>
 
+#include <vector>
+
 #include <gf2/core/Log.h>
 
 #include <gf2/graphics/RenderManager.h>
@@ -13,9 +15,52 @@ namespace gf {
 
   using namespace operators;
 
+  namespace {
+
+    GpuTextureFormat compute_texture_format(const TextureData& data, RenderManager* render_manager)
+    {
+      GpuTextureFormat format = GpuTextureFormat::R8G8B8A8_UNorm_Srgb;
+
+      switch (data.compression()) {
+        case BlockCompression::None:
+          return format;
+        case BlockCompression::Bc1:
+          format = GpuTextureFormat::BC1_RGBA_UNorm_Srgb;
+          break;
+        case BlockCompression::Bc3:
+          format = GpuTextureFormat::BC3_RGBA_UNorm_Srgb;
+          break;
+        case BlockCompression::Bc7:
+          format = GpuTextureFormat::BC7_RGBA_UNorm_Srgb;
+          break;
+      }
+
+      // some backends require the size of block compressed textures to be a multiple of the block size
+      const Vec2I size = data.size();
+
+      if (size.w % 4 != 0 || size.h % 4 != 0) {
+        return GpuTextureFormat::R8G8B8A8_UNorm_Srgb;
+      }
+
+      GpuDevice* device = render_manager->device();
+
+      if (!SDL_GPUTextureSupportsFormat(*device, static_cast<SDL_GPUTextureFormat>(format), SDL_GPU_TEXTURETYPE_2D, SDL_GPU_TEXTUREUSAGE_SAMPLER)) {
+        // the levels are decompressed on the CPU
+        return GpuTextureFormat::R8G8B8A8_UNorm_Srgb;
+      }
+
+      return format;
+    }
+
+  }
+
   GpuTexture::GpuTexture(const std::filesystem::path& filename, RenderManager* render_manager)
-  : GpuTexture(Image(filename), render_manager)
   {
+    if (filename.extension() == ".gftex") {
+      *this = GpuTexture(TextureData(filename), render_manager);
+    } else {
+      *this = GpuTexture(Image(filename), render_manager);
+    }
   }
 
   GpuTexture::GpuTexture(const Image& image, RenderManager* render_manager)
@@ -30,13 +75,54 @@ namespace gf {
     update(bitmap.raw_size(), bitmap.raw_data(), render_manager);
   }
 
+  GpuTexture::GpuTexture(const TextureData& data, RenderManager* render_manager)
+  : GpuTexture(data.size(), GpuTextureUsage::Sampler, compute_texture_format(data, render_manager), data.level_count(), render_manager)
+  {
+    // all the levels are uploaded with a single transfer buffer
+
+    std::vector<uint8_t> pixels;
+    Span<const uint8_t> payload(data.raw_data(), data.raw_size());
+    std::vector<std::size_t> offsets;
+
+    if (data.compression() != BlockCompression::None && m_format == GpuTextureFormat::R8G8B8A8_UNorm_Srgb) {
+      for (std::size_t level = 0; level < data.level_count(); ++level) {
+        const Image image = data.level_image(level);
+        offsets.push_back(pixels.size());
+        pixels.insert(pixels.end(), image.raw_data(), image.raw_data() + image.raw_size());
+      }
+
+      payload = pixels;
+    } else {
+      for (std::size_t level = 0; level < data.level_count(); ++level) {
+        offsets.push_back(static_cast<std::size_t>(data.level_data(level).data() - data.raw_data()));
+      }
+    }
+
+    GpuTransferBuffer buffer(payload.size(), render_manager);
+    buffer.update(payload.size(), payload.data());
+
+    GpuCopyPass copy_pass = render_manager->current_copy_pass();
+
+    for (std::size_t level = 0; level < data.level_count(); ++level) {
+      copy_pass.copy_buffer_to_texture(&buffer, offsets[level], this, static_cast<uint32_t>(level), data.level_size(level));
+    }
+
+    render_manager->defer_release_transfer_buffer(std::move(buffer));
+  }
+
   GpuTexture::GpuTexture(Vec2I size, RenderManager* render_manager)
   : GpuTexture(size, GpuTextureUsage::ColorTarget | GpuTextureUsage::Sampler, GpuTextureFormat::R8G8B8A8_UNorm, render_manager)
   {
   }
 
   GpuTexture::GpuTexture(Vec2I size, Flags<GpuTextureUsage> usage, GpuTextureFormat format, RenderManager* render_manager)
+  : GpuTexture(size, usage, format, 1, render_manager)
+  {
+  }
+
+  GpuTexture::GpuTexture(Vec2I size, Flags<GpuTextureUsage> usage, GpuTextureFormat format, std::size_t level_count, RenderManager* render_manager)
   : m_image_size(size)
+  , m_level_count(level_count)
   , m_usage(usage)
   , m_format(format)
   {
@@ -47,7 +133,7 @@ namespace gf {
     texture_info.width = static_cast<uint32_t>(size.w);
     texture_info.height = static_cast<uint32_t>(size.h);
     texture_info.layer_count_or_depth = 1;
-    texture_info.num_levels = 1;
+    texture_info.num_levels = static_cast<uint32_t>(m_level_count);
 
     GpuDevice* device = render_manager->device();
     m_texture_handle = { *device, SDL_CreateGPUTexture(*device, &texture_info) };
@@ -64,7 +150,7 @@ namespace gf {
       sampler_info.max_anisotropy = 0.0f;
       sampler_info.compare_op = SDL_GPU_COMPAREOP_ALWAYS;
       sampler_info.min_lod = 0.0f;
-      sampler_info.max_lod = 0.0f;
+      sampler_info.max_lod = static_cast<float>(m_level_count - 1);
       sampler_info.enable_anisotropy = false;
       sampler_info.enable_compare = false;
 
@@ -103,6 +189,49 @@ namespace gf {
     render_manager->defer_release_transfer_buffer(std::move(buffer));
   }
 
+  std::size_t GpuTexture::memory_size() const
+  {
+    BlockCompression compression = BlockCompression::None;
+    std::size_t texel_size = 4;
+
+    switch (m_format) {
+      case GpuTextureFormat::BC1_RGBA_UNorm_Srgb:
+        compression = BlockCompression::Bc1;
+        break;
+      case GpuTextureFormat::BC3_RGBA_UNorm_Srgb:
+        compression = BlockCompression::Bc3;
+        break;
+      case GpuTextureFormat::BC7_RGBA_UNorm_Srgb:
+        compression = BlockCompression::Bc7;
+        break;
+      case GpuTextureFormat::R8_UNorm:
+        texel_size = 1;
+        break;
+      case GpuTextureFormat::R32G32_Float:
+        texel_size = 8;
+        break;
+      case GpuTextureFormat::R32G32B32A32_Float:
+        texel_size = 16;
+        break;
+      default:
+        break;
+    }
+
+    std::size_t size = 0;
+
+    for (std::size_t level = 0; level < m_level_count; ++level) {
+      const Vec2I level_size = gf::max(vec(m_image_size.w >> level, m_image_size.h >> level), vec(1, 1));
+
+      if (compression == BlockCompression::None) {
+        size += static_cast<std::size_t>(level_size.w) * static_cast<std::size_t>(level_size.h) * texel_size;
+      } else {
+        size += compute_compressed_size(level_size, compression);
+      }
+    }
+
+    return size;
+  }
+
   GpuRenderTarget GpuTexture::as_render_target()
   {
     assert(m_usage.test(GpuTextureUsage::ColorTarget));
@@ -3,39 +3,199 @@
 
 #include <gf2/graphics/RenderAsync.h>
 
+#include <algorithm>
+#include <utility>
+
 #include <gf2/core/Log.h>
 
 #include <gf2/graphics/RenderManager.h>
 
 namespace gf {
-  RenderAsync::RenderAsync(RenderManager* render_manager)
+
+  /*
+   * RenderAsyncJob
+   */
+
+  void RenderAsyncJob::set_progress(float progress)
+  {
+    m_progress = std::clamp(progress, 0.0f, 1.0f);
+  }
+
+  bool RenderAsyncJob::cancelled() const
+  {
+    return m_cancelled;
+  }
+
+  float RenderAsyncJob::progress() const
+  {
+    return m_progress;
+  }
+
+  RenderAsyncStatus RenderAsyncJob::status() const
+  {
+    return m_status;
+  }
+
+  bool RenderAsyncJob::done() const
+  {
+    const RenderAsyncStatus status = m_status;
+    return status == RenderAsyncStatus::Finished || status == RenderAsyncStatus::Cancelled || status == RenderAsyncStatus::Failed;
+  }
+
+  void RenderAsyncJob::cancel()
+  {
+    m_cancelled = true;
+  }
+
+  /*
+   * RenderAsync
+   */
+
+  RenderAsync::RenderAsync(RenderManager* render_manager, std::size_t thread_count)
   : m_render_manager(render_manager)
+  , m_pool(thread_count)
   {
   }
 
-  void RenderAsync::run_async(std::function<void()> function)
+  RenderAsync::~RenderAsync()
+  {
+    cancel_all();
+
+    std::vector<std::shared_ptr<RenderAsyncJob>> jobs;
+
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+      jobs = std::exchange(m_jobs, {});
+    }
+
+    complete_jobs(jobs); // the errors of the cancelled jobs are ignored
+  }
+
+  std::shared_ptr<RenderAsyncJob> RenderAsync::submit(std::function<void(RenderAsyncJob&)> function)
   {
-    m_clock.restart();
+    auto job = std::make_shared<RenderAsyncJob>();
+    job->m_function = std::move(function);
+
     m_render_manager->prepare_asynchronous_load();
+    job->m_result = m_pool.submit([this, job = job.get()]() { run_job(*job); });
+
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (m_jobs.empty()) {
+      m_clock.restart();
+    }
+
+    m_jobs.push_back(job);
+    return job;
+  }
+
+  void RenderAsync::run_async(std::function<void()> function)
+  {
+    submit([function = std::move(function)]([[maybe_unused]] RenderAsyncJob& job) { function(); });
+  }
+
+  void RenderAsync::cancel_all()
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    for (const auto& job : m_jobs) {
+      job->cancel();
+    }
+  }
+
+  std::size_t RenderAsync::pending_count() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+    return static_cast<std::size_t>(std::count_if(m_jobs.begin(), m_jobs.end(), [](const auto& job) { return !job->done(); }));
+  }
+
+  float RenderAsync::progress() const
+  {
+    const std::scoped_lock<std::mutex> lock(m_mutex);
+
+    if (m_jobs.empty()) {
+      return 1.0f;
+    }
+
+    float progress = 0.0f;
+
+    for (const auto& job : m_jobs) {
+      progress += job->done() ? 1.0f : job->progress();
+    }
 
-    m_result = std::async(std::launch::async, [&, function = std::move(function)]() {
-      m_render_manager->begin_asynchronous_load();
-      function();
-      m_render_manager->end_asynchronous_load();
-    });
+    return progress / static_cast<float>(m_jobs.size());
   }
 
   bool RenderAsync::finished()
   {
-    if (m_result.valid() && m_result.wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
-      m_result.get();
+    std::vector<std::shared_ptr<RenderAsyncJob>> jobs;
+    Time time;
+
+    {
+      const std::scoped_lock<std::mutex> lock(m_mutex);
+
+      if (m_jobs.empty() || !std::all_of(m_jobs.begin(), m_jobs.end(), [](const auto& job) { return job->done(); })) {
+        return false;
+      }
+
+      // the jobs are taken with the same lock, a job submitted in the meantime is not completed before it is done
+      jobs = std::exchange(m_jobs, {});
+      time = m_clock.restart();
+    }
+
+    if (std::exception_ptr exception = complete_jobs(jobs); exception) {
+      std::rethrow_exception(exception);
+    }
+
+    Log::info("Asynchronous loading finished in {}ms", time.as_milliseconds());
+    return true;
+  }
+
+  void RenderAsync::run_job(RenderAsyncJob& job)
+  {
+    if (job.m_cancelled) {
+      job.m_status = RenderAsyncStatus::Cancelled;
+      return;
+    }
+
+    job.m_status = RenderAsyncStatus::Running;
+
+    // the uploads of the job are batched in a single copy pass
+    m_render_manager->begin_asynchronous_load();
+
+    try {
+      job.m_function(job);
+    } catch (...) {
+      job.m_exception = std::current_exception();
+    }
+
+    m_render_manager->end_asynchronous_load();
+    job.m_function = nullptr;
+
+    if (job.m_exception) {
+      job.m_status = RenderAsyncStatus::Failed;
+    } else if (job.m_cancelled) {
+      job.m_status = RenderAsyncStatus::Cancelled;
+    } else {
+      job.m_progress = 1.0f;
+      job.m_status = RenderAsyncStatus::Finished;
+    }
+  }
+
+  std::exception_ptr RenderAsync::complete_jobs(const std::vector<std::shared_ptr<RenderAsyncJob>>& jobs)
+  {
+    std::exception_ptr exception;
+
+    for (const auto& job : jobs) {
+      job->m_result.wait();
       m_render_manager->finish_asynchronous_load();
-      auto time = m_clock.restart();
-      Log::info("Asynchronous loading finished in {}ms", time.as_milliseconds());
-      return true;
+
+      if (job->m_exception && !exception) {
+        exception = job->m_exception;
+      }
     }
 
-    return false;
+    return exception;
   }
 
 }
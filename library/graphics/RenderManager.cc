@@ -3,6 +3,8 @@
 
 #include <gf2/graphics/RenderManager.h>
 
+#include <cassert>
+
 #include <thread>
 #include <utility>
 
@@ -166,8 +168,10 @@ namespace gf {
       return m_memops[m_current_memops].copy_pass;
     }
 
-    assert(m_async_loading);
-    return m_async_memops.copy_pass;
+    const std::scoped_lock<std::mutex> lock(m_async_mutex);
+    auto iterator = m_async_memops.find(std::this_thread::get_id());
+    assert(iterator != m_async_memops.end());
+    return iterator->second.memops.copy_pass;
   }
 
   void RenderManager::defer_release_transfer_buffer(GpuTransferBuffer buffer)
@@ -177,41 +181,56 @@ namespace gf {
       return;
     }
 
-    assert(m_async_loading);
-    m_async_staging_buffers.push_back(std::move(buffer));
+    const std::scoped_lock<std::mutex> lock(m_async_mutex);
+    auto iterator = m_async_memops.find(std::this_thread::get_id());
+    assert(iterator != m_async_memops.end());
+    iterator->second.staging_buffers.push_back(std::move(buffer));
   }
 
   void RenderManager::prepare_asynchronous_load()
   {
-    assert(!m_async_loading);
-    m_async_loading = true;
+    const std::scoped_lock<std::mutex> lock(m_async_mutex);
+    ++m_async_loads;
   }
 
   void RenderManager::begin_asynchronous_load()
   {
-    assert(m_async_loading);
+    assert(m_thread_id != std::this_thread::get_id());
+
+    // acquiring a command buffer is thread-safe, the copy pass is only recorded by this thread
+    AsyncMemOps async_memops;
+    async_memops.memops.command_buffer = SDL_AcquireGPUCommandBuffer(m_device);
+    async_memops.memops.copy_pass = SDL_BeginGPUCopyPass(async_memops.memops.command_buffer);
 
-    m_async_memops.command_buffer = SDL_AcquireGPUCommandBuffer(m_device);
-    m_async_memops.copy_pass = SDL_BeginGPUCopyPass(m_async_memops.command_buffer);
+    const std::scoped_lock<std::mutex> lock(m_async_mutex);
+    assert(m_async_loads > 0);
+    [[maybe_unused]] auto [iterator, inserted] = m_async_memops.emplace(std::this_thread::get_id(), std::move(async_memops));
+    assert(inserted);
   }
 
   void RenderManager::end_asynchronous_load()
   {
-    assert(m_async_loading);
+    AsyncMemOps async_memops;
 
-    SDL_EndGPUCopyPass(m_async_memops.copy_pass);
-    SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(m_async_memops.command_buffer);
+    {
+      const std::scoped_lock<std::mutex> lock(m_async_mutex);
+      auto node = m_async_memops.extract(std::this_thread::get_id());
+      assert(!node.empty());
+      async_memops = std::move(node.mapped());
+    }
+
+    SDL_EndGPUCopyPass(async_memops.memops.copy_pass);
+    SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(async_memops.memops.command_buffer);
 
     SDL_WaitForGPUFences(m_device, true, &fence, 1);
     SDL_ReleaseGPUFence(m_device, fence);
-
-    m_async_staging_buffers.clear();
   }
 
   void RenderManager::finish_asynchronous_load()
   {
-    assert(m_async_loading);
-    m_async_loading = false;
+    const std::scoped_lock<std::mutex> lock(m_async_mutex);
+    assert(m_async_loads > 0);
+    --m_async_loads;
   }
 
   GpuRenderTarget RenderManager::current_render_target() const
@@ -7,6 +7,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <utility>
 
 #include <gf2/core/Clock.h>
 
@@ -79,6 +80,9 @@ namespace gf {
       }
     };
 
+    // thrown by the progress of a preload to stop its plan
+    struct PreloadCancelled { };
+
   }
 
   /*
@@ -362,6 +366,7 @@ namespace gf {
 
   SceneManager::SceneManager(const std::string& title, Vec2I size, Flags<WindowHints> hints)
   : BasicSceneManager(title, size, hints)
+  , m_preload_async(render_manager())
   {
   }
 
@@ -436,6 +441,12 @@ namespace gf {
 
         command_buffer.end_render_pass(render_pass);
         render_manager()->end_command_buffer(command_buffer);
+
+        // preloads
+
+        if (!m_preloads.empty()) {
+          swap_preloaded_scenes();
+        }
       }
     }
 
@@ -443,6 +454,159 @@ namespace gf {
     return EXIT_SUCCESS;
   }
 
+  std::shared_ptr<RenderAsyncJob> SceneManager::preload_scene(std::function<BasicScene*(RenderAsyncJob&)> loader, SceneTransition transition, std::function<void()> on_swap, std::function<void(BasicScene*)> on_discard)
+  {
+    auto preload = std::make_shared<ScenePreload>();
+    preload->transition = transition;
+    preload->on_swap = std::move(on_swap);
+    preload->on_discard = std::move(on_discard);
+    return submit_preload(std::move(preload), std::move(loader));
+  }
+
+  std::shared_ptr<RenderAsyncJob> SceneManager::preload_scene(ResourceBundle bundle, ResourceManager* resource_manager, std::function<BasicScene*()> factory, SceneTransition transition, std::function<void()> on_swap, std::function<void(BasicScene*)> on_discard)
+  {
+    // the bundle is shared with the release of the preload, that unloads it if the scene is built but not swapped in
+    auto shared_bundle = std::make_shared<ResourceBundle>(std::move(bundle));
+
+    auto loader = [bundle = shared_bundle, resource_manager, factory = std::move(factory)](RenderAsyncJob& job) -> BasicScene* {
+      // the GPU resources are uploaded in the copy pass of this thread, so the bundle is loaded on this thread only
+      try {
+        bundle->load_from(resource_manager, nullptr, [&job](std::size_t loaded, std::size_t total) {
+          if (job.cancelled()) {
+            throw PreloadCancelled();
+          }
+
+          job.set_progress(0.9f * static_cast<float>(loaded) / static_cast<float>(total));
+        });
+      } catch (const PreloadCancelled&) {
+        // the resources already loaded by the plan have been unloaded
+        return nullptr;
+      }
+
+      if (job.cancelled()) {
+        bundle->unload_from(resource_manager);
+        return nullptr;
+      }
+
+      BasicScene* scene = nullptr;
+
+      try {
+        scene = factory();
+      } catch (...) {
+        bundle->unload_from(resource_manager);
+        throw;
+      }
+
+      if (scene == nullptr) {
+        bundle->unload_from(resource_manager);
+      }
+
+      return scene;
+    };
+
+    auto preload = std::make_shared<ScenePreload>();
+    preload->transition = transition;
+    preload->on_swap = std::move(on_swap);
+    preload->on_discard = std::move(on_discard);
+    preload->release = [bundle = std::move(shared_bundle), resource_manager]() { bundle->unload_from(resource_manager); };
+    return submit_preload(std::move(preload), std::move(loader));
+  }
+
+  bool SceneManager::preloading() const
+  {
+    return !m_preloads.empty();
+  }
+
+  float SceneManager::preload_progress() const
+  {
+    return m_preload_async.progress();
+  }
+
+  void SceneManager::cancel_preloads()
+  {
+    m_preload_async.cancel_all();
+  }
+
+  std::shared_ptr<RenderAsyncJob> SceneManager::submit_preload(std::shared_ptr<ScenePreload> preload, std::function<BasicScene*(RenderAsyncJob&)> loader)
+  {
+    // the preloads are destroyed after m_preload_async, that waits for the jobs
+    preload->job = m_preload_async.submit([preload = preload.get(), loader = std::move(loader)](RenderAsyncJob& job) {
+      preload->scene = loader(job);
+    });
+
+    m_preloads.push_back(std::move(preload));
+    return m_preloads.back()->job;
+  }
+
+  void SceneManager::swap_preloaded_scenes()
+  {
+    bool finished = false;
+
+    try {
+      finished = m_preload_async.finished();
+    } catch (...) {
+      // all the jobs are done, the scenes built by the other preloads are not swapped in
+      for (const auto& preload : std::exchange(m_preloads, {})) {
+        discard_preloaded_scene(*preload);
+      }
+
+      throw;
+    }
+
+    if (!finished) {
+      return;
+    }
+
+    // the preloads are swapped in the order of their submission
+    std::vector<std::shared_ptr<ScenePreload>> preloads = std::exchange(m_preloads, {});
+
+    for (const auto& preload : preloads) {
+      if (preload->scene == nullptr) {
+        continue;
+      }
+
+      if (preload->job->status() != RenderAsyncStatus::Finished) {
+        // cancelled after the scene was built
+        discard_preloaded_scene(*preload);
+        continue;
+      }
+
+      switch (preload->transition) {
+        case SceneTransition::Push:
+          push_scene(preload->scene);
+          break;
+        case SceneTransition::Replace:
+          replace_scene(preload->scene);
+          break;
+        case SceneTransition::ReplaceAll:
+          replace_all_scenes(preload->scene);
+          break;
+      }
+
+      if (preload->on_swap) {
+        preload->on_swap();
+      }
+    }
+  }
+
+  void SceneManager::discard_preloaded_scene(ScenePreload& preload)
+  {
+    BasicScene* scene = std::exchange(preload.scene, nullptr);
+
+    if (scene == nullptr) {
+      return;
+    }
+
+    // the scene is given back before its resources are unloaded
+    if (preload.on_discard) {
+      preload.on_discard(scene);
+    }
+
+    if (preload.release) {
+      preload.release();
+    }
+  }
+
   void SceneManager::push_scene(BasicScene* scene)
   {
     if (scene == nullptr) {
@@ -134,7 +134,7 @@ namespace gf {
         for (auto position : gf::position_range(chunk_rectangle.size())) {
           position += chunk_rectangle.position();
 
-          const MapTile tile = raw_tile_layer.tiles(position);
+          const MapTile tile = raw_tile_layer.tile(position);
 
           if (tile.gid == 0) {
             continue;
@@ -8,6 +8,7 @@
 #include <cstdint>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <type_traits>
 
@@ -64,11 +65,17 @@ namespace gf {
     }
 
     for (auto& vertex : vertices) {
-      const ImColor raw_sgrb_color(vertex.col);
-      const Color srgb_color(raw_sgrb_color.Value.x, raw_sgrb_color.Value.y, raw_sgrb_color.Value.z, raw_sgrb_color.Value.w);
-      const Color linear_color = gf::srgb_to_linear(srgb_color);
-      const ImColor raw_linear_color(linear_color.r, linear_color.g, linear_color.b, linear_color.a);
-      vertex.col = raw_linear_color;
+      // the channels are extracted with the shifts of imgui, so that the conversion does not depend on the endianness
+      const std::array<uint8_t, 4> srgb_color = {
+        static_cast<uint8_t>(vertex.col >> IM_COL32_R_SHIFT),
+        static_cast<uint8_t>(vertex.col >> IM_COL32_G_SHIFT),
+        static_cast<uint8_t>(vertex.col >> IM_COL32_B_SHIFT),
+        static_cast<uint8_t>(vertex.col >> IM_COL32_A_SHIFT),
+      };
+
+      std::array<uint8_t, 4> linear_color = {};
+      gf::srgb_to_linear_rgba32(Span<const uint8_t>(srgb_color.data(), srgb_color.size()), Span<uint8_t>(linear_color.data(), linear_color.size()));
+      vertex.col = (ImU32(linear_color[0]) << IM_COL32_R_SHIFT) | (ImU32(linear_color[1]) << IM_COL32_G_SHIFT) | (ImU32(linear_color[2]) << IM_COL32_B_SHIFT) | (ImU32(linear_color[3]) << IM_COL32_A_SHIFT);
     }
 
     assert(vertices.size() == static_cast<std::size_t>(data->TotalVtxCount));
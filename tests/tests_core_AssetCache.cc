@@ -0,0 +1,247 @@
+#include <gf2/core/AssetCache.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <gf2/core/ResourceLoaders.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/TypeTraits.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  int g_decode_count = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+  struct DerivedText {
+    DerivedText() = default;
+
+    DerivedText(const std::filesystem::path& filename)
+    {
+      ++g_decode_count;
+      gf::MappedFileInputStream file(filename);
+      const gf::Span<const uint8_t> memory = file.memory();
+      text.assign(memory.begin(), memory.end());
+      text += " (derived)";
+    }
+
+    std::string text;
+  };
+
+  template<typename Archive>
+  Archive& operator|(Archive& ar, gf::MaybeConst<DerivedText, Archive>& data)
+  {
+    return ar | data.text;
+  }
+
+  std::filesystem::path create_cache_directory(const char* name)
+  {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    return directory;
+  }
+
+  void write_file(const std::filesystem::path& filename, const std::string& content)
+  {
+    gf::FileOutputStream file(filename);
+    file.write(gf::Span<const uint8_t>(reinterpret_cast<const uint8_t*>(content.data()), content.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  gf::SecureHash::Hash compute_key(uint32_t parameter)
+  {
+    gf::AssetCacheKey key("test", 1);
+    key.add_parameter(parameter);
+    return key.result();
+  }
+
+}
+
+template<>
+struct gf::AssetCacheTraits<DerivedText> {
+  static constexpr bool Enabled = true;
+  static constexpr std::string_view Processor = "DerivedText";
+  static constexpr uint16_t Version = 1;
+  static constexpr uint16_t ArchiveVersion = 0;
+};
+
+TEST(AssetCacheTest, Key) {
+  EXPECT_EQ(compute_key(1), compute_key(1));
+  EXPECT_NE(compute_key(1), compute_key(2));
+
+  gf::AssetCacheKey key1("test", 1);
+  gf::AssetCacheKey key2("test", 2);
+  EXPECT_NE(key1.result(), key2.result());
+}
+
+TEST(AssetCacheTest, Roundtrip) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache");
+  const std::vector<std::string> value = { "foo", "bar", "baz" };
+
+  {
+    gf::AssetCache cache(directory);
+    EXPECT_EQ(cache.entry_count(), 0);
+
+    std::vector<std::string> loaded;
+    EXPECT_FALSE(cache.load(compute_key(1), loaded));
+
+    cache.store(compute_key(1), value);
+    EXPECT_TRUE(cache.contains(compute_key(1)));
+    EXPECT_EQ(cache.entry_count(), 1);
+    EXPECT_GT(cache.size(), 0);
+  }
+
+  // the entries persist across runs
+
+  {
+    gf::AssetCache cache(directory);
+    EXPECT_EQ(cache.entry_count(), 1);
+
+    std::vector<std::string> loaded;
+    EXPECT_TRUE(cache.load(compute_key(1), loaded));
+    EXPECT_EQ(loaded, value);
+
+    int compute_count = 0;
+    const std::vector<std::string> computed = cache.load_or_compute<std::vector<std::string>>(compute_key(2), [&]() {
+      ++compute_count;
+      return value;
+    });
+    EXPECT_EQ(computed, value);
+    EXPECT_EQ(compute_count, 1);
+
+    cache.load_or_compute<std::vector<std::string>>(compute_key(2), [&]() {
+      ++compute_count;
+      return value;
+    });
+    EXPECT_EQ(compute_count, 1);
+
+    cache.clear();
+    EXPECT_EQ(cache.entry_count(), 0);
+    EXPECT_EQ(cache.size(), 0);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(AssetCacheTest, ArchiveVersion) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache_version");
+  const std::vector<std::string> value = { "foo", "bar", "baz" };
+
+  gf::AssetCache cache(directory);
+  cache.store(compute_key(1), value, 2);
+
+  std::vector<std::string> loaded;
+  EXPECT_FALSE(cache.load(compute_key(1), loaded, 1));
+  EXPECT_TRUE(loaded.empty());
+
+  EXPECT_TRUE(cache.load(compute_key(1), loaded, 2));
+  EXPECT_EQ(loaded, value);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(AssetCacheTest, Corrupted) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache_corrupted");
+
+  {
+    gf::AssetCache cache(directory);
+    cache.store_raw(compute_key(1), std::vector<uint8_t>(100, 42));
+  }
+
+  for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+    write_file(entry.path(), "garbage");
+  }
+
+  gf::AssetCache cache(directory);
+  EXPECT_EQ(cache.entry_count(), 1);
+  EXPECT_FALSE(cache.load_raw(compute_key(1)));
+  EXPECT_EQ(cache.entry_count(), 0);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(AssetCacheTest, MissingEntry) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache_missing");
+
+  gf::AssetCache cache(directory);
+  cache.store_raw(compute_key(1), std::vector<uint8_t>(100, 42));
+  EXPECT_EQ(cache.entry_count(), 1);
+
+  // removed behind the back of the cache
+  std::filesystem::remove_all(directory);
+
+  EXPECT_FALSE(cache.load_raw(compute_key(1)));
+  EXPECT_EQ(cache.entry_count(), 0);
+
+  // the directory does not exist anymore, nothing is stored
+  cache.store_raw(compute_key(2), std::vector<uint8_t>(100, 42));
+  EXPECT_FALSE(cache.contains(compute_key(2)));
+  EXPECT_EQ(cache.entry_count(), 0);
+}
+
+TEST(AssetCacheTest, LeastRecentlyUsed) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache_lru");
+
+  gf::AssetCache cache(directory);
+  cache.store_raw(compute_key(1), std::vector<uint8_t>(100, 1));
+  const std::size_t entry_size = cache.size();
+  cache.set_size_limit(2 * entry_size);
+
+  cache.store_raw(compute_key(2), std::vector<uint8_t>(100, 2));
+  EXPECT_EQ(cache.entry_count(), 2);
+
+  // 1 becomes more recently used than 2
+  EXPECT_TRUE(cache.load_raw(compute_key(1)));
+
+  cache.store_raw(compute_key(3), std::vector<uint8_t>(100, 3));
+  EXPECT_EQ(cache.entry_count(), 2);
+  EXPECT_LE(cache.size(), cache.size_limit());
+  EXPECT_TRUE(cache.contains(compute_key(1)));
+  EXPECT_FALSE(cache.contains(compute_key(2)));
+  EXPECT_TRUE(cache.contains(compute_key(3)));
+
+  cache.set_size_limit(0);
+  EXPECT_EQ(cache.entry_count(), 0);
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(AssetCacheTest, Loader) {
+  const std::filesystem::path directory = create_cache_directory("gf2_tests_asset_cache_loader");
+  const std::filesystem::path assets = directory / "assets";
+  std::filesystem::create_directories(assets);
+  write_file(assets / "a.txt", "foo");
+
+  gf::AssetCache cache(directory / "cache");
+  g_decode_count = 0;
+
+  {
+    gf::FileLoader loader;
+    loader.add_search_directory(assets);
+    loader.set_asset_cache(&cache);
+
+    auto resource = loader.operator()<DerivedText>("a.txt");
+    ASSERT_TRUE(resource);
+    EXPECT_EQ(resource->text, "foo (derived)");
+    EXPECT_EQ(g_decode_count, 1);
+  }
+
+  {
+    gf::FileLoader loader;
+    loader.add_search_directory(assets);
+    loader.set_asset_cache(&cache);
+
+    auto resource = loader.operator()<DerivedText>("a.txt");
+    ASSERT_TRUE(resource);
+    EXPECT_EQ(resource->text, "foo (derived)");
+    EXPECT_EQ(g_decode_count, 1);
+
+    // the source changed, the resource is decoded again
+    write_file(assets / "a.txt", "bar");
+    resource = loader.operator()<DerivedText>("a.txt");
+    EXPECT_EQ(resource->text, "bar (derived)");
+    EXPECT_EQ(g_decode_count, 2);
+  }
+
+  std::filesystem::remove_all(directory);
+}
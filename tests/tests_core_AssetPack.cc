@@ -0,0 +1,201 @@
+#include <gf2/core/AssetPack.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gf2/core/ResourceLoaders.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  using PackEntry = std::pair<std::string, std::vector<uint8_t>>;
+
+  std::vector<uint8_t> create_content(std::size_t size, uint32_t seed)
+  {
+    std::vector<uint8_t> content(size);
+
+    for (uint8_t& byte : content) {
+      seed = seed * 1664525u + 1013904223u;
+      byte = static_cast<uint8_t>(seed >> 24);
+    }
+
+    return content;
+  }
+
+  std::vector<PackEntry> create_entries()
+  {
+    return {
+      { "a.txt", std::vector<uint8_t>(5000, 'a') },
+      { "dir/big.bin", create_content(300 * 1024, 2) },
+      { "dir/c.txt", create_content(3000, 3) },
+      { "empty.txt", {} },
+    };
+  }
+
+  struct Text {
+    Text(gf::InputStream& stream)
+    {
+      const gf::Span<const uint8_t> memory = stream.view();
+      content.assign(memory.begin(), memory.end());
+    }
+
+    std::vector<uint8_t> content;
+  };
+
+}
+
+TEST(AssetPackTest, Roundtrip) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_pack.gfpack";
+  const std::vector<PackEntry> entries = create_entries();
+  gf::ThreadPool pool(2);
+
+  gf::AssetPackWriter writer;
+
+  for (const auto& [name, content] : entries) {
+    writer.add_entry(name, content);
+  }
+
+  writer.save(file, &pool);
+
+  {
+    const gf::AssetPack pack(file);
+    ASSERT_EQ(pack.entries().size(), entries.size());
+
+    for (const auto& [name, content] : entries) {
+      EXPECT_EQ(pack.extract(name), content);
+      EXPECT_TRUE(pack.verify(name));
+    }
+
+    EXPECT_EQ(pack.extract("dir/../a.txt"), entries[0].second);
+    EXPECT_TRUE(pack.extract("missing.txt").empty());
+    EXPECT_FALSE(pack.verify("missing.txt"));
+
+    // repetitive content is compressed, random content is stored as is and aligned
+    EXPECT_TRUE(pack.extract_view("a.txt").empty());
+
+    const gf::Span<const uint8_t> view = pack.extract_view("dir/big.bin");
+    ASSERT_EQ(view.size(), entries[1].second.size());
+    EXPECT_TRUE(std::equal(view.begin(), view.end(), entries[1].second.begin()));
+
+    for (const gf::AssetPackEntry& entry : pack.raw_entries()) {
+      EXPECT_TRUE(entry.flags.test(gf::AssetPackFlag::Hashed));
+      EXPECT_EQ(entry.flags.test(gf::AssetPackFlag::Compressed), pack.entry_path(entry) == "a.txt");
+
+      if (entry.size >= 64 * 1024) {
+        EXPECT_EQ(entry.offset % 4096, 0u);
+      }
+    }
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(AssetPackTest, Corrupted) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_pack_corrupted.gfpack";
+  const std::vector<uint8_t> content = create_content(1000, 7);
+
+  gf::AssetPackWriter writer;
+  writer.add_entry("data.bin", content, gf::AssetPackFlag::Hashed);
+  writer.save(file);
+
+  std::vector<uint8_t> bytes;
+
+  {
+    const gf::MappedFileInputStream input(file);
+    bytes.assign(input.memory().begin(), input.memory().end());
+  }
+
+  // the payload of the only entry is at the end of the pack
+  bytes.back() ^= 0xFF;
+
+  {
+    gf::FileOutputStream output(file);
+    output.write(bytes);
+  }
+
+  {
+    const gf::AssetPack pack(file);
+    EXPECT_FALSE(pack.verify("data.bin"));
+    EXPECT_ANY_THROW(pack.extract("data.bin"));
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(AssetPackTest, OriginalSize) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_pack_original_size.gfpack";
+
+  gf::AssetPackWriter writer;
+  writer.add_entry("data.bin", std::vector<uint8_t>(100000, 'a'), gf::AssetPackFlag::Compressed);
+  writer.save(file);
+
+  std::vector<uint8_t> bytes;
+
+  {
+    const gf::MappedFileInputStream input(file);
+    bytes.assign(input.memory().begin(), input.memory().end());
+  }
+
+  // the offset of the toc is after the tag, the version, the entry count and the string table in the header
+  uint64_t toc_offset = 0;
+  std::memcpy(&toc_offset, bytes.data() + 32, sizeof(toc_offset));
+
+  // a size that could not be allocated
+  const uint64_t original_size = UINT64_C(1) << 60;
+  std::memcpy(bytes.data() + toc_offset + offsetof(gf::AssetPackEntry, original_size), &original_size, sizeof(original_size));
+
+  {
+    gf::FileOutputStream output(file);
+    output.write(bytes);
+  }
+
+  EXPECT_ANY_THROW(gf::AssetPack pack(file));
+
+  std::filesystem::remove(file);
+}
+
+TEST(AssetPackTest, WriteFailure) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_pack_missing" / "pack.gfpack";
+  std::filesystem::remove_all(file.parent_path());
+
+  gf::AssetPackWriter writer;
+  writer.add_entry("data.bin", create_content(1000, 7));
+  EXPECT_ANY_THROW(writer.save(file));
+}
+
+TEST(AssetPackTest, Loader) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_pack_loader.gfpack";
+  const std::vector<PackEntry> entries = create_entries();
+
+  gf::AssetPackWriter writer;
+
+  for (const auto& [name, content] : entries) {
+    writer.add_entry(name, content);
+  }
+
+  writer.save(file);
+
+  {
+    gf::PackLoader loader(file);
+
+    auto compressed = loader.operator()<Text>("a.txt");
+    ASSERT_NE(compressed, nullptr);
+    EXPECT_EQ(compressed->content, entries[0].second);
+
+    auto uncompressed = loader.operator()<Text>("dir/c.txt");
+    ASSERT_NE(uncompressed, nullptr);
+    EXPECT_EQ(uncompressed->content, entries[2].second);
+
+    EXPECT_EQ(loader.operator()<Text>("missing.txt"), nullptr);
+  }
+
+  std::filesystem::remove(file);
+}
@@ -0,0 +1,204 @@
+#include <gf2/core/Blob.h>
+
+#include <cstdint>
+
+#include <filesystem>
+#include <vector>
+
+#include <gf2/core/Property.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/TiledMapView.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  constexpr uint32_t TestTag = 0x12345678;
+
+  struct Node {
+    int32_t value;
+    gf::BlobString name;
+    gf::BlobArray<double> data;
+  };
+
+  gf::TiledMap create_map()
+  {
+    gf::TiledMap map;
+    map.type = "level";
+    map.orientation = gf::GridOrientation::Orthogonal;
+    map.map_size = { 4, 3 };
+    map.tile_size = { 16, 16 };
+
+    gf::PropertyMap properties;
+    properties.add_property("difficulty", int64_t(3));
+    properties.add_property("title", std::string("first"));
+    map.properties.push_back(std::move(properties));
+    map.properties_index = 0;
+
+    gf::MapTileset tileset;
+    tileset.first_gid = 1;
+    tileset.tile_size = { 16, 16 };
+    tileset.texture_index = 0;
+    tileset.tiles.push_back({ gf::NoIndex, 5, "wall", std::nullopt });
+    tileset.tiles.push_back({ gf::NoIndex, 6, "door", 2 });
+    map.tilesets.push_back(tileset);
+    tileset.first_gid = 100;
+    map.tilesets.push_back(tileset);
+
+    gf::MapTileLayer tile_layer;
+    tile_layer.layer = { gf::NoIndex, true, "ground", "", { 0, 0 } };
+    tile_layer.tiles = gf::Array2D<gf::MapTile>(map.map_size);
+
+    for (const std::size_t index : tile_layer.tiles.index_range()) {
+      tile_layer.tiles[index].gid = static_cast<uint32_t>(index + 1);
+    }
+
+    tile_layer.tiles({ 3, 2 }).flip = gf::CellFlip::Horizontally;
+    map.tile_layers.push_back(std::move(tile_layer));
+
+    gf::MapObjectLayer object_layer;
+    object_layer.layer = { gf::NoIndex, false, "objects", "spawn", { 1, 2 } };
+    gf::MapObject object;
+    object.name = "polygon";
+    object.object_type = gf::MapObjectType::Polygon;
+    object.location = { 10.0f, 20.0f };
+    object.feature = std::vector<gf::Vec2F>{ { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.0f, 1.0f } };
+    object_layer.objects.push_back(object);
+    object.name = "point";
+    object.object_type = gf::MapObjectType::Point;
+    object.feature = std::monostate{};
+    object_layer.objects.push_back(object);
+    map.object_layers.push_back(std::move(object_layer));
+
+    map.group_layers.push_back({ { gf::NoIndex, true, "group", "", { 0, 0 } }, { { gf::MapLayerType::Object, 0 } } });
+    map.layers = { { gf::MapLayerType::Tile, 0 }, { gf::MapLayerType::Group, 0 } };
+    map.textures.emplace_back("tiles.png");
+
+    return map;
+  }
+
+}
+
+TEST(BlobTest, WriteAndView) {
+  gf::BlobWriter writer(TestTag, 2);
+
+  Node root = {};
+  root.value = 42;
+  root.name = writer.add_string("root");
+  root.data = writer.add_array(std::vector<double>{ 1.0, 2.5, -3.0 });
+  writer.finish(root);
+
+  const std::vector<uint8_t> bytes = writer.bytes();
+  const gf::BlobView view(bytes, TestTag);
+
+  EXPECT_EQ(view.version(), 2);
+  const Node& node = view.root<Node>();
+  EXPECT_EQ(node.value, 42);
+  EXPECT_EQ(view.string(node.name), "root");
+
+  const gf::Span<const double> data = view.array(node.data);
+  ASSERT_EQ(data.size(), 3u);
+  EXPECT_EQ(data[1], 2.5);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(data.data()) % alignof(double), 0u);
+}
+
+TEST(BlobTest, Invalid) {
+  gf::BlobWriter writer(TestTag);
+  writer.finish(Node{});
+  const std::vector<uint8_t> bytes = writer.bytes();
+
+  EXPECT_THROW(gf::BlobView(bytes, TestTag + 1), std::runtime_error);
+  EXPECT_THROW(gf::BlobView(gf::Span<const uint8_t>(bytes.data(), 8), TestTag), std::runtime_error);
+
+  const gf::BlobView view(bytes, TestTag);
+  EXPECT_THROW(view.array(gf::BlobArray<double>{ 8, 1000 }), std::runtime_error);
+}
+
+TEST(TiledMapViewTest, RoundTrip) {
+  const gf::TiledMap map = create_map();
+
+  std::vector<uint8_t> bytes;
+
+  {
+    gf::BufferOutputStream stream(&bytes);
+    gf::TiledMapView::save(map, stream);
+  }
+
+  const gf::TiledMapView view(bytes);
+  const gf::TiledMapBlob& blob = view.map();
+
+  EXPECT_EQ(view[blob.type], "level");
+  EXPECT_EQ(blob.map_size, map.map_size);
+  ASSERT_EQ(view[blob.tile_layers].size(), 1u);
+
+  const gf::MapTileLayerBlob& tile_layer = view[blob.tile_layers][0];
+  EXPECT_EQ(view[tile_layer.layer.name], "ground");
+  EXPECT_EQ(view.tile(tile_layer, { 1, 1 }).gid, 6u);
+  EXPECT_TRUE(view.tile(tile_layer, { 3, 2 }).flip.test(gf::CellFlip::Horizontally));
+
+  ASSERT_NE(view.tileset_from_gid(120), nullptr);
+  EXPECT_EQ(view.tileset_from_gid(120)->first_gid, 100u);
+  EXPECT_EQ(view.tileset_from_gid(12)->first_gid, 1u);
+
+  EXPECT_EQ(view.properties(0)("difficulty").as_int(), 3);
+  EXPECT_TRUE(view.properties(gf::NoIndex).empty());
+
+  const gf::TiledMap loaded = view.to_map();
+  EXPECT_EQ(loaded.type, map.type);
+  EXPECT_EQ(loaded.properties, map.properties);
+  ASSERT_EQ(loaded.tilesets.size(), 2u);
+  EXPECT_EQ(loaded.tilesets[0].tiles[1].type, "door");
+  EXPECT_EQ(loaded.tilesets[0].tiles[1].objects, 2u);
+  EXPECT_FALSE(loaded.tilesets[0].tiles[0].objects.has_value());
+  ASSERT_EQ(loaded.tile_layers.size(), 1u);
+  EXPECT_EQ(loaded.tile_layers[0].tiles.size(), map.map_size);
+  EXPECT_EQ(loaded.tile_layers[0].tiles({ 2, 2 }).gid, map.tile_layers[0].tiles({ 2, 2 }).gid);
+  ASSERT_EQ(loaded.object_layers.size(), 1u);
+  EXPECT_EQ(loaded.object_layers[0].layer.offset, gf::vec(1, 2));
+  EXPECT_FALSE(loaded.object_layers[0].layer.visible);
+  ASSERT_EQ(loaded.object_layers[0].objects.size(), 2u);
+  EXPECT_EQ(std::get<std::vector<gf::Vec2F>>(loaded.object_layers[0].objects[0].feature).size(), 3u);
+  EXPECT_TRUE(std::holds_alternative<std::monostate>(loaded.object_layers[0].objects[1].feature));
+  ASSERT_EQ(loaded.group_layers.size(), 1u);
+  EXPECT_EQ(loaded.group_layers[0].sub_layers.size(), 1u);
+  EXPECT_EQ(loaded.layers.size(), 2u);
+  ASSERT_EQ(loaded.textures.size(), 1u);
+  EXPECT_EQ(loaded.textures[0], "tiles.png");
+}
+
+TEST(TiledMapViewTest, Reproducible) {
+  const gf::TiledMap map = create_map();
+
+  auto save = [&map]() {
+    std::vector<uint8_t> bytes;
+    gf::BufferOutputStream stream(&bytes);
+    gf::TiledMapView::save(map, stream);
+    return bytes;
+  };
+
+  const std::vector<uint8_t> first = save();
+
+  // the stack used by the save is dirtied between the saves
+  {
+    volatile uint8_t garbage[16 * 1024];
+
+    for (auto& byte : garbage) {
+      byte = 0xAA;
+    }
+  }
+
+  EXPECT_EQ(save(), first);
+}
+
+TEST(TiledMapViewTest, MappedFile) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_map.gfmap";
+  gf::TiledMapView::save_to_file(create_map(), file);
+
+  {
+    const gf::TiledMapView view(file);
+    EXPECT_EQ(view[view.map().textures].size(), 1u);
+    EXPECT_EQ(view[view.map().object_layers][0].objects.size, 2u);
+  }
+
+  std::filesystem::remove(file);
+}
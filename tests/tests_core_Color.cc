@@ -1,6 +1,12 @@
+#include <cmath>
+
+#include <algorithm>
 #include <type_traits>
+#include <vector>
 
 #include <gf2/core/Color.h>
+#include <gf2/core/ColorCompositing.h>
+#include <gf2/core/ConsoleEffect.h>
 
 #include "gtest/gtest.h"
 
@@ -220,3 +226,121 @@ TEST(ColorTest, ToHex) {
   constexpr auto Hex = Color0.to_hex();
   static_assert(Hex == 0x12345678);
 }
+
+namespace {
+
+  std::vector<gf::Color> compositing_colors()
+  {
+    return {
+      gf::Color(0.2f, 0.4f, 0.6f, 0.8f),
+      gf::Color(0.9f, 0.1f, 0.5f, 0.3f),
+      gf::Color(0.0f, 0.0f, 0.0f, 0.0f),
+      gf::Color(1.0f, 1.0f, 1.0f, 1.0f),
+      gf::Color(0.5f, 0.25f, 0.75f, 0.5f),
+    };
+  }
+
+  constexpr gf::BlendMode BlendModes[] = {
+    gf::BlendMode::Normal, gf::BlendMode::Darken, gf::BlendMode::Multiply, gf::BlendMode::ColorBurn, gf::BlendMode::LinearBurn,
+    gf::BlendMode::Lighten, gf::BlendMode::Screen, gf::BlendMode::ColorDodge, gf::BlendMode::LinearDodge, gf::BlendMode::Overlay,
+    gf::BlendMode::SoftLight, gf::BlendMode::HardLight, gf::BlendMode::VividLight, gf::BlendMode::LinearLight, gf::BlendMode::HardMix,
+    gf::BlendMode::Difference, gf::BlendMode::Exclusion, gf::BlendMode::Substract, gf::BlendMode::Divide,
+  };
+
+  constexpr gf::CompositingOperation CompositingOperations[] = {
+    gf::CompositingOperation::Clear, gf::CompositingOperation::Source, gf::CompositingOperation::Destination,
+    gf::CompositingOperation::SourceOver, gf::CompositingOperation::DestinationOver, gf::CompositingOperation::SourceIn,
+    gf::CompositingOperation::DestinationIn, gf::CompositingOperation::SourceOut, gf::CompositingOperation::DestinationOut,
+    gf::CompositingOperation::SourceAtop, gf::CompositingOperation::DestinationAtop, gf::CompositingOperation::Xor,
+  };
+
+}
+
+TEST(ColorTest, SpanCombineColors) {
+  const std::vector<gf::Color> sources = compositing_colors();
+  std::vector<gf::Color> backdrops = compositing_colors();
+  std::reverse(backdrops.begin(), backdrops.end());
+  std::vector<gf::Color> results(sources.size());
+
+  for (auto mode : BlendModes) {
+    for (auto operation : CompositingOperations) {
+      gf::combine_colors(sources, backdrops, results, mode, operation);
+
+      for (std::size_t i = 0; i < sources.size(); ++i) {
+        const gf::Color expected = gf::combine_colors(sources[i], backdrops[i], mode, operation);
+        EXPECT_FLOAT_EQ(results[i].r, expected.r);
+        EXPECT_FLOAT_EQ(results[i].g, expected.g);
+        EXPECT_FLOAT_EQ(results[i].b, expected.b);
+        EXPECT_FLOAT_EQ(results[i].a, expected.a);
+      }
+    }
+  }
+}
+
+TEST(ColorTest, SpanComputeColors) {
+  const gf::ConsoleEffect effect = gf::ConsoleEffect::alpha();
+  const gf::Color proposed(0.9f, 0.1f, 0.5f, 0.3f);
+  const std::vector<gf::Color> existing = compositing_colors();
+
+  std::vector<gf::Color> results = existing;
+  effect.compute_colors(results, proposed);
+
+  for (std::size_t i = 0; i < existing.size(); ++i) {
+    const gf::Color expected = effect.compute_color(existing[i], proposed);
+    EXPECT_FLOAT_EQ(results[i].r, expected.r);
+    EXPECT_FLOAT_EQ(results[i].g, expected.g);
+    EXPECT_FLOAT_EQ(results[i].b, expected.b);
+    EXPECT_FLOAT_EQ(results[i].a, expected.a);
+  }
+}
+
+TEST(ColorTest, SrgbToLinear) {
+  for (int i = 0; i <= 1000; ++i) {
+    const float c = static_cast<float>(i) / 1000.0f;
+    const float linear = (c < 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    const float srgb = (c < 0.0031308f) ? 12.92f * c : (1.055f * std::pow(c, 1.0f / 2.4f)) - 0.055f;
+
+    EXPECT_NEAR(gf::srgb_to_linear(gf::Color(c, c, c)).r, linear, 1e-4f);
+    EXPECT_NEAR(gf::linear_to_srgb(gf::Color(c, c, c)).g, srgb, 1e-4f);
+  }
+
+  EXPECT_FLOAT_EQ(gf::srgb_to_linear_u8(0), 0.0f);
+  EXPECT_FLOAT_EQ(gf::srgb_to_linear_u8(255), 1.0f);
+  EXPECT_NEAR(gf::srgb_to_linear_u8(128), gf::srgb_to_linear(gf::Color(128.0f / 255.0f, 0.0f, 0.0f)).r, 1e-4f);
+  EXPECT_EQ(gf::linear_to_srgb_u8(0.0f), 0);
+  EXPECT_EQ(gf::linear_to_srgb_u8(1.0f), 255);
+  EXPECT_EQ(gf::linear_to_srgb_u8(gf::srgb_to_linear_u8(100)), 100);
+}
+
+TEST(ColorTest, SpanSrgbToLinear) {
+  std::vector<uint8_t> pixels;
+
+  for (int i = 0; i < 256; ++i) {
+    pixels.push_back(static_cast<uint8_t>(i));
+    pixels.push_back(static_cast<uint8_t>(255 - i));
+    pixels.push_back(static_cast<uint8_t>(i / 2));
+    pixels.push_back(static_cast<uint8_t>(i));
+  }
+
+  std::vector<gf::Color> colors(pixels.size() / 4);
+  gf::srgb_to_linear_rgba32(pixels, colors);
+
+  std::vector<uint8_t> linear(pixels.size());
+  gf::srgb_to_linear_rgba32(pixels, linear);
+
+  for (std::size_t i = 0; i < colors.size(); ++i) {
+    EXPECT_FLOAT_EQ(colors[i].r, gf::srgb_to_linear_u8(pixels[4 * i]));
+    EXPECT_FLOAT_EQ(colors[i].g, gf::srgb_to_linear_u8(pixels[4 * i + 1]));
+    EXPECT_FLOAT_EQ(colors[i].a, static_cast<float>(pixels[4 * i + 3]) / 255.0f);
+    EXPECT_NEAR(linear[4 * i], colors[i].r * 255.0f, 0.5f);
+    EXPECT_EQ(linear[4 * i + 3], pixels[4 * i + 3]);
+  }
+
+  std::vector<gf::Color> converted(colors.size());
+  const std::vector<gf::Color> srgb_colors(colors.size(), gf::Color(0.2f, 0.5f, 0.8f, 0.4f));
+  gf::srgb_to_linear(srgb_colors, converted);
+
+  for (const gf::Color& color : converted) {
+    EXPECT_EQ(color, gf::srgb_to_linear(gf::Color(0.2f, 0.5f, 0.8f, 0.4f)));
+  }
+}
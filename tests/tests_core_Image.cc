@@ -0,0 +1,59 @@
+#include <gf2/core/Image.h>
+
+#include <vector>
+
+#include <gf2/core/Streams.h>
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  gf::Image create_test_image(gf::Vec2I size)
+  {
+    gf::Image image(size);
+
+    for (auto position : image.position_range()) {
+      const auto r = static_cast<float>(position.x % 256) / 255.0f;
+      const auto g = static_cast<float>(position.y % 256) / 255.0f;
+      const auto b = static_cast<float>((position.x * position.y) % 256) / 255.0f;
+      image.put_pixel(position, gf::Color(r, g, b, 1.0f));
+    }
+
+    return image;
+  }
+
+  void check_same_images(const gf::Image& lhs, const gf::Image& rhs)
+  {
+    ASSERT_EQ(lhs.size(), rhs.size());
+    ASSERT_EQ(lhs.raw_size(), rhs.raw_size());
+
+    for (std::size_t i = 0; i < lhs.raw_size(); ++i) {
+      ASSERT_EQ(lhs.raw_data()[i], rhs.raw_data()[i]);
+    }
+  }
+
+}
+
+TEST(ImageTest, SaveToStream) {
+  const gf::Image image = create_test_image({ 300, 200 });
+
+  std::vector<uint8_t> bytes;
+  gf::BufferOutputStream output(&bytes);
+  image.save_to_stream(output);
+
+  const gf::Image decoded(gf::Span<const uint8_t>(bytes.data(), bytes.size()));
+  check_same_images(image, decoded);
+}
+
+TEST(ImageTest, SaveToStreamParallel) {
+  const gf::Image image = create_test_image({ 600, 500 });
+  gf::ThreadPool pool(3);
+
+  std::vector<uint8_t> bytes;
+  gf::BufferOutputStream output(&bytes);
+  image.save_to_stream(output, &pool);
+
+  auto decoded = gf::decode_image_async(pool, std::move(bytes));
+  check_same_images(image, decoded.get());
+}
@@ -0,0 +1,62 @@
+#include <gf2/core/Resampling.h>
+
+#include <gf2/core/Bitmap.h>
+#include <gf2/core/Image.h>
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+TEST(ResamplingTest, UniformImage) {
+  const gf::Color color(0.2f, 0.4f, 0.6f, 0.8f);
+  const gf::Image image({ 37, 23 }, color);
+
+  for (auto filter : { gf::ResamplingFilter::Bilinear, gf::ResamplingFilter::Lanczos }) {
+    for (auto size : { gf::vec(16, 16), gf::vec(64, 50), gf::vec(37, 23) }) {
+      const gf::Image resized = image.resized(size, filter);
+      EXPECT_EQ(resized.size(), size);
+
+      for (auto position : resized.position_range()) {
+        const gf::Color pixel = resized(position);
+        EXPECT_NEAR(pixel.r, color.r, 1.0f / 255.0f);
+        EXPECT_NEAR(pixel.g, color.g, 1.0f / 255.0f);
+        EXPECT_NEAR(pixel.b, color.b, 1.0f / 255.0f);
+        EXPECT_NEAR(pixel.a, color.a, 1.0f / 255.0f);
+      }
+    }
+  }
+}
+
+TEST(ResamplingTest, PremultipliedAlpha) {
+  gf::Image image({ 2, 1 }, gf::Transparent);
+  image.put_pixel({ 0, 0 }, gf::Red);
+  image.put_pixel({ 1, 0 }, gf::Color(0.0f, 1.0f, 0.0f, 0.0f));
+
+  const gf::Image resized = image.resized({ 1, 1 }, gf::ResamplingFilter::Bilinear);
+  const gf::Color pixel = resized({ 0, 0 });
+
+  // the color of the fully transparent pixel must not bleed
+  EXPECT_NEAR(pixel.r, 1.0f, 1.0f / 255.0f);
+  EXPECT_NEAR(pixel.g, 0.0f, 1.0f / 255.0f);
+  EXPECT_NEAR(pixel.a, 0.5f, 1.0f / 255.0f);
+}
+
+TEST(ResamplingTest, Parallel) {
+  gf::Bitmap bitmap({ 128, 96 });
+
+  for (auto position : bitmap.position_range()) {
+    bitmap.put_pixel(position, static_cast<uint8_t>((position.x * 7 + position.y * 3) % 256));
+  }
+
+  gf::ThreadPool pool(3);
+
+  for (auto filter : { gf::ResamplingFilter::Bilinear, gf::ResamplingFilter::Lanczos }) {
+    const gf::Bitmap sequential = bitmap.resized({ 50, 70 }, filter);
+    const gf::Bitmap parallel = bitmap.resized({ 50, 70 }, filter, &pool);
+
+    ASSERT_EQ(sequential.size(), parallel.size());
+
+    for (auto position : sequential.position_range()) {
+      EXPECT_EQ(sequential(position), parallel(position));
+    }
+  }
+}
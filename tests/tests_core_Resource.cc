@@ -1,9 +1,20 @@
+#include <atomic>
+#include <fstream>
+#include <chrono>
+#include <future>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 #include <gf2/core/ResourceBundle.h>
 #include <gf2/core/ResourceLoaders.h>
 #include <gf2/core/ResourceManager.h>
+#include <gf2/core/ResourceProfiler.h>
 #include <gf2/core/ResourceRegistry.h>
+#include <gf2/core/ThreadPool.h>
 
 #include "gtest/gtest.h"
 
@@ -78,8 +89,118 @@ namespace {
     }
   };
 
+  struct SlowLoader {
+
+    template<typename T>
+    std::unique_ptr<T> operator()(const std::filesystem::path& path)
+    {
+      ++calls;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      return std::make_unique<T>(path);
+    }
+
+    std::atomic<int> calls = 0;
+  };
+
+  struct DummyParallelResource {
+    DummyParallelResource([[maybe_unused]] const std::filesystem::path& path)
+    {
+    }
+  };
+
+  struct DummyLevelResource {
+
+    DummyLevelResource([[maybe_unused]] const std::filesystem::path& path)
+    {
+    }
+
+    static gf::ResourceBundle bundle(const std::filesystem::path& path)
+    {
+      gf::ResourceBundle bundle([path](gf::ResourceBundle* bundle, auto manager, auto action) {
+        for (int i = 0; i < 8; ++i) {
+          bundle->handle<DummyParallelResource>(path / std::to_string(i), manager, action);
+        }
+      });
+      return bundle;
+    }
+  };
+
+  struct DummyMapPrimitive {
+    DummyMapPrimitive([[maybe_unused]] const std::filesystem::path& path)
+    {
+    }
+
+    int texture_count = 4;
+  };
+
+  struct DummyMapResource {
+    using Primitive = DummyMapPrimitive;
+
+    struct Context {
+      gf::ResourceManager* manager = nullptr;
+    };
+
+    DummyMapResource(const std::filesystem::path& path, const Context& context)
+    : map(context.manager->get<DummyMapPrimitive>(path))
+    {
+    }
+
+    // the bundle needs the primitive
+    static gf::ResourceBundle bundle(const std::filesystem::path& path, const Context& context)
+    {
+      const DummyMapPrimitive* map = context.manager->get<DummyMapPrimitive>(path);
+
+      gf::ResourceBundle bundle([path, map](gf::ResourceBundle* bundle, auto manager, auto action) {
+        for (int i = 0; i < map->texture_count; ++i) {
+          bundle->handle<DummyParallelResource>(path / std::to_string(i), manager, action);
+        }
+      });
+      return bundle;
+    }
+
+    const DummyMapPrimitive* map = nullptr;
+  };
+
+  // loads another resource while it is loaded
+  struct DummyNestedResource {
+    struct Context {
+      gf::ResourceManager* manager = nullptr;
+    };
+
+    DummyNestedResource(const std::filesystem::path& path, const Context& context)
+    : nested(context.manager->load<DummyResource>(path / "nested"))
+    {
+    }
+
+    const DummyResource* nested = nullptr;
+  };
+
+  // records the resources that are loaded while the level is loaded
+  struct LevelLoader {
+
+    template<typename T>
+    std::unique_ptr<T> operator()(const std::filesystem::path& path)
+    {
+      if constexpr (std::is_same_v<T, DummyLevelResource>) {
+        level_dependencies = loaded.load();
+      } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ++loaded;
+      }
+
+      return std::make_unique<T>(path);
+    }
+
+    std::atomic<int> loaded = 0;
+    int level_dependencies = 0;
+  };
+
 } // namespace
 
+template<>
+struct gf::EnableParallelLoad<DummyParallelResource> : std::true_type {
+};
+
 TEST(ResourceTest, RegistryConstructor) {
   gf::ResourceRegistry<DummyResource> registry;
   EXPECT_FALSE(registry.loaded("unknown"));
@@ -207,6 +328,272 @@ TEST(ResourceTest, RegistryInvalidGet) {
   EXPECT_FALSE(registry.loaded("foo"));
 }
 
+TEST(ResourceTest, RegistryAbsolutePath) {
+  DummyLoader loader;
+
+  gf::ResourceRegistry<DummyResource> registry;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  auto* resource = registry.load("dir/foo");
+  const std::filesystem::path absolute_path = std::filesystem::temp_directory_path() / "dir" / "foo";
+
+  EXPECT_TRUE(registry.loaded(absolute_path));
+  EXPECT_EQ(registry.get(absolute_path), resource);
+  EXPECT_FALSE(registry.loaded(std::filesystem::temp_directory_path() / "foo" / "dir"));
+
+  registry.unload(absolute_path);
+
+  EXPECT_FALSE(registry.loaded("dir/foo"));
+}
+
+TEST(ResourceTest, RegistryKey) {
+  DummyLoader loader;
+
+  gf::ResourceRegistry<DummyResource> registry;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  auto* resource = registry.load("dir/./foo");
+  const gf::Id key = gf::resource_key("dir/foo");
+
+  EXPECT_TRUE(registry.loaded(key));
+  EXPECT_EQ(registry.get(key), resource);
+  EXPECT_EQ(registry.load("dir/foo"), resource);
+
+  registry.unload("dir/foo");
+  registry.unload("dir/../dir/foo");
+
+  EXPECT_FALSE(registry.loaded(key));
+  EXPECT_ANY_THROW(registry.get(key)); // NOLINT
+}
+
+TEST(ResourceTest, RegistryBudget) {
+  SlowLoader loader;
+
+  gf::ResourceRegistry<DummyResource> registry;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+  registry.set_budget(3 * sizeof(DummyResource));
+
+  for (const char* path : { "a", "b", "c", "d" }) {
+    [[maybe_unused]] auto* resource = registry.load(path);
+  }
+
+  EXPECT_EQ(registry.memory_usage(), 4 * sizeof(DummyResource));
+
+  for (const char* path : { "a", "b", "c", "d" }) {
+    registry.unload(path);
+    EXPECT_FALSE(registry.loaded(path));
+  }
+
+  // "a" is the least recently used
+  EXPECT_EQ(registry.unused_count(), 3u);
+  EXPECT_EQ(registry.memory_usage(), 3 * sizeof(DummyResource));
+  EXPECT_ANY_THROW(registry.unload("b")); // NOLINT
+
+  [[maybe_unused]] auto* resource = registry.load("b");
+  EXPECT_EQ(loader.calls, 4);
+  EXPECT_EQ(registry.unused_count(), 2u);
+
+  resource = registry.load("a");
+  EXPECT_EQ(loader.calls, 5);
+  EXPECT_EQ(registry.unused_count(), 1u);
+
+  registry.evict_unused();
+  EXPECT_EQ(registry.unused_count(), 0u);
+  EXPECT_EQ(registry.memory_usage(), 2 * sizeof(DummyResource));
+}
+
+TEST(ResourceTest, ManagerBudget) {
+  gf::ResourceRegistry<DummyResource> registry0;
+  gf::ResourceRegistry<DummyParallelResource> registry1;
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry0);
+  manager.add_registry(&registry1);
+
+  DummyLoader loader;
+  registry0.add_loader(gf::loader_for<DummyResource>(loader));
+  registry1.add_loader(gf::loader_for<DummyParallelResource>(loader));
+
+  const std::size_t size0 = sizeof(DummyResource);
+  const std::size_t size1 = sizeof(DummyParallelResource);
+  manager.set_memory_budget(size0 + size1);
+
+  manager.load<DummyResource>("a");
+  manager.load<DummyParallelResource>("b");
+  manager.load<DummyResource>("c");
+  EXPECT_EQ(manager.memory_usage(), (2 * size0) + size1);
+
+  manager.unload<DummyResource>("a");
+  manager.unload<DummyParallelResource>("b");
+  EXPECT_EQ(manager.memory_usage(), size0 + size1);
+  EXPECT_EQ(registry0.unused_count(), 0u);
+  EXPECT_EQ(registry1.unused_count(), 1u);
+
+  manager.unload<DummyResource>("c");
+  EXPECT_EQ(registry1.unused_count(), 1u);
+  EXPECT_EQ(registry0.unused_count(), 1u);
+
+  manager.set_memory_budget(size0);
+  EXPECT_EQ(manager.memory_usage(), size0);
+  EXPECT_EQ(registry1.unused_count(), 0u);
+  EXPECT_EQ(registry0.unused_count(), 1u);
+}
+
+TEST(ResourceTest, ManagerBudgetComposite) {
+  gf::ResourceRegistry<DummyCompositeResource> registry_for_composite;
+  gf::ResourceRegistry<DummyResource> registry_for_single;
+
+  DummyLoader loader;
+  registry_for_composite.add_loader(gf::loader_for<DummyCompositeResource>(loader));
+  registry_for_single.add_loader(gf::loader_for<DummyResource>(loader));
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry_for_composite);
+  manager.add_registry(&registry_for_single);
+  manager.set_memory_budget(1024);
+
+  gf::ResourceBundle bundle([](gf::ResourceBundle* bundle, auto manager, auto action) {
+    bundle->handle<DummyCompositeResource>("foo", manager, action);
+  });
+
+  bundle.load_from(&manager);
+  bundle.unload_from(&manager);
+
+  // the dependency is kept, but not the composite that points to it
+  EXPECT_EQ(registry_for_composite.unused_count(), 0u);
+  EXPECT_EQ(registry_for_composite.memory_usage(), 0u);
+  EXPECT_EQ(registry_for_single.unused_count(), 1u);
+
+  registry_for_single.evict_unused();
+  bundle.load_from(&manager);
+  EXPECT_TRUE(registry_for_composite.loaded("foo"));
+  EXPECT_TRUE(registry_for_single.loaded("sub/foo"));
+  bundle.unload_from(&manager);
+}
+
+TEST(ResourceTest, SharedBudgetConcurrent) {
+  DummyLoader loader;
+  gf::ResourceRegistry<DummyResource> registry;
+  gf::ResourceRegistry<DummyResource> other_registry;
+  other_registry.add_loader(gf::loader_for<DummyResource>(loader));
+  [[maybe_unused]] auto* resource = other_registry.load("a");
+
+  // the usage is always over the limit, so the budget looks at all its registries each time it is enforced
+  gf::ResourceBudget budget(1);
+  other_registry.set_shared_budget(&budget);
+
+  std::atomic<bool> started = false;
+  std::atomic<bool> stop = false;
+
+  std::thread enforcer([&]() {
+    started = true;
+
+    while (!stop) {
+      budget.enforce();
+    }
+  });
+
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  for (int i = 0; i < 100000; ++i) {
+    registry.set_shared_budget(&budget);
+    registry.set_shared_budget(nullptr);
+  }
+
+  stop = true;
+  enforcer.join();
+  EXPECT_EQ(budget.usage(), sizeof(DummyResource));
+  other_registry.set_shared_budget(nullptr);
+}
+
+TEST(ResourceTest, ManagerProfiler) {
+  std::size_t raw_resource = 42;
+
+  gf::MemoryLoader loader;
+  loader.add_buffer("foo", gf::bytes(&raw_resource));
+
+  gf::ResourceRegistry<DummyResource> registry;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry);
+
+  gf::ResourceProfiler& profiler = manager.profiler();
+  EXPECT_FALSE(profiler.enabled());
+
+  manager.load<DummyResource>("foo");
+  EXPECT_EQ(profiler.record_count(), 0u);
+
+  profiler.set_enabled(true);
+  manager.load<DummyResource>("foo");
+  manager.unload<DummyResource>("foo");
+  manager.unload<DummyResource>("foo");
+  manager.load<DummyResource>("./foo");
+
+  const std::vector<gf::ResourceLoadRecord> records = profiler.records();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(profiler.cache_hit_count(), 1u);
+
+  EXPECT_EQ(records[0].path, "foo");
+  EXPECT_TRUE(records[0].cache_hit);
+  EXPECT_EQ(records[0].bytes_read, 0u);
+
+  EXPECT_EQ(records[1].path, "foo");
+  EXPECT_FALSE(records[1].cache_hit);
+  EXPECT_EQ(records[1].bytes_read, sizeof(raw_resource));
+  EXPECT_EQ(records[1].thread, records[0].thread);
+  EXPECT_LE(records[1].decode_time.as_duration(), records[1].wall_time.as_duration());
+  EXPECT_EQ(profiler.total_load_time().as_duration(), records[1].wall_time.as_duration());
+  EXPECT_EQ(profiler.slowest(1).size(), 1u);
+
+  const std::filesystem::path report = std::filesystem::temp_directory_path() / "gf2_tests_resource_report.json";
+  profiler.save_report(report, gf::ResourceReportFormat::ChromeTrace);
+
+  std::ifstream file(report);
+  const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  EXPECT_NE(content.find("\"traceEvents\""), std::string::npos);
+  EXPECT_NE(content.find("\"name\": \"foo\""), std::string::npos);
+  file.close();
+  std::filesystem::remove(report);
+
+  profiler.clear();
+  EXPECT_EQ(profiler.record_count(), 0u);
+}
+
+TEST(ResourceTest, ManagerProfilerNested) {
+  DummyLoader loader;
+
+  gf::ResourceRegistry<DummyResource> registry;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  gf::ResourceRegistry<DummyNestedResource> nested_registry;
+  nested_registry.add_loader(gf::loader_for<DummyNestedResource>(loader));
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry);
+  manager.add_registry(&nested_registry);
+
+  gf::ResourceProfiler& profiler = manager.profiler();
+  profiler.set_enabled(true);
+
+  manager.load<DummyNestedResource>("foo", { &manager });
+
+  // the nested load ends first
+  const std::vector<gf::ResourceLoadRecord> records = profiler.records();
+  ASSERT_EQ(records.size(), 2u);
+
+  EXPECT_EQ(records[0].path, "foo/nested");
+  EXPECT_EQ(records[0].depth, 1u);
+
+  EXPECT_EQ(records[1].path, "foo");
+  EXPECT_EQ(records[1].depth, 0u);
+
+  // the nested load is not counted twice
+  EXPECT_EQ(profiler.total_load_time().as_duration(), records[1].wall_time.as_duration());
+}
+
 TEST(ResourceTest, ManagerConstructor) {
   gf::ResourceManager manager;
 }
@@ -243,6 +630,119 @@ TEST(ResourceTest, ManagerAcquire) { // NOLINT
   EXPECT_NO_THROW(manager.unload<DummyResource>("foo"));  // NOLINT
 }
 
+TEST(ResourceTest, ManagerLoadAsyncWithoutPool) {
+  gf::ResourceRegistry<DummyResource> registry;
+  gf::ResourceRegistry<DummyCompositeResource> registry_without_loader;
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry);
+  manager.add_registry(&registry_without_loader);
+
+  DummyLoader loader;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  std::future<DummyResource*> result = manager.load_async<DummyResource>("foo");
+  EXPECT_EQ(result.get(), manager.get<DummyResource>("foo"));
+
+  std::future<DummyCompositeResource*> failure = manager.load_async<DummyCompositeResource>("foo");
+  EXPECT_ANY_THROW(failure.get()); // NOLINT
+}
+
+TEST(ResourceTest, ManagerLoadAsyncSamePath) {
+  gf::ResourceRegistry<DummyResource> registry;
+
+  gf::ThreadPool pool(4);
+  gf::ResourceManager manager(&pool);
+  manager.add_registry(&registry);
+
+  SlowLoader loader;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  std::vector<std::future<DummyResource*>> results;
+
+  for (int i = 0; i < 8; ++i) {
+    results.push_back(manager.load_async<DummyResource>("foo"));
+  }
+
+  DummyResource* resource = manager.load<DummyResource>("foo");
+
+  for (auto& result : results) {
+    EXPECT_EQ(result.get(), resource);
+  }
+
+  EXPECT_EQ(loader.calls, 1);
+
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_TRUE(registry.loaded("foo"));
+    manager.unload<DummyResource>("foo");
+  }
+
+  EXPECT_FALSE(registry.loaded("foo"));
+}
+
+TEST(ResourceTest, ManagerLoadAsyncManyPaths) {
+  gf::ResourceRegistry<DummyResource> registry;
+
+  gf::ThreadPool pool(4);
+  gf::ResourceManager manager(&pool);
+  manager.add_registry(&registry);
+
+  SlowLoader loader;
+  registry.add_loader(gf::loader_for<DummyResource>(loader));
+
+  std::vector<std::future<DummyResource*>> results;
+
+  for (int i = 0; i < 16; ++i) {
+    results.push_back(manager.load_async<DummyResource>("foo" + std::to_string(i % 8)));
+  }
+
+  for (auto& result : results) {
+    EXPECT_NE(result.get(), nullptr);
+  }
+
+  EXPECT_EQ(loader.calls, 8);
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_TRUE(registry.loaded("foo" + std::to_string(i)));
+  }
+}
+
+TEST(ResourceTest, FileLoaderIndex) {
+  const std::filesystem::path root = std::filesystem::temp_directory_path() / "gf2_tests_file_loader";
+  std::filesystem::remove_all(root);
+
+  auto create_file = [&root](const std::filesystem::path& path) {
+    std::filesystem::create_directories((root / path).parent_path());
+    std::ofstream(root / path) << path.string();
+  };
+
+  create_file("first/a.txt");
+  create_file("first/sub/b.txt");
+  create_file("first/sub/deep/c.txt");
+  create_file("second/a.txt");
+  create_file("second/d.txt");
+
+  gf::ThreadPool pool(2);
+  gf::FileLoader loader;
+  loader.add_search_directory(root / "first");
+  loader.enable_index(&pool);
+  loader.add_search_directory(root / "second");
+
+  EXPECT_TRUE(loader.indexed());
+  EXPECT_EQ(loader.search("a.txt"), root / "first" / "a.txt");
+  EXPECT_EQ(loader.search("sub/deep/c.txt"), root / "first" / "sub" / "deep" / "c.txt");
+  EXPECT_EQ(loader.search("sub/./b.txt"), root / "first" / "sub" / "./b.txt");
+  EXPECT_EQ(loader.search("d.txt"), root / "second" / "d.txt");
+  EXPECT_TRUE(loader.search("e.txt").empty());
+
+  create_file("second/e.txt");
+  EXPECT_TRUE(loader.search("e.txt").empty());
+  loader.refresh_index();
+  EXPECT_EQ(loader.search("e.txt"), root / "second" / "e.txt");
+
+  std::filesystem::remove_all(root);
+}
+
 TEST(ResourceTest, MemoryLoader) {
   std::size_t raw_resource = 42;
 
@@ -378,6 +878,65 @@ TEST(ResourceTest, BundleContext) {
   EXPECT_FALSE(registry.loaded("foo"));
 }
 
+TEST(ResourceTest, BundleParallel) {
+  gf::ResourceRegistry<DummyLevelResource> level_registry;
+  gf::ResourceRegistry<DummyParallelResource> registry;
+
+  LevelLoader loader;
+  level_registry.add_loader(gf::loader_for<DummyLevelResource>(loader));
+  registry.add_loader(gf::loader_for<DummyParallelResource>(loader));
+
+  gf::ResourceManager manager;
+  manager.add_registry(&level_registry);
+  manager.add_registry(&registry);
+
+  gf::ResourceBundle bundle([](gf::ResourceBundle* bundle, auto manager, auto action) {
+    bundle->handle<DummyLevelResource>("level0", manager, action);
+    bundle->handle<DummyLevelResource>("level1", manager, action);
+  });
+
+  gf::ThreadPool pool(4);
+  std::vector<std::size_t> progress;
+
+  bundle.load_from(&manager, &pool, [&progress](std::size_t loaded, std::size_t total) {
+    EXPECT_EQ(total, 18u);
+    progress.push_back(loaded);
+  });
+
+  ASSERT_EQ(progress.size(), 18u);
+  EXPECT_EQ(progress.back(), 18u);
+  EXPECT_EQ(loader.loaded, 16);
+  EXPECT_GE(loader.level_dependencies, 8);
+
+  EXPECT_TRUE(level_registry.loaded("level0"));
+  EXPECT_TRUE(registry.loaded("level1/7"));
+
+  bundle.unload_from(&manager);
+
+  EXPECT_FALSE(level_registry.loaded("level0"));
+  EXPECT_FALSE(registry.loaded("level1/7"));
+}
+
+TEST(ResourceTest, BundleParallelFailure) {
+  gf::ResourceRegistry<DummyLevelResource> level_registry;
+  gf::ResourceRegistry<DummyParallelResource> registry;
+
+  LevelLoader loader;
+  level_registry.add_loader(gf::loader_for<DummyLevelResource>(loader));
+
+  gf::ResourceManager manager;
+  manager.add_registry(&level_registry);
+  manager.add_registry(&registry);
+
+  gf::ResourceBundle bundle([](gf::ResourceBundle* bundle, auto manager, auto action) {
+    bundle->handle<DummyLevelResource>("level", manager, action);
+  });
+
+  gf::ThreadPool pool(2);
+  EXPECT_ANY_THROW(bundle.load_from(&manager, &pool)); // NOLINT
+  EXPECT_FALSE(level_registry.loaded("level"));
+}
+
 TEST(ResourceTest, BundlePrimitive) {
   gf::ResourceRegistry<DummyPrimitiveResource> registry0;
   gf::ResourceRegistry<DummyPrimitive> registry1;
@@ -404,3 +963,95 @@ TEST(ResourceTest, BundlePrimitive) {
   EXPECT_FALSE(registry0.loaded("foo"));
   EXPECT_FALSE(registry1.loaded("foo"));
 }
+
+TEST(ResourceTest, BundlePrimitiveDependency) {
+  gf::ResourceRegistry<DummyMapResource> registry0;
+  gf::ResourceRegistry<DummyMapPrimitive> registry1;
+  gf::ResourceRegistry<DummyParallelResource> registry2;
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry0);
+  manager.add_registry(&registry1);
+  manager.add_registry(&registry2);
+
+  DummyLoader loader;
+  registry0.add_loader(gf::loader_for<DummyMapResource>(loader));
+  registry1.add_loader(gf::loader_for<DummyMapPrimitive>(loader));
+  registry2.add_loader(gf::loader_for<DummyParallelResource>(loader));
+
+  const DummyMapResource::Context context = { &manager };
+
+  gf::ResourceBundle bundle([&context](gf::ResourceBundle* bundle, auto manager, auto action) {
+    bundle->handle<DummyMapResource>("map0", context, manager, action);
+    bundle->handle<DummyMapResource>("map1", context, manager, action);
+  });
+
+  gf::ThreadPool pool(2);
+
+  for (gf::ThreadPool* current : { static_cast<gf::ThreadPool*>(nullptr), &pool }) {
+    std::size_t total = 0;
+
+    bundle.load_from(&manager, current, [&total](std::size_t loaded, std::size_t progress_total) {
+      EXPECT_LE(loaded, progress_total);
+      total = progress_total;
+    });
+
+    // for each map: the primitive, the bundle and the map
+    EXPECT_EQ(total, 6u);
+    EXPECT_TRUE(registry0.loaded("map0"));
+    EXPECT_TRUE(registry1.loaded("map1"));
+    EXPECT_TRUE(registry2.loaded("map0/3"));
+    EXPECT_TRUE(registry2.loaded("map1/0"));
+
+    bundle.unload_from(&manager);
+
+    EXPECT_FALSE(registry0.loaded("map0"));
+    EXPECT_FALSE(registry1.loaded("map1"));
+    EXPECT_FALSE(registry2.loaded("map0/3"));
+  }
+}
+
+TEST(ResourceTest, BundleStopped) {
+  gf::ResourceRegistry<DummyMapResource> registry0;
+  gf::ResourceRegistry<DummyMapPrimitive> registry1;
+  gf::ResourceRegistry<DummyParallelResource> registry2;
+
+  gf::ResourceManager manager;
+  manager.add_registry(&registry0);
+  manager.add_registry(&registry1);
+  manager.add_registry(&registry2);
+
+  DummyLoader loader;
+  registry0.add_loader(gf::loader_for<DummyMapResource>(loader));
+  registry1.add_loader(gf::loader_for<DummyMapPrimitive>(loader));
+  registry2.add_loader(gf::loader_for<DummyParallelResource>(loader));
+
+  const DummyMapResource::Context context = { &manager };
+
+  gf::ResourceBundle bundle([&context](gf::ResourceBundle* bundle, auto manager, auto action) {
+    bundle->handle<DummyMapResource>("map0", context, manager, action);
+    bundle->handle<DummyMapResource>("map1", context, manager, action);
+  });
+
+  gf::ThreadPool pool(2);
+
+  for (gf::ThreadPool* current : { static_cast<gf::ThreadPool*>(nullptr), &pool }) {
+    // the progress stops the load, what was already loaded is unloaded
+    EXPECT_ANY_THROW(bundle.load_from(&manager, current, [](std::size_t loaded, [[maybe_unused]] std::size_t total) { // NOLINT
+      if (loaded == 4) {
+        throw std::runtime_error("stop");
+      }
+    }));
+
+    EXPECT_FALSE(registry0.loaded("map0"));
+    EXPECT_FALSE(registry1.loaded("map0"));
+    EXPECT_FALSE(registry1.loaded("map1"));
+    EXPECT_FALSE(registry2.loaded("map0/0"));
+    EXPECT_FALSE(registry2.loaded("map1/0"));
+
+    // the bundle can be loaded again
+    bundle.load_from(&manager, current);
+    EXPECT_TRUE(registry0.loaded("map1"));
+    bundle.unload_from(&manager);
+  }
+}
@@ -484,6 +484,68 @@ namespace {
 }
 
 
+namespace {
+
+  template<typename T>
+  void check_block_format(const std::vector<T>& in)
+  {
+    std::vector<uint8_t> block_bytes;
+
+    {
+      gf::BufferOutputStream ostream(&block_bytes);
+      gf::Serializer ar(&ostream);
+      ar | in;
+    }
+
+    std::vector<uint8_t> element_bytes;
+
+    {
+      gf::BufferOutputStream ostream(&element_bytes);
+      gf::Serializer ar(&ostream);
+      ar.write_raw_size(in.size());
+
+      for (const T& element : in) {
+        ar | element;
+      }
+    }
+
+    EXPECT_EQ(block_bytes, element_bytes);
+
+    std::vector<T> out;
+    gf::BufferInputStream istream(&block_bytes);
+    gf::Deserializer ar(&istream);
+    ar | out;
+    EXPECT_EQ(in, out);
+  }
+
+}
+
+TEST(SerialTest, BlockFormat) {
+  std::vector<int16_t> in1(3000);
+  std::iota(in1.begin(), in1.end(), int16_t(-1500));
+  check_block_format(in1);
+
+  std::vector<uint32_t> in2(5000);
+  std::iota(in2.begin(), in2.end(), UINT32_C(0xFFFF0000));
+  check_block_format(in2);
+
+  std::vector<uint64_t> in3 = { 0, 1, UINT64_C(0x0123456789ABCDEF), std::numeric_limits<uint64_t>::max() };
+  check_block_format(in3);
+
+  std::vector<float> in4 = { 0.0f, -1.5f, 3.25f, std::numeric_limits<float>::max() };
+  check_block_format(in4);
+
+  std::vector<double> in5 = { 0.0, -1.5, 3.25, std::numeric_limits<double>::lowest() };
+  check_block_format(in5);
+
+  std::vector<uint8_t> in6(200000);
+  std::iota(in6.begin(), in6.end(), uint8_t(0));
+  check_block_format(in6);
+
+  std::vector<bool> in7 = { true, false, true };
+  check_block_format(in7);
+}
+
 TEST(SerialTest, Queue) {
   std::queue<std::string> tests1[] = {
     {},
@@ -879,3 +941,33 @@ TEST(SerialTest, Compressed) {
 
   EXPECT_EQ(in1, out1);
 }
+
+TEST(SerialTest, Buffered) {
+  std::vector<int32_t> in1(10 * 1024);
+  std::iota(in1.begin(), in1.end(), 1);
+  const std::string in2 = "gf2";
+
+  std::vector<int32_t> out1;
+  std::string out2;
+
+  std::vector<uint8_t> bytes;
+
+  {
+    gf::BufferOutputStream ostream(&bytes);
+    gf::CompressedOutputStream compressed(&ostream);
+    gf::BufferedOutputStream buffered(&compressed, 100);
+    gf::Serializer ar(&buffered);
+    ar | in1 | in2;
+  }
+
+  {
+    gf::BufferInputStream istream(&bytes);
+    gf::CompressedInputStream compressed(&istream);
+    gf::BufferedInputStream buffered(&compressed, 100);
+    gf::Deserializer ar(&buffered);
+    ar | out1 | out2;
+  }
+
+  EXPECT_EQ(in1, out1);
+  EXPECT_EQ(in2, out2);
+}
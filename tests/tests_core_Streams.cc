@@ -0,0 +1,333 @@
+#include <gf2/core/Streams.h>
+
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <vector>
+
+#include <zlib.h>
+
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  std::filesystem::path create_file(const char* name, const std::vector<uint8_t>& bytes)
+  {
+    const std::filesystem::path file = std::filesystem::temp_directory_path() / name;
+    std::FILE* raw = std::fopen(file.string().c_str(), "wb");
+
+    if (raw != nullptr) {
+      std::fwrite(bytes.data(), 1, bytes.size(), raw);
+      std::fclose(raw);
+    }
+
+    return file;
+  }
+
+  std::vector<uint8_t> create_compressible_content(std::size_t size)
+  {
+    std::vector<uint8_t> content(size);
+    uint32_t seed = 42;
+
+    for (std::size_t i = 0; i < size; ++i) {
+      seed = seed * 1664525u + 1013904223u;
+      content[i] = static_cast<uint8_t>((i / 7) % 31 + (seed >> 30));
+    }
+
+    return content;
+  }
+
+  std::vector<uint8_t> compress(const std::vector<uint8_t>& content, gf::CompressionFormat format, gf::ThreadPool* pool)
+  {
+    std::vector<uint8_t> bytes;
+
+    {
+      gf::BufferOutputStream output(&bytes);
+      gf::CompressedOutputStream compressed(&output, format, pool);
+
+      // uneven writes, so that they cross the blocks
+      for (std::size_t offset = 0; offset < content.size(); offset += 10000) {
+        compressed.write(gf::Span<const uint8_t>(content.data() + offset, std::min(content.size() - offset, std::size_t(10000))));
+      }
+    }
+
+    return bytes;
+  }
+
+  std::vector<uint8_t> decompress(const std::vector<uint8_t>& bytes, std::size_t size)
+  {
+    gf::BufferInputStream input(&bytes);
+    gf::CompressedInputStream compressed(&input);
+    std::vector<uint8_t> content(size + 1);
+    content.resize(compressed.read(content));
+    return content;
+  }
+
+}
+
+TEST(StreamsTest, MemoryView) {
+  const std::array<uint8_t, 4> bytes = { 1, 2, 3, 4 };
+  gf::MemoryInputStream stream(gf::Span<const uint8_t>(bytes.data(), bytes.size()));
+
+  EXPECT_EQ(stream.view().size(), 4u);
+  stream.skip(3);
+  ASSERT_EQ(stream.view().size(), 1u);
+  EXPECT_EQ(stream.view()[0], 4);
+}
+
+TEST(StreamsTest, MappedFile) {
+  std::vector<uint8_t> bytes(10000);
+
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  const std::filesystem::path file = create_file("gf2_tests_mapped.bin", bytes);
+
+  {
+    gf::MappedFileInputStream stream(file);
+    const gf::Span<const uint8_t> memory = stream.memory();
+    ASSERT_EQ(memory.size(), bytes.size());
+    EXPECT_TRUE(std::equal(memory.begin(), memory.end(), bytes.begin(), bytes.end()));
+
+    std::array<uint8_t, 16> buffer = {};
+    EXPECT_EQ(stream.read(buffer), buffer.size());
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), bytes.begin()));
+
+    const gf::Span<const uint8_t> span = stream.read_span(100);
+    ASSERT_EQ(span.size(), 100u);
+    EXPECT_EQ(span.data(), memory.data() + 16);
+
+    stream.seek(9990);
+    EXPECT_EQ(stream.view().size(), 10u);
+    EXPECT_EQ(stream.read_span(100).size(), 10u);
+    EXPECT_TRUE(stream.finished());
+
+    gf::MappedFileInputStream moved(std::move(stream));
+    moved.seek(0);
+    EXPECT_EQ(moved.view().size(), bytes.size());
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(StreamsTest, MappedEmptyFile) {
+  const std::filesystem::path file = create_file("gf2_tests_mapped_empty.bin", {});
+
+  {
+    gf::MappedFileInputStream stream(file);
+    EXPECT_TRUE(stream.memory().empty());
+    EXPECT_TRUE(stream.finished());
+
+    std::array<uint8_t, 4> buffer = {};
+    EXPECT_EQ(stream.read(buffer), 0u);
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(StreamsTest, BufferedInput) {
+  std::vector<uint8_t> bytes(1000);
+
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+
+  gf::BufferInputStream input(&bytes);
+  gf::BufferedInputStream stream(&input, 64);
+
+  std::array<uint8_t, 10> small = {};
+  EXPECT_EQ(stream.read(small), small.size());
+  EXPECT_EQ(small[0], 0);
+  EXPECT_EQ(small[9], 9);
+
+  stream.skip(-5);
+  EXPECT_EQ(stream.read(small), small.size());
+  EXPECT_EQ(small[0], 5);
+
+  stream.skip(100);
+  EXPECT_EQ(stream.read(small), small.size());
+  EXPECT_EQ(small[0], 115);
+
+  std::vector<uint8_t> large(200);
+  EXPECT_EQ(stream.read(large), large.size());
+  EXPECT_EQ(large[0], 125);
+  EXPECT_EQ(large[199], static_cast<uint8_t>(324));
+
+  stream.seek(990);
+  EXPECT_EQ(stream.read(small), small.size());
+  EXPECT_EQ(small[0], static_cast<uint8_t>(990));
+  EXPECT_EQ(stream.read(small), 0u);
+  EXPECT_TRUE(stream.finished());
+}
+
+TEST(StreamsTest, BufferedOutput) {
+  std::vector<uint8_t> bytes;
+
+  {
+    gf::BufferOutputStream output(&bytes);
+    gf::BufferedOutputStream stream(&output, 64);
+
+    for (uint8_t i = 0; i < 100; ++i) {
+      stream.write(i);
+    }
+
+    EXPECT_EQ(stream.written_bytes(), 100u);
+    EXPECT_LT(bytes.size(), 100u);
+
+    const std::vector<uint8_t> large(200, 0xFF);
+    EXPECT_EQ(stream.write(large), large.size());
+
+    stream.write(42);
+    stream.flush();
+    EXPECT_EQ(bytes.size(), 301u);
+  }
+
+  ASSERT_EQ(bytes.size(), 301u);
+  EXPECT_EQ(bytes[99], 99);
+  EXPECT_EQ(bytes[100], 0xFF);
+  EXPECT_EQ(bytes[300], 42);
+}
+
+TEST(StreamsTest, CompressedParallel) {
+  const std::vector<uint8_t> content = create_compressible_content(1024 * 1024 + 12345);
+  gf::ThreadPool pool(3);
+
+  const std::vector<uint8_t> bytes = compress(content, gf::CompressionFormat::Zlib, &pool);
+  EXPECT_LT(bytes.size(), content.size());
+  EXPECT_EQ(decompress(bytes, content.size()), content);
+
+  // the output is a standard zlib stream
+  std::vector<uint8_t> uncompressed(content.size());
+  uLongf size = static_cast<uLongf>(uncompressed.size());
+  ASSERT_EQ(uncompress(uncompressed.data(), &size, bytes.data(), static_cast<uLong>(bytes.size())), Z_OK);
+  EXPECT_EQ(size, content.size());
+  EXPECT_EQ(uncompressed, content);
+
+  EXPECT_EQ(decompress(compress({}, gf::CompressionFormat::Zlib, &pool), 0), std::vector<uint8_t>());
+}
+
+TEST(StreamsTest, CompressedFromPoolThreads) {
+  const std::vector<uint8_t> content = create_compressible_content(1024 * 1024 + 12345);
+  gf::ThreadPool pool(2);
+
+  // every worker writes a stream that uses the same pool
+  std::vector<std::future<std::vector<uint8_t>>> results;
+
+  for (std::size_t i = 0; i < pool.thread_count(); ++i) {
+    results.push_back(pool.submit([&content, &pool]() { return compress(content, gf::CompressionFormat::Zlib, &pool); }));
+  }
+
+  for (auto& result : results) {
+    ASSERT_EQ(result.wait_for(std::chrono::seconds(30)), std::future_status::ready);
+    EXPECT_EQ(decompress(result.get(), content.size()), content);
+  }
+}
+
+TEST(StreamsTest, CompressedGzip) {
+  const std::vector<uint8_t> content = create_compressible_content(512 * 1024 + 321);
+  gf::ThreadPool pool(2);
+
+  for (gf::ThreadPool* current : { static_cast<gf::ThreadPool*>(nullptr), &pool }) {
+    const std::vector<uint8_t> bytes = compress(content, gf::CompressionFormat::Gzip, current);
+    ASSERT_GT(bytes.size(), 2u);
+    EXPECT_EQ(bytes[0], 0x1F);
+    EXPECT_EQ(bytes[1], 0x8B);
+    EXPECT_EQ(decompress(bytes, content.size()), content);
+
+    // the output is a standard gzip file
+    const std::filesystem::path file = create_file("gf2_tests_streams.gz", bytes);
+    gzFile gz = gzopen(file.string().c_str(), "rb");
+    ASSERT_NE(gz, nullptr);
+    std::vector<uint8_t> uncompressed(content.size() + 1);
+    const int size = gzread(gz, uncompressed.data(), static_cast<unsigned>(uncompressed.size()));
+    EXPECT_EQ(gzclose(gz), Z_OK);
+    ASSERT_EQ(size, static_cast<int>(content.size()));
+    uncompressed.resize(content.size());
+    EXPECT_EQ(uncompressed, content);
+    std::filesystem::remove(file);
+  }
+}
+
+TEST(StreamsTest, CompressedSkip) {
+  const std::vector<uint8_t> content = create_compressible_content(300 * 1000);
+  const std::vector<uint8_t> bytes = compress(content, gf::CompressionFormat::Zlib, nullptr);
+
+  gf::BufferInputStream input(&bytes);
+  gf::CompressedInputStream compressed(&input);
+  std::array<uint8_t, 100> buffer = {};
+
+  compressed.skip(12345);
+  ASSERT_EQ(compressed.read(buffer), buffer.size());
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 12345));
+
+  // backward without index: restart from the beginning
+  compressed.skip(-1000);
+  ASSERT_EQ(compressed.read(buffer), buffer.size());
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 12345 + 100 - 1000));
+
+  compressed.seek(250000);
+  ASSERT_EQ(compressed.read(buffer), buffer.size());
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 250000));
+
+  compressed.skip(1000000);
+  EXPECT_TRUE(compressed.finished());
+  EXPECT_EQ(compressed.read(buffer), 0u);
+
+  compressed.seek(0);
+  EXPECT_FALSE(compressed.finished());
+  ASSERT_EQ(compressed.read(buffer), buffer.size());
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin()));
+}
+
+TEST(StreamsTest, CompressedSeekWithIndex) {
+  const std::vector<uint8_t> content = create_compressible_content(4 * 1024 * 1024);
+  gf::ThreadPool pool(2);
+
+  for (gf::ThreadPool* current : { static_cast<gf::ThreadPool*>(nullptr), &pool }) {
+    const std::vector<uint8_t> bytes = compress(content, gf::CompressionFormat::Gzip, current);
+
+    gf::BufferInputStream input(&bytes);
+    gf::CompressedInputStream compressed(&input, 64 * 1024);
+    compressed.skip(static_cast<std::ptrdiff_t>(content.size()));
+    EXPECT_GT(compressed.checkpoint_count(), 10u);
+
+    std::array<uint8_t, 1000> buffer = {};
+
+    for (const std::size_t position : { 3000000u, 100u, 2500000u, 4000000u, 1234567u, 0u }) {
+      compressed.seek(static_cast<std::ptrdiff_t>(position));
+      ASSERT_EQ(compressed.read(buffer), buffer.size());
+      EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + static_cast<std::ptrdiff_t>(position)));
+    }
+  }
+}
+
+TEST(StreamsTest, CompressedSeekBackKeepsCheckpoints) {
+  const std::vector<uint8_t> content = create_compressible_content(2 * 1024 * 1024);
+  const std::vector<uint8_t> bytes = compress(content, gf::CompressionFormat::Zlib, nullptr);
+
+  gf::BufferInputStream input(&bytes);
+  gf::CompressedInputStream compressed(&input, 64 * 1024);
+  compressed.skip(static_cast<std::ptrdiff_t>(content.size()));
+  const std::size_t checkpoint_count = compressed.checkpoint_count();
+  EXPECT_GT(checkpoint_count, 2u);
+
+  std::array<uint8_t, 1000> buffer = {};
+
+  // the blocks after a backward seek are already indexed
+  for (int i = 0; i < 2; ++i) {
+    compressed.seek(1000000);
+    ASSERT_EQ(compressed.read(buffer), buffer.size());
+    EXPECT_TRUE(std::equal(buffer.begin(), buffer.end(), content.begin() + 1000000));
+
+    compressed.skip(static_cast<std::ptrdiff_t>(content.size()));
+    EXPECT_TRUE(compressed.finished());
+    EXPECT_EQ(compressed.checkpoint_count(), checkpoint_count);
+  }
+}
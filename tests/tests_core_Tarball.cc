@@ -0,0 +1,319 @@
+#include <gf2/core/Tarball.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/Streams.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  using TarEntry = std::pair<std::string, std::vector<uint8_t>>;
+
+  std::vector<uint8_t> create_content(std::size_t size, uint32_t seed)
+  {
+    std::vector<uint8_t> content(size);
+
+    for (uint8_t& byte : content) {
+      seed = seed * 1664525u + 1013904223u;
+      byte = static_cast<uint8_t>(seed >> 24);
+    }
+
+    return content;
+  }
+
+  // a text with a small alphabet, compressed with dynamic Huffman blocks whose ends are generally not byte-aligned
+  std::vector<uint8_t> create_text_content(std::size_t size, uint32_t seed)
+  {
+    static constexpr std::string_view Alphabet = "etaoinshrdlu \n.,";
+    std::vector<uint8_t> content(size);
+
+    for (uint8_t& byte : content) {
+      seed = seed * 1664525u + 1013904223u;
+      byte = static_cast<uint8_t>(Alphabet[(seed >> 24) % Alphabet.size()]);
+    }
+
+    return content;
+  }
+
+  std::vector<uint8_t> create_tar(const std::vector<TarEntry>& entries)
+  {
+    std::vector<uint8_t> tar;
+
+    for (const auto& [name, content] : entries) {
+      std::array<char, 512> header = {};
+      std::memcpy(header.data(), name.data(), name.size());
+      std::snprintf(header.data() + 100, 8, "%07o", 0644);
+      std::snprintf(header.data() + 124, 12, "%011o", static_cast<unsigned>(content.size()));
+      header[156] = '0';
+      std::memcpy(header.data() + 257, "ustar", 6);
+      std::memcpy(header.data() + 263, "00", 2);
+
+      std::memset(header.data() + 148, ' ', 8);
+      unsigned checksum = 0;
+
+      for (const char c : header) {
+        checksum += static_cast<uint8_t>(c);
+      }
+
+      std::snprintf(header.data() + 148, 8, "%06o", checksum);
+
+      tar.insert(tar.end(), header.begin(), header.end());
+      tar.insert(tar.end(), content.begin(), content.end());
+      tar.resize((tar.size() + 511) / 512 * 512, 0);
+    }
+
+    tar.resize(tar.size() + 1024, 0);
+    return tar;
+  }
+
+  void write_file(const std::filesystem::path& file, const std::vector<uint8_t>& bytes, bool compressed)
+  {
+    if (compressed) {
+      gzFile gz = gzopen(file.string().c_str(), "wb1");
+      ASSERT_NE(gz, nullptr);
+      gzwrite(gz, bytes.data(), static_cast<unsigned>(bytes.size()));
+      gzclose(gz);
+    } else {
+      std::FILE* raw = std::fopen(file.string().c_str(), "wb");
+      ASSERT_NE(raw, nullptr);
+      std::fwrite(bytes.data(), 1, bytes.size(), raw);
+      std::fclose(raw);
+    }
+  }
+
+  std::vector<TarEntry> create_entries()
+  {
+    return {
+      { "a.txt", create_content(100, 1) },
+      { "dir/big.bin", create_content(9 * 1024 * 1024, 2) },
+      { "dir/c.txt", create_content(3000, 3) },
+      { "last.bin", create_content(1024 * 1024, 4) },
+    };
+  }
+
+  constexpr uint16_t TarballIndexVersion = 1;
+  constexpr uint32_t TarballIndexTag = 0x47465449; // 'GFTI'
+
+  struct IndexHeader {
+    uint64_t size = 0;
+    int64_t time = 0;
+    bool compressed = false;
+  };
+
+  IndexHeader compute_index_header(const std::filesystem::path& file, bool compressed)
+  {
+    IndexHeader header;
+    header.size = static_cast<uint64_t>(std::filesystem::file_size(file));
+    header.time = static_cast<int64_t>(std::filesystem::last_write_time(file).time_since_epoch().count());
+    header.compressed = compressed;
+    return header;
+  }
+
+  // the number of bits of the checkpoints in the index of a tarball
+  std::vector<uint8_t> read_checkpoint_bits(const std::filesystem::path& file)
+  {
+    gf::FileInputStream input(gf::Tarball::index_file(file));
+    gf::Deserializer ar(&input);
+
+    uint32_t tag = 0;
+    IndexHeader header;
+    uint64_t entry_count = 0;
+    ar | tag | header.size | header.time | header.compressed | entry_count;
+
+    for (uint64_t i = 0; i < entry_count; ++i) {
+      std::filesystem::path path;
+      uint64_t offset = 0;
+      uint64_t size = 0;
+      ar | path | offset | size;
+    }
+
+    uint64_t checkpoint_count = 0;
+    ar | checkpoint_count;
+    std::vector<uint8_t> bits(static_cast<std::size_t>(checkpoint_count));
+
+    for (uint8_t& checkpoint_bits : bits) {
+      uint64_t position = 0;
+      uint64_t compressed_position = 0;
+      uint64_t window_size = 0;
+      ar | position | compressed_position | checkpoint_bits | window_size;
+    }
+
+    return bits;
+  }
+
+  void check_extraction(gf::Tarball& tarball, const std::vector<TarEntry>& entries)
+  {
+    for (auto iterator = entries.rbegin(); iterator != entries.rend(); ++iterator) {
+      EXPECT_EQ(tarball.extract(iterator->first), iterator->second);
+    }
+
+    EXPECT_TRUE(tarball.extract("missing.txt").empty());
+  }
+
+}
+
+TEST(TarballTest, Compressed) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_tarball.tar.gz";
+  const std::vector<TarEntry> entries = create_entries();
+  write_file(file, create_tar(entries), true);
+  std::filesystem::remove(gf::Tarball::index_file(file));
+
+  {
+    gf::Tarball tarball(file);
+    const std::vector<std::filesystem::path> paths = tarball.entries();
+    ASSERT_EQ(paths.size(), entries.size());
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      EXPECT_EQ(paths[i], entries[i].first);
+    }
+
+    check_extraction(tarball, entries);
+    EXPECT_TRUE(tarball.extract_view(entries.front().first).empty());
+    tarball.save_index();
+  }
+
+  EXPECT_TRUE(std::filesystem::exists(gf::Tarball::index_file(file)));
+
+  {
+    gf::Tarball tarball(file);
+    EXPECT_EQ(tarball.entries().size(), entries.size());
+    check_extraction(tarball, entries);
+  }
+
+  std::filesystem::remove(gf::Tarball::index_file(file));
+  std::filesystem::remove(file);
+}
+
+TEST(TarballTest, CompressedConcurrentExtraction) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_tarball_concurrent.tar.gz";
+  std::vector<TarEntry> entries;
+
+  for (uint32_t i = 0; i < 8; ++i) {
+    entries.emplace_back("file" + std::to_string(i) + ".txt", create_text_content(512 * 1024, i));
+  }
+
+  write_file(file, create_tar(entries), true);
+  std::filesystem::remove(gf::Tarball::index_file(file));
+
+  {
+    gf::Tarball tarball(file);
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+
+    for (std::size_t t = 0; t < mismatches.size(); ++t) {
+      threads.emplace_back([&, t]() {
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+          const TarEntry& entry = entries[(i + (2 * t)) % entries.size()];
+
+          if (tarball.extract(entry.first) != entry.second) {
+            ++mismatches[t];
+          }
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+
+    for (const int mismatch : mismatches) {
+      EXPECT_EQ(mismatch, 0);
+    }
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(TarballTest, Uncompressed) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_tarball.tar";
+  const std::vector<TarEntry> entries = create_entries();
+  write_file(file, create_tar(entries), false);
+
+  {
+    gf::Tarball tarball(file);
+    EXPECT_EQ(tarball.entries().size(), entries.size());
+    check_extraction(tarball, entries);
+
+    for (const auto& [name, content] : entries) {
+      const gf::Span<const uint8_t> view = tarball.extract_view(name);
+      EXPECT_TRUE(std::equal(view.begin(), view.end(), content.begin(), content.end()));
+    }
+
+    EXPECT_TRUE(tarball.extract_view("missing.txt").empty());
+  }
+
+  std::filesystem::remove(file);
+}
+
+TEST(TarballTest, CompressedUnalignedCheckpoints) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_tarball_text.tar.gz";
+  std::vector<TarEntry> entries;
+
+  for (uint32_t i = 0; i < 16; ++i) {
+    entries.emplace_back("file" + std::to_string(i) + ".txt", create_text_content(1024 * 1024 + (i * 1000), i));
+  }
+
+  write_file(file, create_tar(entries), true);
+  std::filesystem::remove(gf::Tarball::index_file(file));
+
+  {
+    gf::Tarball tarball(file);
+    ASSERT_EQ(tarball.entries().size(), entries.size());
+    check_extraction(tarball, entries);
+    tarball.save_index();
+  }
+
+  // some entries are extracted from a checkpoint in the middle of a byte, with inflatePrime()
+  const std::vector<uint8_t> bits = read_checkpoint_bits(file);
+  ASSERT_GT(bits.size(), 2);
+  EXPECT_TRUE(std::any_of(bits.begin() + 1, bits.end(), [](uint8_t checkpoint_bits) { return checkpoint_bits != 0; }));
+
+  {
+    gf::Tarball tarball(file);
+    check_extraction(tarball, entries);
+  }
+
+  std::filesystem::remove(gf::Tarball::index_file(file));
+  std::filesystem::remove(file);
+}
+
+TEST(TarballTest, IndexWithoutCheckpoints) {
+  const std::filesystem::path file = std::filesystem::temp_directory_path() / "gf2_tests_tarball_no_checkpoint.tar.gz";
+  const std::vector<TarEntry> entries = { { "a.txt", create_text_content(1000, 1) }, { "b.txt", create_text_content(2000, 2) } };
+  write_file(file, create_tar(entries), true);
+
+  {
+    // a valid index for the archive, but without checkpoints
+    const IndexHeader header = compute_index_header(file, true);
+    gf::FileOutputStream output(gf::Tarball::index_file(file));
+    gf::Serializer ar(&output, TarballIndexVersion);
+    ar | TarballIndexTag | header.size | header.time | header.compressed | static_cast<uint64_t>(entries.size());
+
+    for (const auto& [name, content] : entries) {
+      ar | std::filesystem::path(name) | uint64_t(0) | static_cast<uint64_t>(content.size());
+    }
+
+    ar | uint64_t(0);
+  }
+
+  gf::Tarball tarball(file);
+  EXPECT_EQ(tarball.entries().size(), entries.size());
+  check_extraction(tarball, entries);
+
+  std::filesystem::remove(gf::Tarball::index_file(file));
+  std::filesystem::remove(file);
+}
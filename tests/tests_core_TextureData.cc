@@ -0,0 +1,163 @@
+#include <gf2/core/TextureData.h>
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <gf2/core/BlockCompression.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  gf::Image create_gradient_image(gf::Vec2I size)
+  {
+    gf::Image image(size);
+
+    for (auto position : image.position_range()) {
+      const float x = static_cast<float>(position.x) / static_cast<float>(size.w);
+      const float y = static_cast<float>(position.y) / static_cast<float>(size.h);
+      image.put_pixel(position, gf::Color(x, y, 1.0f - x, 1.0f - (y / 2.0f)));
+    }
+
+    return image;
+  }
+
+  int compute_max_error(const gf::Image& image, const std::vector<uint8_t>& pixels, int channels)
+  {
+    int error = 0;
+
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+      if (static_cast<int>(i % 4) < channels) {
+        error = std::max(error, std::abs(static_cast<int>(image.raw_data()[i]) - static_cast<int>(pixels[i])));
+      }
+    }
+
+    return error;
+  }
+
+  int compress_and_decompress(const gf::Image& image, gf::BlockCompression compression, int channels, gf::ThreadPool* pool = nullptr)
+  {
+    const gf::Vec2I size = image.size();
+    std::vector<uint8_t> blocks(gf::compute_compressed_size(size, compression));
+    gf::compress_blocks(gf::Span<const uint8_t>(image.raw_data(), image.raw_size()), size, compression, blocks, pool);
+
+    std::vector<uint8_t> pixels(image.raw_size());
+    gf::decompress_blocks(blocks, size, compression, pixels, pool);
+    return compute_max_error(image, pixels, channels);
+  }
+
+}
+
+TEST(BlockCompressionTest, CompressedSize) {
+  EXPECT_EQ(gf::compute_compressed_size({ 16, 8 }, gf::BlockCompression::None), 16u * 8u * 4u);
+  EXPECT_EQ(gf::compute_compressed_size({ 16, 8 }, gf::BlockCompression::Bc1), 4u * 2u * 8u);
+  EXPECT_EQ(gf::compute_compressed_size({ 16, 8 }, gf::BlockCompression::Bc3), 4u * 2u * 16u);
+  EXPECT_EQ(gf::compute_compressed_size({ 13, 7 }, gf::BlockCompression::Bc7), 4u * 2u * 16u);
+  EXPECT_EQ(gf::compute_compressed_size({ 1, 1 }, gf::BlockCompression::Bc1), 8u);
+}
+
+TEST(BlockCompressionTest, SolidColor) {
+  const gf::Image image({ 8, 8 }, gf::Color(0.2f, 0.4f, 0.6f, 0.8f));
+
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc1, 3), 4);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc3, 4), 4);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc7, 4), 2);
+}
+
+TEST(BlockCompressionTest, Gradient) {
+  const gf::Image image = create_gradient_image({ 64, 48 });
+
+  EXPECT_EQ(compress_and_decompress(image, gf::BlockCompression::None, 4), 0);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc1, 3), 12);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc3, 4), 12);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc7, 4), 8);
+}
+
+TEST(BlockCompressionTest, PartialBlocks) {
+  const gf::Image image = create_gradient_image({ 64, 48 }).sub_image(gf::RectI::from_size({ 13, 7 }));
+
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc1, 3), 16);
+  EXPECT_LE(compress_and_decompress(image, gf::BlockCompression::Bc7, 4), 8);
+}
+
+TEST(BlockCompressionTest, Parallel) {
+  const gf::Image image = create_gradient_image({ 128, 96 });
+  const gf::Vec2I size = image.size();
+  gf::ThreadPool pool(3);
+
+  std::vector<uint8_t> sequential(gf::compute_compressed_size(size, gf::BlockCompression::Bc7));
+  gf::compress_blocks(gf::Span<const uint8_t>(image.raw_data(), image.raw_size()), size, gf::BlockCompression::Bc7, sequential);
+
+  std::vector<uint8_t> parallel(sequential.size());
+  gf::compress_blocks(gf::Span<const uint8_t>(image.raw_data(), image.raw_size()), size, gf::BlockCompression::Bc7, parallel, &pool);
+
+  EXPECT_EQ(sequential, parallel);
+}
+
+TEST(TextureDataTest, Levels) {
+  const gf::TextureData data(create_gradient_image({ 64, 48 }), gf::BlockCompression::Bc1);
+
+  EXPECT_EQ(data.compression(), gf::BlockCompression::Bc1);
+  EXPECT_EQ(data.size(), gf::vec(64, 48));
+  ASSERT_EQ(data.level_count(), 7u);
+  EXPECT_EQ(data.level_size(0), gf::vec(64, 48));
+  EXPECT_EQ(data.level_size(1), gf::vec(32, 24));
+  EXPECT_EQ(data.level_size(5), gf::vec(2, 1));
+  EXPECT_EQ(data.level_size(6), gf::vec(1, 1));
+
+  std::size_t raw_size = 0;
+
+  for (std::size_t level = 0; level < data.level_count(); ++level) {
+    EXPECT_EQ(data.level_data(level).size(), gf::compute_compressed_size(data.level_size(level), gf::BlockCompression::Bc1));
+    raw_size += data.level_data(level).size();
+  }
+
+  EXPECT_EQ(data.raw_size(), raw_size);
+  EXPECT_EQ(data.level_image(6).size(), gf::vec(1, 1));
+}
+
+TEST(TextureDataTest, SaveToStream) {
+  gf::ThreadPool pool(2);
+  const gf::TextureData data(create_gradient_image({ 40, 40 }), gf::BlockCompression::Bc7, &pool);
+
+  std::vector<uint8_t> bytes;
+
+  {
+    gf::BufferOutputStream output(&bytes);
+    data.save_to_stream(output);
+  }
+
+  gf::BufferInputStream input(&bytes);
+  const gf::TextureData loaded(input);
+
+  EXPECT_EQ(loaded.compression(), data.compression());
+  EXPECT_EQ(loaded.size(), data.size());
+  ASSERT_EQ(loaded.level_count(), data.level_count());
+
+  for (std::size_t level = 0; level < data.level_count(); ++level) {
+    const gf::Span<const uint8_t> expected = data.level_data(level);
+    const gf::Span<const uint8_t> actual = loaded.level_data(level);
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), actual.begin(), actual.end()));
+  }
+}
+
+TEST(TextureDataTest, InvalidLevelCount) {
+  std::vector<uint8_t> bytes;
+
+  {
+    gf::BufferOutputStream output(&bytes);
+    gf::Serializer ar(&output, 1);
+    // a 4x4 texture has at most 3 levels
+    ar | UINT32_C(0x47465458) | gf::BlockCompression::None | gf::vec(4, 4) | UINT32_C(1000000);
+  }
+
+  gf::BufferInputStream input(&bytes);
+  EXPECT_THROW(gf::TextureData loaded(input), std::runtime_error);
+}
@@ -0,0 +1,86 @@
+#include <gf2/core/ThreadPool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ThreadPoolTest, Submit) {
+  gf::ThreadPool pool(2);
+
+  std::vector<std::future<int>> results;
+
+  for (int i = 0; i < 10; ++i) {
+    results.push_back(pool.submit([i]() { return i * i; }));
+  }
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(results[i].get(), i * i);
+  }
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  gf::ThreadPool pool(3);
+
+  std::vector<int> values(1000, 0);
+
+  pool.parallel_for(0, 1000, [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      values[i] += i;
+    }
+  });
+
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(ThreadPoolTest, NestedParallelFor) {
+  gf::ThreadPool pool(2);
+
+  std::atomic<int> count = 0;
+
+  pool.parallel_for(0, 8, [&](int begin, int end) {
+    for (int i = begin; i < end; ++i) {
+      pool.parallel_for(0, 10, [&](int nested_begin, int nested_end) { count += nested_end - nested_begin; });
+    }
+  });
+
+  EXPECT_EQ(count.load(), 80);
+}
+
+TEST(ThreadPoolTest, ParallelForException) {
+  gf::ThreadPool pool(3);
+
+  // on the workers and on the calling thread
+  for (int failing : { 0, 999 }) {
+    std::atomic<int> count = 0;
+
+    EXPECT_THROW(pool.parallel_for(0, 1000, [&](int begin, int end) { // NOLINT
+      if (begin <= failing && failing < end) {
+        throw std::runtime_error("failure");
+      }
+
+      count += end - begin;
+    }), std::runtime_error);
+
+    EXPECT_LT(count.load(), 1000);
+  }
+
+  // the pool is still usable
+  std::atomic<int> count = 0;
+  pool.parallel_for(0, 100, [&](int begin, int end) { count += end - begin; });
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(ThreadPoolTest, NoThread) {
+  gf::ThreadPool pool(0);
+
+  auto result = pool.submit([]() { return 42; });
+  EXPECT_EQ(result.get(), 42);
+
+  int sum = 0;
+  gf::parallel_for(&pool, 0, 10, [&](int begin, int end) { sum += end - begin; });
+  EXPECT_EQ(sum, 10);
+}
@@ -0,0 +1,482 @@
+#include <gf2/core/TiledMap.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <zlib.h>
+
+#include <gf2/core/Range.h>
+#include <gf2/core/Serialization.h>
+#include <gf2/core/SerializationContainer.h>
+#include <gf2/core/SerializationOps.h>
+#include <gf2/core/SerializationUtilities.h>
+#include <gf2/core/Streams.h>
+#include <gf2/core/ThreadPool.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+  std::filesystem::path create_map_directory(const char* name)
+  {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+  }
+
+  void write_file(const std::filesystem::path& filename, const std::string& content)
+  {
+    gf::FileOutputStream file(filename);
+    file.write(gf::Span<const uint8_t>(reinterpret_cast<const uint8_t*>(content.data()), content.size())); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+  }
+
+  std::string create_tmx(const std::string& csv)
+  {
+    return R"(<?xml version="1.0" encoding="UTF-8"?>
+<map version="1.10" orientation="orthogonal" renderorder="right-down" width="2" height="2" tilewidth="16" tileheight="16" infinite="0">
+  <tileset firstgid="1" source="tiles.tsx"/>
+  <layer id="1" name="ground" width="2" height="2">
+    <data encoding="csv">)" + csv + R"(</data>
+  </layer>
+</map>
+)";
+  }
+
+  std::string create_tsx(int offset)
+  {
+    return R"(<?xml version="1.0" encoding="UTF-8"?>
+<tileset version="1.10" name="tiles" tilewidth="16" tileheight="16" tilecount="4" columns="2">
+  <tileoffset x=")" + std::to_string(offset) + R"(" y="0"/>
+  <image source="tiles.png" width="32" height="32"/>
+</tileset>
+)";
+  }
+
+  enum class DataFormat {
+    Csv,
+    Base64,
+    Zlib,
+    Gzip,
+  };
+
+  std::string encode_base64(const std::vector<uint8_t>& bytes)
+  {
+    static constexpr std::string_view Alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+
+    for (std::size_t i = 0; i < bytes.size(); i += 3) {
+      const std::size_t count = std::min(bytes.size() - i, std::size_t(3));
+      uint32_t quantum = uint32_t(bytes[i]) << 16;
+
+      if (count > 1) {
+        quantum |= uint32_t(bytes[i + 1]) << 8;
+      }
+
+      if (count > 2) {
+        quantum |= uint32_t(bytes[i + 2]);
+      }
+
+      for (std::size_t k = 0; k < 4; ++k) {
+        result += k <= count ? Alphabet[(quantum >> (18 - (6 * k))) & 0x3F] : '=';
+      }
+    }
+
+    return result;
+  }
+
+  std::vector<uint8_t> compress_bytes(const std::vector<uint8_t>& bytes, DataFormat format)
+  {
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, format == DataFormat::Gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> compressed(deflateBound(&stream, static_cast<uLong>(bytes.size())));
+    stream.next_in = bytes.data();
+    stream.avail_in = static_cast<uInt>(bytes.size());
+    stream.next_out = compressed.data();
+    stream.avail_out = static_cast<uInt>(compressed.size());
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    return compressed;
+  }
+
+  std::vector<uint8_t> gids_to_bytes(const std::vector<uint32_t>& gids)
+  {
+    std::vector<uint8_t> bytes;
+
+    for (const uint32_t gid : gids) {
+      for (int k = 0; k < 4; ++k) {
+        bytes.push_back(static_cast<uint8_t>(gid >> (8 * k))); // little endian
+      }
+    }
+
+    return bytes;
+  }
+
+  std::string encode_data(const std::vector<uint32_t>& gids, DataFormat format)
+  {
+    switch (format) {
+      case DataFormat::Csv:
+        {
+          std::string result = R"(<data encoding="csv">)";
+
+          for (std::size_t i = 0; i < gids.size(); ++i) {
+            result += (i == 0 ? "" : ",") + std::to_string(gids[i]);
+          }
+
+          return result + "</data>";
+        }
+      case DataFormat::Base64:
+        return R"(<data encoding="base64">
+   )" + encode_base64(gids_to_bytes(gids)) + "\n  </data>";
+      case DataFormat::Zlib:
+        return R"(<data encoding="base64" compression="zlib">)" + encode_base64(compress_bytes(gids_to_bytes(gids), format)) + "</data>";
+      case DataFormat::Gzip:
+        return R"(<data encoding="base64" compression="gzip">)" + encode_base64(compress_bytes(gids_to_bytes(gids), format)) + "</data>";
+    }
+
+    return {};
+  }
+
+  constexpr gf::Vec2I DataMapSize = { 4, 4 };
+
+  std::vector<uint32_t> create_gids(std::size_t layer)
+  {
+    std::vector<uint32_t> gids;
+
+    for (int i = 0; i < DataMapSize.w * DataMapSize.h; ++i) {
+      gids.push_back(static_cast<uint32_t>((layer * 100) + i + 1));
+    }
+
+    return gids;
+  }
+
+  std::string create_data_tmx(const std::vector<std::string>& layers_data)
+  {
+    std::string tmx = R"(<?xml version="1.0" encoding="UTF-8"?>
+<map version="1.10" orientation="orthogonal" renderorder="right-down" width="4" height="4" tilewidth="16" tileheight="16" infinite="0">
+  <tileset firstgid="1" name="tiles" tilewidth="16" tileheight="16" tilecount="4" columns="2">
+    <image source="tiles.png" width="32" height="32"/>
+  </tileset>
+)";
+
+    for (std::size_t i = 0; i < layers_data.size(); ++i) {
+      tmx += R"(  <layer id=")" + std::to_string(i + 1) + R"(" name="layer)" + std::to_string(i) + R"(" width="4" height="4">)" + layers_data[i] + "</layer>\n";
+    }
+
+    return tmx + "</map>\n";
+  }
+
+  // the cache is not written again when it is used
+  void age_file(const std::filesystem::path& filename)
+  {
+    std::filesystem::last_write_time(filename, std::filesystem::last_write_time(filename) - std::chrono::hours(1));
+  }
+
+}
+
+TEST(TiledMapTest, CacheDisabledByDefault) {
+  const std::filesystem::path directory = create_map_directory("gf2_tests_tiled_map_default");
+  write_file(directory / "map.tmx", create_tmx("1,2,3,4"));
+  write_file(directory / "tiles.tsx", create_tsx(0));
+
+  const gf::TiledMap map(directory / "map.tmx");
+  EXPECT_EQ(map.tile_layers.size(), 1);
+  EXPECT_FALSE(std::filesystem::exists(gf::TiledMap::cache_file(directory / "map.tmx")));
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(TiledMapTest, CacheHitAndInvalidation) {
+  const std::filesystem::path directory = create_map_directory("gf2_tests_tiled_map_cache");
+  const std::filesystem::path filename = directory / "map.tmx";
+  const std::filesystem::path cache = gf::TiledMap::cache_file(filename);
+  write_file(filename, create_tmx("1,2,3,4"));
+  write_file(directory / "tiles.tsx", create_tsx(3));
+
+  // miss: the cache is written
+  {
+    const gf::TiledMap map(filename, gf::TiledMapOption::Cache);
+    ASSERT_EQ(map.tile_layers.size(), 1);
+    EXPECT_EQ(map.tile_layers[0].tile({ 1, 1 }).gid, 4);
+    ASSERT_TRUE(std::filesystem::exists(cache));
+  }
+
+  // hit: the cache is read and not written again
+  age_file(cache);
+  const std::filesystem::file_time_type time = std::filesystem::last_write_time(cache);
+
+  {
+    const gf::TiledMap map(filename, gf::TiledMapOption::Cache);
+    ASSERT_EQ(map.tile_layers.size(), 1);
+    EXPECT_EQ(map.tile_layers[0].tile({ 1, 1 }).gid, 4);
+    ASSERT_EQ(map.tilesets.size(), 1);
+    EXPECT_EQ(map.tilesets[0].offset.x, 3);
+    ASSERT_EQ(map.textures.size(), 1);
+    EXPECT_EQ(map.textures[0], directory / "tiles.png");
+    EXPECT_EQ(std::filesystem::last_write_time(cache), time);
+  }
+
+  // invalidation by the TMX file
+  write_file(filename, create_tmx("4,3,2,1"));
+
+  {
+    const gf::TiledMap map(filename, gf::TiledMapOption::Cache);
+    ASSERT_EQ(map.tile_layers.size(), 1);
+    EXPECT_EQ(map.tile_layers[0].tile({ 1, 1 }).gid, 1);
+    EXPECT_NE(std::filesystem::last_write_time(cache), time);
+  }
+
+  // invalidation by a TSX file
+  write_file(directory / "tiles.tsx", create_tsx(5));
+
+  {
+    const gf::TiledMap map(filename, gf::TiledMapOption::Cache);
+    ASSERT_EQ(map.tilesets.size(), 1);
+    EXPECT_EQ(map.tilesets[0].offset.x, 5);
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(TiledMapTest, SerializationVersion) {
+  gf::MapTileset tileset;
+  tileset.first_gid = 1;
+  tileset.tile_size = { 16, 16 };
+  tileset.offset = { 3, 4 };
+  tileset.spacing = 2;
+
+  gf::MapTileLayer layer;
+  layer.tiles = gf::Array2D<gf::MapTile>({ 2, 2 });
+  layer.mode = gf::BlendMode::Multiply;
+
+  for (const uint16_t version : { uint16_t(0), gf::TiledMapChunksVersion }) {
+    std::vector<uint8_t> bytes;
+
+    {
+      gf::BufferOutputStream stream(&bytes);
+      gf::Serializer ar(&stream, version);
+      ar | tileset | layer;
+    }
+
+    gf::MapTileset loaded_tileset;
+    gf::MapTileLayer loaded_layer;
+
+    {
+      gf::BufferInputStream stream(&bytes);
+      gf::Deserializer ar(&stream);
+      ar | loaded_tileset | loaded_layer;
+      EXPECT_EQ(ar.version(), version);
+    }
+
+    EXPECT_EQ(loaded_tileset.spacing, 2);
+    EXPECT_EQ(loaded_layer.tiles.size(), gf::vec(2, 2));
+
+    if (version >= gf::TiledMapChunksVersion) {
+      EXPECT_EQ(loaded_tileset.offset, gf::vec(3, 4));
+      EXPECT_EQ(loaded_layer.mode, gf::BlendMode::Multiply);
+    } else {
+      EXPECT_EQ(loaded_tileset.offset, gf::vec(0, 0));
+      EXPECT_EQ(loaded_layer.mode, gf::BlendMode::Normal);
+    }
+  }
+}
+
+TEST(TiledMapTest, TileData) {
+  const std::filesystem::path directory = create_map_directory("gf2_tests_tiled_map_data");
+  gf::ThreadPool pool(1);
+
+  // the layers are split in at most 8 ranges on a pool of 1 thread, these counts cover both sides of the split
+  for (const std::size_t layer_count : { 1u, 7u, 8u, 9u, 17u }) {
+    std::vector<std::string> layers_data;
+
+    for (std::size_t i = 0; i < layer_count; ++i) {
+      layers_data.push_back(encode_data(create_gids(i), static_cast<DataFormat>(i % 4)));
+    }
+
+    write_file(directory / "map.tmx", create_data_tmx(layers_data));
+
+    for (gf::ThreadPool* current : { static_cast<gf::ThreadPool*>(nullptr), &pool }) {
+      const gf::TiledMap map(directory / "map.tmx", gf::None, current);
+      ASSERT_EQ(map.tile_layers.size(), layer_count);
+
+      for (std::size_t i = 0; i < layer_count; ++i) {
+        const std::vector<uint32_t> gids = create_gids(i);
+
+        for (const gf::Vec2I position : gf::position_range(DataMapSize)) {
+          EXPECT_EQ(map.tile_layers[i].tile(position).gid, gids[(position.y * DataMapSize.w) + position.x]);
+        }
+      }
+    }
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+TEST(TiledMapTest, InvalidBase64) {
+  const std::filesystem::path directory = create_map_directory("gf2_tests_tiled_map_base64");
+  std::vector<uint8_t> bytes = gids_to_bytes(create_gids(0));
+  const std::string valid = encode_base64(bytes);
+  ASSERT_EQ(valid.substr(valid.size() - 2), "==");
+
+  // 63 bytes without padding and a last byte with an invalid padding
+  bytes.pop_back();
+  const std::string truncated = encode_base64(bytes);
+
+  for (const std::string& data : { truncated + "Q===", valid + "====", valid + "AAAA", valid.substr(0, valid.size() - 2) + "=A", "=" + valid.substr(1) }) {
+    write_file(directory / "map.tmx", create_data_tmx({ R"(<data encoding="base64">)" + data + "</data>" }));
+    EXPECT_THROW(gf::TiledMap(directory / "map.tmx"), std::runtime_error) << data;
+  }
+
+  std::filesystem::remove_all(directory);
+}
+
+namespace {
+
+  constexpr gf::Vec2I ChunkSize = { 4, 4 };
+
+  std::vector<uint32_t> create_chunk_gids(gf::Vec2I position)
+  {
+    std::vector<uint32_t> gids;
+
+    for (const gf::Vec2I offset : gf::position_range(ChunkSize)) {
+      const gf::Vec2I tile = position + offset;
+      gids.push_back(static_cast<uint32_t>(((tile.y + 100) * 1000) + tile.x + 100));
+    }
+
+    return gids;
+  }
+
+  gf::MapTileChunk create_compressed_chunk(gf::Vec2I position)
+  {
+    gf::MapTileChunk chunk;
+    chunk.position = position;
+    chunk.size = ChunkSize;
+    chunk.data = compress_bytes(gids_to_bytes(create_chunk_gids(position)), DataFormat::Zlib);
+    chunk.compressed = true;
+    return chunk;
+  }
+
+  uint32_t expected_gid(gf::Vec2I position)
+  {
+    return static_cast<uint32_t>(((position.y + 100) * 1000) + position.x + 100);
+  }
+
+}
+
+TEST(TiledMapTest, ChunkAt) {
+  gf::MapTileLayer layer;
+  // sorted by position, with a hole at (0, 0)
+  layer.chunks.push_back(create_compressed_chunk({ -4, -4 }));
+  layer.chunks.push_back(create_compressed_chunk({ 0, -4 }));
+  layer.chunks.push_back(create_compressed_chunk({ -4, 0 }));
+  ASSERT_TRUE(layer.chunked());
+
+  EXPECT_EQ(layer.chunk_at({ -1, -1 }), &layer.chunks[0]);
+  EXPECT_EQ(layer.chunk_at({ -4, -4 }), &layer.chunks[0]);
+  EXPECT_EQ(layer.chunk_at({ 0, -1 }), &layer.chunks[1]);
+  EXPECT_EQ(layer.chunk_at({ 3, -4 }), &layer.chunks[1]);
+  EXPECT_EQ(layer.chunk_at({ -1, 0 }), &layer.chunks[2]);
+  EXPECT_EQ(layer.chunk_at({ -4, 3 }), &layer.chunks[2]);
+
+  // outside every chunk
+  EXPECT_EQ(layer.chunk_at({ 0, 0 }), nullptr);
+  EXPECT_EQ(layer.chunk_at({ 3, 3 }), nullptr);
+  EXPECT_EQ(layer.chunk_at({ -5, -1 }), nullptr);
+  EXPECT_EQ(layer.chunk_at({ -1, -5 }), nullptr);
+  EXPECT_EQ(layer.chunk_at({ 4, -1 }), nullptr);
+  EXPECT_EQ(layer.tile({ 0, 0 }).gid, 0);
+  EXPECT_EQ(layer.tile({ -100, 50 }).gid, 0);
+}
+
+TEST(TiledMapTest, LazyChunks) {
+  gf::MapTileLayer layer;
+  layer.chunks.push_back(create_compressed_chunk({ -4, -4 }));
+  layer.chunks.push_back(create_compressed_chunk({ 0, -4 }));
+  layer.chunks.push_back(create_compressed_chunk({ -4, 0 }));
+
+  // not decoded yet: the tiles are empty
+  for (const gf::MapTileChunk& chunk : layer.chunks) {
+    EXPECT_FALSE(chunk.decoded());
+  }
+
+  EXPECT_EQ(layer.tile({ -1, -1 }).gid, 0);
+
+  // only the chunks in the area are decoded
+  layer.decode_chunks(gf::RectI::from_position_size({ -2, -2 }, { 1, 1 }));
+  EXPECT_TRUE(layer.chunks[0].decoded());
+  EXPECT_FALSE(layer.chunks[1].decoded());
+  EXPECT_FALSE(layer.chunks[2].decoded());
+
+  for (const gf::Vec2I offset : gf::position_range(ChunkSize)) {
+    const gf::Vec2I position = gf::vec(-4, -4) + offset;
+    EXPECT_EQ(layer.tile(position).gid, expected_gid(position));
+  }
+
+  EXPECT_EQ(layer.tile({ 0, -1 }).gid, 0);
+
+  gf::ThreadPool pool(2);
+  layer.decode_chunks(gf::RectI::from_position_size({ -10, -10 }, { 20, 20 }), &pool);
+
+  for (const gf::MapTileChunk& chunk : layer.chunks) {
+    EXPECT_TRUE(chunk.decoded());
+    EXPECT_FALSE(chunk.compressed);
+
+    for (const gf::Vec2I offset : gf::position_range(ChunkSize)) {
+      EXPECT_EQ(layer.tile(chunk.position + offset).gid, expected_gid(chunk.position + offset));
+    }
+  }
+
+  EXPECT_EQ(layer.tile({ 1, 1 }).gid, 0);
+}
+
+TEST(TiledMapTest, InfiniteMap) {
+  const std::filesystem::path directory = create_map_directory("gf2_tests_tiled_map_infinite");
+
+  std::string data = R"(<data encoding="base64" compression="zlib">)";
+
+  // unsorted in the file
+  for (const gf::Vec2I position : { gf::vec(0, -4), gf::vec(-4, 0), gf::vec(-4, -4) }) {
+    data += R"(<chunk x=")" + std::to_string(position.x) + R"(" y=")" + std::to_string(position.y) + R"(" width="4" height="4">)";
+    data += encode_base64(compress_bytes(gids_to_bytes(create_chunk_gids(position)), DataFormat::Zlib)) + "</chunk>";
+  }
+
+  data += "</data>";
+
+  write_file(directory / "map.tmx", create_data_tmx({ data }));
+
+  {
+    gf::TiledMap map(directory / "map.tmx", gf::TiledMapOption::LazyChunks);
+    ASSERT_EQ(map.tile_layers.size(), 1);
+    gf::MapTileLayer& layer = map.tile_layers[0];
+    ASSERT_EQ(layer.chunks.size(), 3);
+    EXPECT_EQ(layer.chunks[0].position, gf::vec(-4, -4));
+    EXPECT_EQ(layer.chunks[1].position, gf::vec(0, -4));
+    EXPECT_EQ(layer.chunks[2].position, gf::vec(-4, 0));
+    EXPECT_EQ(layer.tile({ -1, -1 }).gid, 0);
+
+    map.decode_chunks(gf::RectI::from_position_size({ -1, -1 }, { 1, 1 }));
+    EXPECT_EQ(layer.tile({ -1, -1 }).gid, expected_gid({ -1, -1 }));
+    EXPECT_FALSE(layer.chunks[1].decoded());
+  }
+
+  {
+    const gf::TiledMap map(directory / "map.tmx");
+    const gf::MapTileLayer& layer = map.tile_layers[0];
+
+    for (const gf::MapTileChunk& chunk : layer.chunks) {
+      EXPECT_TRUE(chunk.decoded());
+    }
+
+    EXPECT_EQ(layer.tile({ -4, 3 }).gid, expected_gid({ -4, 3 }));
+    EXPECT_EQ(layer.tile({ 3, -4 }).gid, expected_gid({ 3, -4 }));
+    EXPECT_EQ(layer.tile({ 0, 0 }).gid, 0);
+  }
+
+  std::filesystem::remove_all(directory);
+}
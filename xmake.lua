@@ -72,6 +72,7 @@ target("gf2core0")
     end
     add_defines("ZLIB_CONST")
     add_files("library/core/*.cc")
+    add_files("library/core/bits/*.cc")
     add_headerfiles("include/(gf2/core/*.h)")
     add_includedirs("include", { public = true })
     add_packages("freetype", "pugixml", "stb")